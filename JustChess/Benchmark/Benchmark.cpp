@@ -0,0 +1,696 @@
+#include <stdafx.h>
+
+#include "Benchmark.h"
+#include "..\Functional\Notation\Notation.h"
+#include "..\Evaluation\BatchEvaluator.h"
+#include "..\Evaluation\Evaluator.h"
+#include "..\Evaluation\Nnue.h"
+#include "..\Evaluation\PawnStructure.h"
+#include "..\Profiling\AllocationCounter.h"
+
+namespace JC
+{
+  namespace
+  {
+    using clock_t = std::chrono::steady_clock;
+
+    uint64_t ElapsedNs(clock_t::time_point start)
+    {
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock_t::now() - start).count());
+    }
+
+    /// @brief Lines added to the variation tree and plies per line
+    constexpr std::size_t VARIATION_LINES = 2000;
+    constexpr std::size_t VARIATION_LINE_PLIES = 24;
+
+    /// @brief Keeps the compiler from dropping results of benchmarked calls
+    volatile std::size_t s_sink = 0;
+
+    /// @brief Adds a result to @c s_sink (compound assignment to a volatile is deprecated)
+    template<typename T>
+    void DoNotOptimize(const T& value)
+    {
+      s_sink = s_sink + static_cast<std::size_t>(value);
+    }
+  }
+
+  const std::vector<SBenchmarkPosition>& CBenchmark::GetCorpus()
+  {
+    static const std::vector<SBenchmarkPosition> s_corpus
+    {
+      {"start", ""},
+      {"opening_italian",
+       "e2e4 e7e5 g1f3 b8c6 f1c4 f8c5 c2c3 g8f6 d2d3 d7d6 e1g1 e8g8"},
+      {"middlegame_qgd",
+       "d2d4 d7d5 c2c4 e7e6 b1c3 g8f6 c1g5 f8e7 e2e3 e8g8 g1f3 b8d7 a1c1 c7c6 f1d3 d5c4 "
+       "d3c4 f6d5 g5e7 d8e7 e1g1 d5c3 c1c3 e6e5"},
+      {"endgame_minor_pieces",
+       "d2d4 b7b5 a2a3 b8a6 d4d5 g7g5 c1g5 a8b8 g5e7 g8e7 d5d6 c7d6 d1d6 a6c7 d6d7 e8d7 "
+       "b1d2 b8b6 f2f3 b6a6 d2b3 a6a3 b2a3 e7g8 c2c4 f8a3 c4b5 c7b5 a1a3 b5a3 h2h4 d8h4 "
+       "h1h4 g8h6 h4h6 d7c7 h6h7 h8h7 b3d2 c8e6 d2e4 c7b6 f3f4 a3b5 g1f3 b6b7 e4d2 e6g4 "
+       "e2e4 g4f3 f1b5 f3e4 d2e4 f7f5 e4f2 b7c7 g2g4 f5g4 f2g4 h7h2"},
+      {"endgame_rooks",
+       "f2f4 a7a5 e1f2 h7h6 g1f3 d7d6 f2e3 a8a7 h2h3 c8h3 g2h3 b7b6 e3f2 c7c6 f3e1 a7a8 "
+       "e1d3 g7g6 h1h2 f7f6 b1a3 e7e5 f4e5 d6e5 d3e5 f8a3 e5g6 d8d2 b2a3 d2d1 g6h8 d1e2 "
+       "f2e2 b8d7 c1h6 g8h6 e2e1 e8e7 h2d2 a8h8 d2d7 e7d7 f1d3 b6b5 d3b5 c6b5 e1f1 h6f5 "
+       "a1d1 d7c8 c2c3 h8h3 d1d5 h3c3 d5f5 c3a3 f5f6 a3a2 f6f7 c8b8"},
+      {"repetition_long",
+       "e2e4 e7e5 g1f3 b8c6 f1c4 f8c5 c2c3 g8f6 d2d3 d7d6 e1g1 e8g8 "
+       "f3h4 f6h5 h4f3 h5f6 f3h4 f6h5 h4f3 h5f6 f3h4 f6h5 h4f3 h5f6 "
+       "f3h4 f6h5 h4f3 h5f6 f3h4 f6h5 h4f3 h5f6 f3h4 f6h5 h4f3 h5f6"},
+    };
+    return s_corpus;
+  }
+
+  bool CBenchmark::ParseLine(const char* moves, std::vector<SMove>& line)
+  {
+    return ParseMoveList(moves, line);
+  }
+
+  bool CBenchmark::Replay(CChessBoard& board, const std::vector<SMove>& line)
+  {
+    board.Reset();
+    bool whiteToMove = true;
+    for (const auto& move : line)
+    {
+      if (!board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, whiteToMove))
+      {
+        return false;
+      }
+      whiteToMove = !whiteToMove;
+    }
+    return true;
+  }
+
+  uint64_t CBenchmark::Perft(CChessBoard& board, std::size_t depth)
+  {
+    if (depth == 0)
+    {
+      return 1;
+    }
+    const bool whiteToMove = board.IsWhiteToMove();
+    std::vector<SMove> moves;
+    board.GetAllValidMoves(whiteToMove, moves);
+    if (depth == 1)
+    {
+      return moves.size();
+    }
+
+    const SPosition position = board.Snapshot();
+    uint64_t nodes = 0;
+    for (const auto& move : moves)
+    {
+      board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, whiteToMove);
+      nodes += Perft(board, depth - 1);
+      board.Restore(position);
+    }
+    return nodes;
+  }
+
+  template<typename Sample>
+  CBenchmark::SResult CBenchmark::Measure(const char* position, const char* primitive, Sample sample) const
+  {
+    std::vector<double> perCall;
+    for (std::size_t ind = 0; ind < m_options.m_warmup + m_options.m_repetitions; ind++)
+    {
+      const uint64_t elapsed = sample();
+      if (ind >= m_options.m_warmup)
+      {
+        perCall.push_back(static_cast<double>(elapsed) / static_cast<double>(m_options.m_iterations));
+      }
+    }
+    std::sort(perCall.begin(), perCall.end());
+    return SResult{ position, primitive, perCall[perCall.size() / 2], perCall.front() };
+  }
+
+  bool CBenchmark::Run(std::ostream& out)
+  {
+    CChessBoard board(m_logger);
+    std::vector<SResult> results;
+    std::vector<std::pair<std::string, uint64_t>> nodeCounts;
+    uint64_t signature = 0;
+    double perftSeconds = 0.0;
+    const std::size_t iterations = m_options.m_iterations;
+
+    for (const auto& position : GetCorpus())
+    {
+      std::vector<SMove> line;
+      if (!ParseLine(position.m_moves, line) || !Replay(board, line))
+      {
+        JC_LOG_ERROR(m_logger, std::string("Benchmark position can not be set up: ") + position.m_name);
+        return false;
+      }
+      const bool whiteToMove = board.IsWhiteToMove();
+      std::vector<SMove> moves;
+      board.GetAllValidMoves(whiteToMove, moves);
+      // repetitions within the corpus game stay detectable after restoring
+      const SPosition snapshot = board.Snapshot();
+      const CChessBoard::history_t history = board.GetHistory();
+
+      results.push_back(Measure(position.m_name, "GetValidMoves", [&]()
+      {
+        // one call per square, so the time is averaged over all squares
+        const auto start = clock_t::now();
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          const auto rank = static_cast<eRank>((ind / FILES) % RANKS);
+          const auto file = static_cast<eFile>(ind % FILES);
+          DoNotOptimize(board.GetValidMoves(rank, file, whiteToMove));
+        }
+        return ElapsedNs(start);
+      }));
+
+      results.push_back(Measure(position.m_name, "IsChecked", [&]()
+      {
+        const auto start = clock_t::now();
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          DoNotOptimize(board.IsChecked(whiteToMove));
+        }
+        return ElapsedNs(start);
+      }));
+
+      results.push_back(Measure(position.m_name, "GetAttackedSquares", [&]()
+      {
+        const auto start = clock_t::now();
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          DoNotOptimize(board.GetAttackedSquares(!whiteToMove));
+        }
+        return ElapsedNs(start);
+      }));
+
+      results.push_back(Measure(position.m_name, "CheckmateState", [&]()
+      {
+        const auto start = clock_t::now();
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          DoNotOptimize(board.CheckmateState(whiteToMove));
+        }
+        return ElapsedNs(start);
+      }));
+
+      results.push_back(Measure(position.m_name, "ThreefoldRepetition", [&]()
+      {
+        const auto start = clock_t::now();
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          DoNotOptimize(board.ThreefoldRepetition());
+        }
+        return ElapsedNs(start);
+      }));
+
+      results.push_back(Measure(position.m_name, "GetGameStatus", [&]()
+      {
+        // the status is cached per position, so it is measured right after restoring (as after a move)
+        uint64_t elapsed = 0;
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          board.Restore(snapshot, history);
+          const auto start = clock_t::now();
+          DoNotOptimize(board.GetGameStatus());
+          elapsed += ElapsedNs(start);
+        }
+        board.Restore(snapshot, history);
+        return elapsed;
+      }));
+
+      results.push_back(Measure(position.m_name, "CreateNextRecord", [&]()
+      {
+        const auto start = clock_t::now();
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          board.CreateNextRecord();
+        }
+        const uint64_t elapsed = ElapsedNs(start);
+        board.Restore(snapshot, history);
+        return elapsed;
+      }));
+
+      if (!moves.empty())
+      {
+        // the first valid move is applied to a freshly set up position in each iteration
+        const SMove& move = moves.front();
+        results.push_back(Measure(position.m_name, "Move", [&]()
+        {
+          uint64_t elapsed = 0;
+          for (std::size_t ind = 0; ind < iterations; ind++)
+          {
+            board.Restore(snapshot, history);
+            const auto start = clock_t::now();
+            DoNotOptimize(board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, whiteToMove));
+            elapsed += ElapsedNs(start);
+          }
+          board.Restore(snapshot, history);
+          return elapsed;
+        }));
+      }
+
+      results.push_back(Measure(position.m_name, "Reset", [&]()
+      {
+        uint64_t elapsed = 0;
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          board.Restore(snapshot, history);
+          const auto start = clock_t::now();
+          board.Reset();
+          elapsed += ElapsedNs(start);
+        }
+        board.Restore(snapshot, history);
+        return elapsed;
+      }));
+
+      if (!CheckAllocations(position.m_name, board, snapshot, history, moves))
+      {
+        return false;
+      }
+
+      if (m_options.m_depth > 0)
+      {
+        const auto start = clock_t::now();
+        const uint64_t nodes = Perft(board, m_options.m_depth);
+        perftSeconds += static_cast<double>(ElapsedNs(start)) * 1e-9;
+        nodeCounts.emplace_back(position.m_name, nodes);
+        signature += nodes;
+      }
+    }
+
+    SPawnHashStatistics pawnHash;
+    if (!MeasureEvaluation(results, pawnHash))
+    {
+      return false;
+    }
+    SVariationTreeResult tree;
+    if (!MeasureVariationTree(results, tree))
+    {
+      return false;
+    }
+    const double bytesPerNode = static_cast<double>(tree.m_memory) / static_cast<double>(tree.m_nodes);
+    const SVariationTreeStatistics& treeStatistics = tree.m_statistics;
+
+    if (m_options.m_format == eBenchmarkFormat::csv)
+    {
+      out << "position,primitive,median_ns,min_ns\n";
+      for (const auto& result : results)
+      {
+        out << result.m_position << "," << result.m_primitive << ","
+            << result.m_medianNs << "," << result.m_minNs << "\n";
+      }
+      for (const auto& [name, nodes] : nodeCounts)
+      {
+        out << name << ",nodes_depth_" << m_options.m_depth << "," << nodes << "," << nodes << "\n";
+      }
+      out << "pawn_hash_hit_rate," << pawnHash.m_probes << "," << pawnHash.HitRate() << "," << pawnHash.HitRate() << "\n";
+      out << "variation_tree_bytes_per_node," << tree.m_nodes << "," << bytesPerNode << "," << bytesPerNode << "\n";
+      out << "variation_tree_snapshot_hit_rate," << treeStatistics.m_materializations << ","
+          << treeStatistics.SnapshotHitRate() << "," << treeStatistics.SnapshotHitRate() << "\n";
+      out << "bench_signature," << m_options.m_depth << "," << signature << "," << signature << "\n";
+    }
+    else
+    {
+      out << "{\n  \"warmup\": " << m_options.m_warmup
+          << ",\n  \"repetitions\": " << m_options.m_repetitions
+          << ",\n  \"iterations\": " << m_options.m_iterations
+          << ",\n  \"results\": [";
+      for (std::size_t ind = 0; ind < results.size(); ind++)
+      {
+        const auto& result = results[ind];
+        out << (ind ? "," : "") << "\n    {\"position\": \"" << result.m_position
+            << "\", \"primitive\": \"" << result.m_primitive
+            << "\", \"median_ns\": " << result.m_medianNs
+            << ", \"min_ns\": " << result.m_minNs << "}";
+      }
+      out << "\n  ],\n  \"nodes\": {";
+      for (std::size_t ind = 0; ind < nodeCounts.size(); ind++)
+      {
+        out << (ind ? ", " : "") << "\"" << nodeCounts[ind].first << "\": " << nodeCounts[ind].second;
+      }
+      out << "},\n  \"pawn_hash\": {\"probes\": " << pawnHash.m_probes
+          << ", \"hits\": " << pawnHash.m_hits
+          << ", \"shield_hits\": " << pawnHash.m_shieldHits
+          << ", \"hit_rate\": " << pawnHash.HitRate()
+          << "},\n  \"variation_tree\": {\"lines\": " << tree.m_lines
+          << ", \"nodes\": " << tree.m_nodes
+          << ", \"snapshots\": " << tree.m_snapshots
+          << ", \"bytes_per_node\": " << bytesPerNode
+          << ", \"position_bytes\": " << sizeof(SPosition)
+          << ", \"existing_children\": " << treeStatistics.m_existingChildren
+          << ", \"cursor_hits\": " << treeStatistics.m_cursorHits
+          << ", \"materializations\": " << treeStatistics.m_materializations
+          << ", \"snapshot_hit_rate\": " << treeStatistics.SnapshotHitRate()
+          << ", \"replayed_moves\": " << treeStatistics.m_replayedMoves
+          << "},\n  \"allocations_counted\": " << (ALLOCATION_COUNTING ? "true" : "false")
+          << ",\n  \"depth\": " << m_options.m_depth
+          << ",\n  \"nodes_per_second\": " << (perftSeconds > 0.0 ? static_cast<double>(signature) / perftSeconds : 0.0)
+          << ",\n  \"bench_signature\": " << signature << "\n}\n";
+    }
+    out.flush();
+    return true;
+  }
+
+  bool CBenchmark::CheckAllocations(const char* position, CChessBoard& board, const SPosition& snapshot,
+    const CChessBoard::history_t& history, const std::vector<SMove>& moves) const
+  {
+    if (!ALLOCATION_COUNTING)
+    {
+      return true;
+    }
+    const bool whiteToMove = snapshot.m_whiteToMove;
+    // the first pass warms up the record buffer and the static profiling zones
+    for (int pass = 0; pass < 2; pass++)
+    {
+      for (const auto& move : moves)
+      {
+        board.Restore(snapshot, history);
+        const CAllocationCheck check;
+        DoNotOptimize(board.GetValidMoves(move.m_fromRank, move.m_fromFile, whiteToMove));
+        DoNotOptimize(board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, whiteToMove));
+        DoNotOptimize(board.IsChecked(!whiteToMove));
+        DoNotOptimize(board.CheckmateState(!whiteToMove));
+        DoNotOptimize(board.GetGameStatus());
+        if (pass > 0 && check.GetAllocations() != 0)
+        {
+          JC_LOG_ERROR(m_logger, std::string("Move path allocates memory at position ") + position + ": " +
+            std::to_string(check.GetAllocations()) + " allocations");
+          board.Restore(snapshot, history);
+          return false;
+        }
+      }
+    }
+    board.Restore(snapshot, history);
+    return true;
+  }
+
+  bool CBenchmark::MeasureEvaluation(std::vector<SResult>& results, SPawnHashStatistics& pawnHash) const
+  {
+    // all positions of the corpus games, repeated until there is one per iteration
+    std::vector<SPosition> positions;
+    CChessBoard board(m_logger);
+    for (const auto& position : GetCorpus())
+    {
+      std::vector<SMove> line;
+      ParseLine(position.m_moves, line);
+      board.Reset();
+      positions.push_back(board.Snapshot());
+      for (const auto& move : line)
+      {
+        board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove());
+        positions.push_back(board.Snapshot());
+      }
+    }
+    const std::size_t iterations = m_options.m_iterations;
+    std::vector<int> expected(iterations);
+    for (std::size_t ind = 0; ind < iterations; ind++)
+    {
+      expected[ind] = EvaluatePosition(positions[ind % positions.size()]);
+    }
+
+    results.push_back(Measure("eval_batch", "EvaluatePosition", [&]()
+    {
+      const auto start = clock_t::now();
+      for (std::size_t ind = 0; ind < iterations; ind++)
+      {
+        DoNotOptimize(EvaluatePosition(positions[ind % positions.size()]));
+      }
+      return ElapsedNs(start);
+    }));
+
+    // one result per instruction set supported by this CPU, time per position
+    for (uint8_t level = 0; level <= _UINT8(DetectSimdLevel()); level++)
+    {
+      CBatchEvaluator evaluator(static_cast<eSimdLevel>(level));
+      for (std::size_t ind = 0; ind < iterations; ind++)
+      {
+        evaluator.Add(positions[ind % positions.size()]);
+      }
+      std::vector<int16_t> scores;
+      evaluator.Evaluate(scores);
+      if (!std::equal(scores.begin(), scores.end(), expected.begin()))
+      {
+        JC_LOG_ERROR(m_logger, std::string("Batch evaluation differs from scalar evaluation: ") +
+          SimdLevelName(evaluator.GetSimdLevel()));
+        return false;
+      }
+
+      const std::string primitive = std::string("CBatchEvaluator_") + SimdLevelName(evaluator.GetSimdLevel());
+      results.push_back(Measure("eval_batch", primitive.c_str(), [&]()
+      {
+        const auto start = clock_t::now();
+        evaluator.Evaluate(scores);
+        DoNotOptimize(scores.back());
+        return ElapsedNs(start);
+      }));
+    }
+    return MeasurePawnStructure(positions, results, pawnHash) && MeasureNnue(positions, results);
+  }
+
+  bool CBenchmark::MeasurePawnStructure(const std::vector<SPosition>& positions, std::vector<SResult>& results,
+    SPawnHashStatistics& pawnHash) const
+  {
+    const std::size_t iterations = m_options.m_iterations;
+    CPawnHashTable table;
+    for (const auto& position : positions)
+    {
+      if (table.Evaluate(position) != EvaluatePawnStructure(position))
+      {
+        JC_LOG_ERROR(m_logger, "Pawn hash table result differs from pawn structure evaluation");
+        return false;
+      }
+    }
+    pawnHash = table.GetStatistics();
+
+    results.push_back(Measure("eval_batch", "EvaluatePawnStructure", [&]()
+    {
+      const auto start = clock_t::now();
+      for (std::size_t ind = 0; ind < iterations; ind++)
+      {
+        DoNotOptimize(EvaluatePawnStructure(positions[ind % positions.size()]));
+      }
+      return ElapsedNs(start);
+    }));
+    results.push_back(Measure("eval_batch", "CPawnHashTable", [&]()
+    {
+      const auto start = clock_t::now();
+      for (std::size_t ind = 0; ind < iterations; ind++)
+      {
+        DoNotOptimize(table.Evaluate(positions[ind % positions.size()]));
+      }
+      return ElapsedNs(start);
+    }));
+    return true;
+  }
+
+  bool CBenchmark::MeasureVariationTree(std::vector<SResult>& results, SVariationTreeResult& tree) const
+  {
+    // every added move as (parent node, move), so the tree can be built again with the same node numbers
+    std::vector<std::pair<CVariationTree::node_t, SMove>> additions;
+    CVariationTree reference(m_logger);
+    CChessBoard board(m_logger);
+    std::vector<SMove> moves;
+    std::mt19937 random(1);
+    for (std::size_t line = 0; line < VARIATION_LINES; line++)
+    {
+      CVariationTree::node_t node = std::uniform_int_distribution<CVariationTree::node_t>(
+        0, static_cast<CVariationTree::node_t>(reference.GetNodeCount() - 1))(random);
+      reference.Materialize(node, board);
+      for (std::size_t ply = 0; ply < VARIATION_LINE_PLIES; ply++)
+      {
+        moves.clear();
+        board.GetAllValidMoves(board.IsWhiteToMove(), moves);
+        if (moves.empty())
+        {
+          break;
+        }
+        const SMove move = moves[std::uniform_int_distribution<std::size_t>(0, moves.size() - 1)(random)];
+        const std::optional<CVariationTree::node_t> child = reference.AddMove(node, move);
+        if (!child)
+        {
+          JC_LOG_ERROR(m_logger, "Variation tree rejects a valid move: " + MoveToString(move));
+          return false;
+        }
+        additions.emplace_back(node, move);
+        board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove());
+        node = *child;
+      }
+    }
+    tree.m_lines = VARIATION_LINES;
+    tree.m_nodes = reference.GetNodeCount();
+    tree.m_snapshots = reference.GetSnapshotCount();
+    tree.m_memory = reference.GetMemoryUsage();
+    tree.m_statistics = reference.GetStatistics();
+
+    const std::size_t iterations = std::min(m_options.m_iterations, additions.size());
+    results.push_back(Measure("variation_tree", "AddMove", [&]()
+    {
+      CVariationTree sample(m_logger);
+      const auto start = clock_t::now();
+      for (std::size_t ind = 0; ind < iterations; ind++)
+      {
+        DoNotOptimize(sample.AddMove(additions[ind].first, additions[ind].second).value_or(0));
+      }
+      return ElapsedNs(start) * m_options.m_iterations / iterations;
+    }));
+
+    std::vector<CVariationTree::node_t> nodes(m_options.m_iterations);
+    for (auto& node : nodes)
+    {
+      node = std::uniform_int_distribution<CVariationTree::node_t>(
+        0, static_cast<CVariationTree::node_t>(reference.GetNodeCount() - 1))(random);
+    }
+    results.push_back(Measure("variation_tree", "Materialize", [&]()
+    {
+      const auto start = clock_t::now();
+      for (const auto node : nodes)
+      {
+        reference.Materialize(node, board);
+        DoNotOptimize(board.IsWhiteToMove());
+      }
+      return ElapsedNs(start);
+    }));
+    return true;
+  }
+
+  bool CBenchmark::MeasureNnue(const std::vector<SPosition>& positions, std::vector<SResult>& results) const
+  {
+    const std::size_t iterations = m_options.m_iterations;
+    std::vector<eSimdLevel> levels{ eSimdLevel::scalar };
+    if (DetectSimdLevel() == eSimdLevel::avx2)
+    {
+      levels.push_back(eSimdLevel::avx2);
+    }
+    for (const eSimdLevel level : levels)
+    {
+      CNnue nnue(level);
+      if (m_options.m_nnueWeights.empty())
+      {
+        nnue.InitRandom(1);
+      }
+      else if (!nnue.LoadWeights(m_options.m_nnueWeights))
+      {
+        JC_LOG_ERROR(m_logger, "NNUE weights can not be loaded: " + m_options.m_nnueWeights);
+        return false;
+      }
+
+      // consecutive positions are one move apart (except between two games)
+      CNnue::SAccumulator accumulator;
+      CNnue::SAccumulator refreshed;
+      nnue.Refresh(positions[0].m_board, accumulator);
+      for (std::size_t ind = 1; ind < positions.size(); ind++)
+      {
+        nnue.Update(positions[ind - 1].m_board, positions[ind].m_board, accumulator);
+        nnue.Refresh(positions[ind].m_board, refreshed);
+        if (accumulator.m_values != refreshed.m_values ||
+            nnue.Evaluate(accumulator, positions[ind].m_whiteToMove) != nnue.Evaluate(positions[ind]))
+        {
+          JC_LOG_ERROR(m_logger, "Incremental NNUE update differs from refresh");
+          return false;
+        }
+      }
+
+      const std::string suffix = std::string("_") + SimdLevelName(nnue.GetSimdLevel());
+      results.push_back(Measure("eval_batch", ("CNnue_refresh" + suffix).c_str(), [&]()
+      {
+        const auto start = clock_t::now();
+        for (std::size_t ind = 0; ind < iterations; ind++)
+        {
+          const SPosition& position = positions[ind % positions.size()];
+          nnue.Refresh(position.m_board, accumulator);
+          DoNotOptimize(nnue.Evaluate(accumulator, position.m_whiteToMove));
+        }
+        return ElapsedNs(start);
+      }));
+      results.push_back(Measure("eval_batch", ("CNnue_incremental" + suffix).c_str(), [&]()
+      {
+        nnue.Refresh(positions[0].m_board, accumulator);
+        const auto start = clock_t::now();
+        for (std::size_t ind = 1; ind <= iterations; ind++)
+        {
+          const SPosition& position = positions[ind % positions.size()];
+          nnue.Update(positions[(ind - 1) % positions.size()].m_board, position.m_board, accumulator);
+          DoNotOptimize(nnue.Evaluate(accumulator, position.m_whiteToMove));
+        }
+        return ElapsedNs(start);
+      }));
+    }
+    return true;
+  }
+
+  bool CBenchmark::ParseArgs(const std::vector<std::string>& args, SBenchmarkOptions& options)
+  {
+    for (std::size_t ind = 1; ind < args.size(); ind++)
+    {
+      const std::string& arg = args[ind];
+      if (ind + 1 >= args.size())
+      {
+        return false; // every option has a value
+      }
+      const std::string& value = args[++ind];
+      if (arg == "--nnue")
+      {
+        options.m_nnueWeights = value;
+        continue;
+      }
+      if (arg == "--format")
+      {
+        if (value == "json")
+        {
+          options.m_format = eBenchmarkFormat::json;
+        }
+        else if (value == "csv")
+        {
+          options.m_format = eBenchmarkFormat::csv;
+        }
+        else
+        {
+          return false;
+        }
+        continue;
+      }
+
+      std::size_t number;
+      try
+      {
+        number = std::stoul(value);
+      }
+      catch (const std::exception&)
+      {
+        return false;
+      }
+      if (arg == "--depth")
+      {
+        options.m_depth = number;
+      }
+      else if (arg == "--reps" && number > 0)
+      {
+        options.m_repetitions = number;
+      }
+      else if (arg == "--warmup")
+      {
+        options.m_warmup = number;
+      }
+      else if (arg == "--iterations" && number > 0)
+      {
+        options.m_iterations = number;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int RunBenchmark(Logger logger, const std::vector<std::string>& args)
+  {
+    SBenchmarkOptions options;
+    if (!CBenchmark::ParseArgs(args, options))
+    {
+      std::cerr << "Usage: JustChess bench [--depth N] [--reps N] [--warmup N] "
+                   "[--iterations N] [--format json|csv] [--nnue FILE]" << std::endl;
+      return 2;
+    }
+    CBenchmark benchmark(logger, options);
+    return benchmark.Run(std::cout) ? 0 : 1;
+  }
+}
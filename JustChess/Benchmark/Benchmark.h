@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Logger/Logger.h"
+#include "Functional/ChessBoard/ChessBoard.h"
+#include "Evaluation/PawnStructure.h"
+#include "Functional/VariationTree/VariationTree.h"
+
+/**
+ *  @defgroup benchmark Benchmark
+ */
+
+namespace JC
+{
+  /// @brief Output format of the benchmark results
+  enum class eBenchmarkFormat : uint8_t
+  {
+    json = 0,
+    csv
+  };
+
+  /// @brief Position of the benchmark corpus, given as moves from the start position
+  struct SBenchmarkPosition
+  {
+    const char* m_name;
+    /// @brief Moves in coordinate notation separated by spaces (white starts)
+    const char* m_moves;
+  };
+
+  /// @brief Settings of a benchmark run
+  struct SBenchmarkOptions
+  {
+    /// @brief Samples per primitive and position which are not reported
+    std::size_t m_warmup = 2;
+    /// @brief Reported samples per primitive and position
+    std::size_t m_repetitions = 5;
+    /// @brief Calls of the primitive per sample
+    std::size_t m_iterations = 200;
+    /// @brief Depth of the node count ("bench signature"); 0 to skip
+    std::size_t m_depth = 3;
+    eBenchmarkFormat m_format = eBenchmarkFormat::json;
+    /// @brief Weights file of @c CNnue; random weights if empty
+    std::string m_nnueWeights;
+  };
+
+  /*!******************************************************************
+  * @class CBenchmark
+  *
+  * @ingroup benchmark
+  *
+  * @brief Repeatable microbenchmarks of the @c CChessBoard primitives.
+  *
+  * @details Each primitive (@c GetValidMoves, @c Move, @c IsChecked,
+  * @c GetAttackedSquares, @c CheckmateState, @c ThreefoldRepetition,
+  * @c GetGameStatus, @c Reset, @c CreateNextRecord) is measured on every position of a fixed corpus (openings, middlegame,
+  * endgames, repetition-heavy game). After the warm-up samples, the median
+  * and minimum time per call of the remaining samples are reported.
+  *
+  * The static evaluation is measured per position ("eval_batch"), one by one
+  * and in batches for every instruction set supported by the CPU, as well as
+  * @c CNnue with full refresh and with incremental updates along the games.
+  * The pawn structure evaluation is measured with and without
+  * @c CPawnHashTable; the hit rate of one pass with an empty table is reported.
+  *
+  * Every valid move of each position is applied once more while counting the
+  * heap allocations (@c CAllocationCheck): the run fails if @c Move(),
+  * @c CheckmateState() or @c GetGameStatus() allocate after a warm-up pass.
+  * The check needs a build with @c JC_COUNT_ALLOCATIONS and is skipped
+  * otherwise ("allocations_counted" in the JSON output).
+  *
+  * @c CVariationTree is built from random lines branching off at random
+  * nodes; reported are the bytes per node, the snapshot hit rate of the
+  * boards set up by @c AddMove() and the time of @c AddMove() and
+  * @c Materialize().
+  *
+  * Additionally the number of nodes of a fixed-depth move tree is counted
+  * for every position. The sum is the bench signature: if it changes
+  * between two builds, the behaviour of the move generation changed.
+  *
+  * Run from the command line:
+  * @code
+  * JustChess bench [--depth N] [--reps N] [--warmup N] [--iterations N] [--format json|csv] [--nnue FILE]
+  * @endcode
+  ********************************************************************/
+  class CBenchmark
+  {
+  public:
+    CBenchmark(Logger logger, const SBenchmarkOptions& options)
+      : m_logger(logger)
+      , m_options(options)
+    {}
+
+    /// @brief Runs all benchmarks and writes the results.
+    /// @return @c false if a position of the corpus could not be set up
+    bool Run(std::ostream& out);
+
+    /// @brief Counts the leaf nodes of the move tree.
+    /// @param board board at the root position (side to move is taken from the board)
+    /// @param depth depth of the tree
+    /// @return number of leaf nodes
+    static uint64_t Perft(CChessBoard& board, std::size_t depth);
+
+    /// @brief Parses the command line arguments following "bench".
+    /// @return @c false if an argument is invalid
+    static bool ParseArgs(const std::vector<std::string>& args, SBenchmarkOptions& options);
+
+    /// @brief Resets the board and applies the moves.
+    /// @return @c false if a move is not valid
+    static bool Replay(CChessBoard& board, const std::vector<SMove>& line);
+
+    /// @brief Parses the moves of a corpus position.
+    /// @return @c false if a move can not be parsed
+    static bool ParseLine(const char* moves, std::vector<SMove>& line);
+
+    /// @return the fixed benchmark corpus
+    static const std::vector<SBenchmarkPosition>& GetCorpus();
+
+  private:
+    /// @brief Timing results of one primitive on one position
+    struct SResult
+    {
+      std::string m_position;
+      std::string m_primitive;
+      double m_medianNs;
+      double m_minNs;
+    };
+
+    /// @brief Size and board setups of the tree built by @c MeasureVariationTree()
+    struct SVariationTreeResult
+    {
+      std::size_t m_lines = 0;
+      std::size_t m_nodes = 0;
+      std::size_t m_snapshots = 0;
+      std::size_t m_memory = 0;
+      SVariationTreeStatistics m_statistics;
+    };
+
+    /// @brief Measures samples of @p sample, which returns the elapsed ns for @c m_iterations calls.
+    template<typename Sample>
+    SResult Measure(const char* position, const char* primitive, Sample sample) const;
+
+    /// @brief Applies every valid move to the position and queries the state after it
+    /// (as a game does), counting the heap allocations with @c CAllocationCheck.
+    /// @return @c false if the move path allocates after a warm-up pass
+    bool CheckAllocations(const char* position, CChessBoard& board, const SPosition& snapshot,
+      const CChessBoard::history_t& history, const std::vector<SMove>& moves) const;
+
+    /// @brief Measures the static evaluation of @c m_iterations positions of the corpus games,
+    /// one by one and with @c CBatchEvaluator for each supported instruction set.
+    /// @param pawnHash counters of @c CPawnHashTable after one pass over the positions
+    /// @return @c false if a batch result differs from the scalar evaluation
+    bool MeasureEvaluation(std::vector<SResult>& results, SPawnHashStatistics& pawnHash) const;
+
+    /// @brief Measures @c EvaluatePawnStructure() and @c CPawnHashTable on the positions.
+    /// @return @c false if a result from the table differs from the uncached evaluation
+    bool MeasurePawnStructure(const std::vector<SPosition>& positions, std::vector<SResult>& results,
+      SPawnHashStatistics& pawnHash) const;
+
+    /// @brief Builds a @c CVariationTree of seeded random lines, each branching off at a random node,
+    /// and measures @c AddMove() along these lines and @c Materialize() at random nodes.
+    /// @return @c false if a valid move is rejected by the tree
+    bool MeasureVariationTree(std::vector<SResult>& results, SVariationTreeResult& tree) const;
+
+    /// @brief Measures @c CNnue on the positions: refresh and incremental update, each plus evaluation.
+    /// @return @c false if the weights can't be loaded or an incremental result differs from the refresh
+    bool MeasureNnue(const std::vector<SPosition>& positions, std::vector<SResult>& results) const;
+
+    Logger m_logger;
+    SBenchmarkOptions m_options;
+  };
+
+  /// @brief Entry point of the command "bench".
+  /// @return process exit code
+  int RunBenchmark(Logger logger, const std::vector<std::string>& args);
+}
@@ -0,0 +1,354 @@
+#include <stdafx.h>
+
+#include "EpdSuite.h"
+#include "..\Concurrency\WorkerPool.h"
+#include "..\Functional\Notation\Notation.h"
+
+namespace JC
+{
+  namespace
+  {
+    using operation_t = std::vector<std::string_view>;
+
+    /// @brief Splits the operations of an EPD record into words. A quoted string
+    /// is one word (without the quotes), ';' ends an operation.
+    bool SplitOperations(std::string_view text, std::vector<operation_t>& operations)
+    {
+      operation_t operation;
+      std::size_t pos = 0;
+      while (pos < text.size())
+      {
+        const char current = text[pos];
+        if (current == ' ' || current == '\t' || current == '\r')
+        {
+          pos++;
+        }
+        else if (current == ';')
+        {
+          if (!operation.empty())
+          {
+            operations.push_back(std::move(operation));
+            operation.clear();
+          }
+          pos++;
+        }
+        else if (current == '"')
+        {
+          const std::size_t end = text.find('"', pos + 1);
+          if (end == std::string_view::npos)
+          {
+            return false;
+          }
+          operation.push_back(text.substr(pos + 1, end - pos - 1));
+          pos = end + 1;
+        }
+        else
+        {
+          const std::size_t end = std::min(text.find_first_of(" \t\r;", pos), text.size());
+          operation.push_back(text.substr(pos, end - pos));
+          pos = end;
+        }
+      }
+      // the ';' of the last operation is often missing
+      if (!operation.empty())
+      {
+        operations.push_back(std::move(operation));
+      }
+      return true;
+    }
+
+    void WriteJsonString(std::ostream& out, std::string_view text)
+    {
+      out << '"';
+      for (const char current : text)
+      {
+        if (current == '"' || current == '\\')
+        {
+          out << '\\';
+        }
+        out << current;
+      }
+      out << '"';
+    }
+  }
+
+  bool CEpdSuite::ParseEpd(std::string_view text, CChessBoard& board, SEpdEntry& entry)
+  {
+    // the position are the first four fields (no move counters)
+    std::size_t pos = 0;
+    for (std::size_t field = 0; field < 4; field++)
+    {
+      pos = text.find_first_not_of(" \t", pos);
+      if (pos == std::string_view::npos)
+      {
+        return false;
+      }
+      pos = std::min(text.find_first_of(" \t", pos), text.size());
+    }
+    if (!ParseFen(text.substr(0, pos), entry.m_position))
+    {
+      return false;
+    }
+    board.Restore(entry.m_position);
+
+    std::vector<operation_t> operations;
+    if (!SplitOperations(text.substr(pos), operations))
+    {
+      return false;
+    }
+    entry.m_bestMoves.clear();
+    entry.m_avoidMoves.clear();
+    entry.m_expected.clear();
+    for (const operation_t& operation : operations)
+    {
+      const std::string_view opcode = operation.front();
+      if (opcode == "id" && operation.size() > 1)
+      {
+        entry.m_id = std::string(operation[1]);
+      }
+      else if (opcode == "bm" || opcode == "am")
+      {
+        std::vector<SMove>& moves = opcode == "bm" ? entry.m_bestMoves : entry.m_avoidMoves;
+        entry.m_expected += (entry.m_expected.empty() ? "" : "; ") + std::string(opcode);
+        for (std::size_t ind = 1; ind < operation.size(); ind++)
+        {
+          SMove move;
+          if (!ParseSanMove(board, operation[ind], move))
+          {
+            return false;
+          }
+          moves.push_back(move);
+          entry.m_expected += " " + std::string(operation[ind]);
+        }
+      }
+    }
+    return !entry.m_bestMoves.empty() || !entry.m_avoidMoves.empty();
+  }
+
+  std::size_t CEpdSuite::Load(std::istream& in, std::vector<SEpdEntry>& entries) const
+  {
+    CChessBoard board(m_logger);
+    std::size_t invalid = 0;
+    std::size_t lineNumber = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+      lineNumber++;
+      const std::size_t start = line.find_first_not_of(" \t\r");
+      if (start == std::string::npos || line[start] == '#')
+      {
+        continue;
+      }
+      SEpdEntry entry;
+      entry.m_line = lineNumber;
+      if (!ParseEpd(line, board, entry))
+      {
+        invalid++;
+        JC_LOG_WARNING(m_logger, "EPD record skipped (invalid position or move) in line " + std::to_string(lineNumber));
+        continue;
+      }
+      if (entry.m_id.empty())
+      {
+        entry.m_id = "line " + std::to_string(lineNumber);
+      }
+      entries.push_back(std::move(entry));
+    }
+    return invalid;
+  }
+
+  bool CEpdSuite::IsCorrect(const SEpdEntry& entry, const SMove& move)
+  {
+    const auto equals = [&move](const SMove& other)
+      {
+        return other.m_fromRank == move.m_fromRank && other.m_fromFile == move.m_fromFile &&
+          other.m_toRank == move.m_toRank && other.m_toFile == move.m_toFile;
+      };
+    return (entry.m_bestMoves.empty() || std::any_of(entry.m_bestMoves.begin(), entry.m_bestMoves.end(), equals)) &&
+      std::none_of(entry.m_avoidMoves.begin(), entry.m_avoidMoves.end(), equals);
+  }
+
+  SEpdResult CEpdSuite::Solve(const SEpdEntry& entry) const
+  {
+    const CEngine engine(m_options.m_engine);
+    CSearch search(engine.GetEvaluator());
+    const CChessBoard board(m_logger, entry.m_position);
+    const auto start = std::chrono::steady_clock::now();
+    search.SetDeadline(start + std::chrono::milliseconds(m_options.m_timeMs));
+
+    SEpdResult result;
+    for (std::size_t depth = 1; depth <= m_options.m_maxDepth; depth++)
+    {
+      const SSearchResult iteration = search.Search(board, depth);
+      result.m_nodes += iteration.m_nodes;
+      if (!iteration.m_complete)
+      {
+        break;
+      }
+      const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      result.m_depth = depth;
+      result.m_bestMove = iteration.m_bestMove;
+      if (!iteration.m_bestMove || !IsCorrect(entry, *iteration.m_bestMove))
+      {
+        result.m_solveMs.reset();
+      }
+      else if (!result.m_solveMs)
+      {
+        result.m_solveMs = elapsedMs;
+      }
+      // a found mate does not change with more depth
+      if (!iteration.m_bestMove || std::abs(iteration.m_score) >= MATE_SCORE - static_cast<int>(depth))
+      {
+        break;
+      }
+    }
+    result.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+  }
+
+  bool CEpdSuite::Run(std::istream& in, std::ostream& out)
+  {
+    std::vector<SEpdEntry> entries;
+    const std::size_t invalid = Load(in, entries);
+    if (entries.empty())
+    {
+      JC_LOG_ERROR(m_logger, "EPD suite has no valid record");
+      return false;
+    }
+
+    std::vector<SEpdResult> results(entries.size());
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t threads = 0;
+    {
+      CWorkerPool pool(m_options.m_threads);
+      threads = pool.GetThreadCount();
+      for (std::size_t ind = 0; ind < entries.size(); ind++)
+      {
+        pool.Submit([this, &entries, &results, ind]() { results[ind] = Solve(entries[ind]); });
+      }
+      pool.WaitIdle();
+    }
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t solved = 0;
+    uint64_t nodes = 0;
+    double searchSeconds = 0.0;
+    double solveMs = 0.0;
+    out << "{\n  \"positions\": [";
+    for (std::size_t ind = 0; ind < entries.size(); ind++)
+    {
+      const SEpdEntry& entry = entries[ind];
+      const SEpdResult& result = results[ind];
+      nodes += result.m_nodes;
+      searchSeconds += result.m_seconds;
+      if (result.IsSolved())
+      {
+        solved++;
+        solveMs += *result.m_solveMs;
+      }
+
+      out << (ind > 0 ? "," : "") << "\n    {\"id\": ";
+      WriteJsonString(out, entry.m_id);
+      out << ", \"line\": " << entry.m_line << ", \"expected\": ";
+      WriteJsonString(out, entry.m_expected);
+      out << ", \"move\": \"" << (result.m_bestMove ? MoveToString(*result.m_bestMove) : "") << "\""
+          << ", \"solved\": " << (result.IsSolved() ? "true" : "false") << ", \"solve_ms\": ";
+      if (result.m_solveMs)
+      {
+        out << *result.m_solveMs;
+      }
+      else
+      {
+        out << "null";
+      }
+      out << ", \"depth\": " << result.m_depth << ", \"nodes\": " << result.m_nodes
+          << ", \"ms\": " << result.m_seconds * 1e3 << "}";
+    }
+    out << "\n  ],\n  \"eval\": \"" << m_options.m_engine.m_evaluator
+        << "\",\n  \"time_ms\": " << m_options.m_timeMs
+        << ",\n  \"threads\": " << threads
+        << ",\n  \"total\": " << entries.size() << ",\n  \"solved\": " << solved << ",\n  \"skipped\": " << invalid
+        << ",\n  \"solve_ms_total\": " << solveMs << ",\n  \"nodes\": " << nodes
+        << ",\n  \"nodes_per_second\": " << (searchSeconds > 0.0 ? static_cast<double>(nodes) / searchSeconds : 0.0)
+        << ",\n  \"wall_seconds\": " << wallSeconds << "\n}\n";
+    return true;
+  }
+
+  bool CEpdSuite::ParseArgs(const std::vector<std::string>& args, SEpdOptions& options, std::string& path)
+  {
+    for (std::size_t ind = 1; ind < args.size(); ind++)
+    {
+      const std::string& arg = args[ind];
+      if (arg == "-" || arg.rfind("--", 0) != 0)
+      {
+        if (!path.empty())
+        {
+          return false;
+        }
+        path = arg;
+        continue;
+      }
+      if (ind + 1 >= args.size())
+      {
+        return false; // every option has a value
+      }
+      const std::string& value = args[++ind];
+      if (arg == "--eval")
+      {
+        if (!CEngine::ParseOptions("eval=" + value, options.m_engine))
+        {
+          return false;
+        }
+        continue;
+      }
+      uint64_t number;
+      try
+      {
+        number = std::stoull(value);
+      }
+      catch (const std::exception&)
+      {
+        return false;
+      }
+      if (arg == "--time-ms" && number >= 1)
+      {
+        options.m_timeMs = static_cast<std::size_t>(number);
+      }
+      else if (arg == "--depth" && number >= 1)
+      {
+        options.m_maxDepth = static_cast<std::size_t>(number);
+      }
+      else if (arg == "--threads")
+      {
+        options.m_threads = static_cast<std::size_t>(number);
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return !path.empty();
+  }
+
+  int RunEpdSuite(Logger logger, const std::vector<std::string>& args)
+  {
+    SEpdOptions options;
+    std::string path;
+    if (!CEpdSuite::ParseArgs(args, options, path))
+    {
+      std::cerr << "Usage: JustChess epd FILE|- [--time-ms N] [--depth N] [--threads N] [--eval material|pawns]" << std::endl;
+      return 2;
+    }
+    std::ifstream file;
+    if (path != "-")
+    {
+      file.open(path);
+      if (!file)
+      {
+        JC_LOG_ERROR(logger, "EPD suite can not be read: " + path);
+        return 2;
+      }
+    }
+    CEpdSuite suite(logger, options);
+    return suite.Run(path == "-" ? std::cin : file, std::cout) ? 0 : 1;
+  }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Search/Engine.h"
+
+namespace JC
+{
+  /// @brief Settings of a @c CEpdSuite run
+  struct SEpdOptions
+  {
+    /// @brief Evaluation of the searching engines; the depth is given by @c m_maxDepth
+    SEngineOptions m_engine;
+    /// @brief Search time per position in milliseconds
+    std::size_t m_timeMs = 1000;
+    /// @brief Iterative deepening ends at this depth even if time is left
+    std::size_t m_maxDepth = 64;
+    /// @brief Positions searched at the same time; 0 for one per hardware thread
+    std::size_t m_threads = 0;
+  };
+
+  /// @brief Position of an EPD test suite
+  struct SEpdEntry
+  {
+    /// @brief Operation "id", or "line N" if the record has none
+    std::string m_id;
+    /// @brief Line in the suite file (starting at 1)
+    std::size_t m_line = 0;
+    SPosition m_position;
+    /// @brief Moves of the operation "bm"; one of them has to be found
+    std::vector<SMove> m_bestMoves;
+    /// @brief Moves of the operation "am"; none of them may be played
+    std::vector<SMove> m_avoidMoves;
+    /// @brief The "bm" and "am" operations as written in the record
+    std::string m_expected;
+  };
+
+  /// @brief Result of one position of an EPD test suite
+  struct SEpdResult
+  {
+    /// @brief Best move of the deepest finished iteration
+    std::optional<SMove> m_bestMove;
+    /// @brief Time from which on all finished iterations chose a correct move
+    std::optional<double> m_solveMs;
+    /// @brief Deepest finished iteration
+    std::size_t m_depth = 0;
+    uint64_t m_nodes = 0;
+    double m_seconds = 0.0;
+
+    bool IsSolved() const { return m_solveMs.has_value(); }
+  };
+
+  /*!******************************************************************
+  * @class CEpdSuite
+  *
+  * @ingroup benchmark
+  *
+  * @brief Runs EPD test suites and measures the time to solution.
+  *
+  * @details Every record of a suite is a position (the first four FEN fields)
+  * followed by operations, e.g.
+  * @code
+  * 2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - bm Qg6; id "WAC.001";
+  * @endcode
+  * Used are "bm" (best moves), "am" (moves to avoid) and "id". Moves are
+  * given in standard algebraic notation and are resolved against the valid
+  * moves of a @c CChessBoard, so records with illegal or ambiguous moves are
+  * skipped with a warning.
+  *
+  * Each position is searched by iterative deepening with @c CSearch until the
+  * time per position is used up. The time to solution is the time after which
+  * every finished iteration chose a correct move; a position is solved if
+  * there is such a time. The positions are searched in parallel on a
+  * @c CWorkerPool; for comparable times use at most one thread per core.
+  *
+  * The results are written as JSON: one object per position and the totals
+  * (solved positions, summed time to solution, nodes per second).
+  *
+  * Run from the command line:
+  * @code
+  * JustChess epd FILE|- [--time-ms N] [--depth N] [--threads N] [--eval material|pawns]
+  * @endcode
+  ********************************************************************/
+  class CEpdSuite
+  {
+  public:
+    CEpdSuite(Logger logger, const SEpdOptions& options)
+      : m_logger(logger)
+      , m_options(options)
+    {}
+
+    /// @brief Parses one EPD record.
+    /// @param board board used to resolve the moves of the operations (its position is changed)
+    /// @return @c false if the record is invalid or has neither "bm" nor "am"
+    static bool ParseEpd(std::string_view text, CChessBoard& board, SEpdEntry& entry);
+
+    /// @brief Reads all records of a suite; empty lines and lines starting with '#' are ignored.
+    /// @return number of invalid records, which are skipped
+    std::size_t Load(std::istream& in, std::vector<SEpdEntry>& entries) const;
+
+    /// @brief Searches one position within the time limit.
+    SEpdResult Solve(const SEpdEntry& entry) const;
+
+    /// @brief Loads a suite, searches all positions and writes the results as JSON.
+    /// @return @c false if the suite has no valid record
+    bool Run(std::istream& in, std::ostream& out);
+
+    /// @brief Parses the arguments of the command "epd".
+    /// @return @c false if an argument is invalid
+    static bool ParseArgs(const std::vector<std::string>& args, SEpdOptions& options, std::string& path);
+
+  private:
+    /// @return @c true if the move is one of the best moves and none of the moves to avoid
+    static bool IsCorrect(const SEpdEntry& entry, const SMove& move);
+
+    Logger m_logger;
+    SEpdOptions m_options;
+  };
+
+  /// @brief Entry point of the command "epd".
+  /// @return process exit code
+  int RunEpdSuite(Logger logger, const std::vector<std::string>& args);
+}
@@ -0,0 +1,132 @@
+#include <stdafx.h>
+
+#include "MateBenchmark.h"
+#include "..\Functional\Notation\Notation.h"
+
+namespace JC
+{
+  namespace
+  {
+    double Percentile(const std::vector<double>& sorted, double fraction)
+    {
+      if (sorted.empty())
+      {
+        return 0.0;
+      }
+      const std::size_t ind = std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * sorted.size()));
+      return sorted[ind];
+    }
+
+    const char* ResultToString(eMateResult result)
+    {
+      switch (result)
+      {
+      case eMateResult::eMate:    return "mate";
+      case eMateResult::eNoMate:  return "no-mate";
+      default:                    return "unknown";
+      }
+    }
+  }
+
+  const std::vector<SMatePuzzle>& CMateBenchmark::GetPuzzles()
+  {
+    static const std::vector<SMatePuzzle> s_puzzles =
+    {
+      { "back_rank", "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 1, true },
+      { "fools_mate", "rnbqkbnr/pppp1ppp/8/4p3/6P1/5P2/PPPPP2P/RNBQKBNR b KQkq - 0 2", 1, true },
+      { "scholars_mate", "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", 1, true },
+      { "smothered", "6rk/6pp/7N/8/8/8/8/6K1 w - - 0 1", 1, true },
+      { "rook_sacrifice", "kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1", 2, true },
+      { "two_rooks", "7k/8/8/8/8/8/R7/1R5K w - - 0 1", 2, true },
+      { "queen_sacrifice", "r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 1", 2, true },
+      { "knight_bishop", "r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1", 2, true },
+      { "opera_game", "4kb1r/p2n1ppp/4q3/4p1B1/4P3/1Q6/PPP2PPP/2KR4 w k - 1 1", 2, true },
+      { "black_rooks", "6k1/pp4p1/2p5/2bp4/8/P5Pb/1P3rrP/2BRRN1K b - - 0 1", 2, true },
+      { "queen_ending_3", "k7/8/8/8/3K4/8/8/1Q6 w - - 0 1", 3, true },
+      { "rook_ending_3", "k7/8/8/3K4/8/8/8/7R w - - 0 1", 3, true },
+      { "rook_and_bishop", "r5rk/5p1p/5R2/4B3/8/8/7P/7K w - - 0 1", 3, true },
+      { "queen_ending_4", "k7/8/8/8/8/3K4/8/1Q6 w - - 0 1", 4, true },
+      { "queen_ending_4b", "k7/8/8/8/8/2K5/8/1Q6 w - - 0 1", 4, true },
+      { "bare_kings", "8/8/8/4k3/8/8/8/4K3 w - - 0 1", 3, false },
+      { "rook_ending", "8/8/8/8/8/5k2/8/5K1R w - - 0 1", 4, false },
+      { "rook_ending_far", "k7/8/8/8/3K4/8/8/7R w - - 0 1", 4, false },
+      { "start_position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 3, false },
+    };
+    return s_puzzles;
+  }
+
+  bool CMateBenchmark::Run(std::ostream& out)
+  {
+    CMateSolver solver(m_logger, m_options);
+    CChessBoard board(m_logger);
+    std::vector<double> times;
+    uint64_t nodes = 0;
+    std::size_t failures = 0;
+
+    out << "{\n  \"puzzles\": [";
+    const auto& puzzles = GetPuzzles();
+    for (std::size_t ind = 0; ind < puzzles.size(); ind++)
+    {
+      const SMatePuzzle& puzzle = puzzles[ind];
+      SPosition position;
+      if (!ParseFen(puzzle.m_fen, position))
+      {
+        JC_LOG_ERROR(m_logger, std::string("Mate puzzle can not be set up: ") + puzzle.m_name);
+        return false;
+      }
+      board.Restore(position);
+      solver.Clear();
+      const SMateResult result = solver.Solve(board, puzzle.m_moves);
+      const bool solved = result.m_moves == puzzle.m_moves &&
+        result.m_result == (puzzle.m_mate ? eMateResult::eMate : eMateResult::eNoMate);
+      if (!solved)
+      {
+        failures++;
+        JC_LOG_ERROR(m_logger, std::string("Mate puzzle not solved: ") + puzzle.m_name);
+      }
+      times.push_back(result.m_seconds * 1e3);
+      nodes += result.m_nodes;
+
+      out << (ind > 0 ? "," : "") << "\n    {\"name\": \"" << puzzle.m_name
+          << "\", \"expected\": \"" << (puzzle.m_mate ? "mate" : "no-mate") << " " << puzzle.m_moves
+          << "\", \"result\": \"" << ResultToString(result.m_result) << " " << result.m_moves
+          << "\", \"line\": \"";
+      for (std::size_t move = 0; move < result.m_line.size(); move++)
+      {
+        out << (move > 0 ? " " : "") << MoveToString(result.m_line[move]);
+      }
+      out << "\", \"nodes\": " << result.m_nodes << ", \"ms\": " << result.m_seconds * 1e3
+          << ", \"solved\": " << (solved ? "true" : "false") << "}";
+    }
+
+    std::sort(times.begin(), times.end());
+    double total = 0.0;
+    for (const double time : times)
+    {
+      total += time;
+    }
+    out << "\n  ],\n  \"threads\": " << solver.GetThreadCount()
+        << ",\n  \"solved\": " << puzzles.size() - failures << ",\n  \"failed\": " << failures
+        << ",\n  \"solve_ms\": {\"min\": " << Percentile(times, 0.0) << ", \"p50\": " << Percentile(times, 0.5)
+        << ", \"p90\": " << Percentile(times, 0.9) << ", \"max\": " << Percentile(times, 1.0)
+        << ", \"total\": " << total << "}"
+        << ",\n  \"nodes_per_second\": " << (total > 0.0 ? static_cast<double>(nodes) / (total * 1e-3) : 0.0)
+        << "\n}\n";
+    return failures == 0;
+  }
+
+  int RunMateBenchmark(Logger logger, const std::vector<std::string>& args)
+  {
+    SMateSolverOptions options;
+    std::size_t maxMoves = 0;
+    std::vector<std::string> positional;
+    // the searched moves are given per puzzle
+    if (!CMateSolver::ParseArgs(args, options, maxMoves, positional) || !positional.empty() || maxMoves != 0)
+    {
+      std::cerr << "Usage: JustChess mate-bench [--threads N] [--hash MB] [--nodes N]" << std::endl;
+      return 2;
+    }
+    CMateBenchmark benchmark(logger, options);
+    return benchmark.Run(std::cout) ? 0 : 1;
+  }
+}
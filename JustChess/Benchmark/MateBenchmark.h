@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Search/MateSolver.h"
+
+namespace JC
+{
+  /// @brief Position of the mate benchmark
+  struct SMatePuzzle
+  {
+    const char* m_name;
+    const char* m_fen;
+    /// @brief Moves until the mate, or the searched moves if there is no mate
+    std::size_t m_moves;
+    /// @brief @c false if it is proven that there is no mate within @c m_moves
+    bool m_mate;
+  };
+
+  /*!******************************************************************
+  * @class CMateBenchmark
+  *
+  * @ingroup benchmark
+  *
+  * @brief Solves a fixed set of mate puzzles with @c CMateSolver.
+  *
+  * @details The set contains mates in one to four moves (back rank,
+  * smothered mates, combinations with sacrifices) and positions without a
+  * mate within the searched moves, which have to be disproven. The
+  * transposition table is cleared before every puzzle. Reported are the
+  * result, line, nodes and solve time per puzzle and the distribution of
+  * the solve times (minimum, median, 90th percentile, maximum).
+  *
+  * Run from the command line:
+  * @code
+  * JustChess mate-bench [--threads N] [--hash MB] [--nodes N]
+  * @endcode
+  ********************************************************************/
+  class CMateBenchmark
+  {
+  public:
+    CMateBenchmark(Logger logger, const SMateSolverOptions& options)
+      : m_logger(logger)
+      , m_options(options)
+    {}
+
+    /// @brief Solves all puzzles and writes the results as JSON.
+    /// @return @c false if a puzzle can not be set up or a result is wrong
+    bool Run(std::ostream& out);
+
+    /// @return the fixed puzzle set
+    static const std::vector<SMatePuzzle>& GetPuzzles();
+
+  private:
+    Logger m_logger;
+    SMateSolverOptions m_options;
+  };
+
+  /// @brief Entry point of the command "mate-bench".
+  /// @return process exit code
+  int RunMateBenchmark(Logger logger, const std::vector<std::string>& args);
+}
@@ -0,0 +1,75 @@
+#include <stdafx.h>
+
+#include "WorkerPool.h"
+
+namespace JC
+{
+  CWorkerPool::CWorkerPool(std::size_t threads)
+    : m_running(0)
+    , m_stop(false)
+  {
+    if (threads == 0)
+    {
+      threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+    m_threads.reserve(threads);
+    for (std::size_t ind = 0; ind < threads; ind++)
+    {
+      m_threads.emplace_back(&CWorkerPool::Run, this);
+    }
+  }
+
+  CWorkerPool::~CWorkerPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_taskAvailable.notify_all();
+    for (auto& thread : m_threads)
+    {
+      thread.join();
+    }
+  }
+
+  void CWorkerPool::Submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.push_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+  }
+
+  void CWorkerPool::WaitIdle()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_tasks.empty() && m_running == 0; });
+  }
+
+  void CWorkerPool::Run()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+      m_taskAvailable.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+      if (m_tasks.empty())
+      {
+        return; // stopped and all tasks done
+      }
+      std::function<void()> task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+      m_running++;
+      lock.unlock();
+
+      task();
+
+      lock.lock();
+      m_running--;
+      if (m_tasks.empty() && m_running == 0)
+      {
+        m_idle.notify_all();
+      }
+    }
+  }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+ *  @defgroup concurrency Concurrency
+ */
+
+namespace JC
+{
+  /*!******************************************************************
+  * @class CWorkerPool
+  *
+  * @ingroup concurrency
+  *
+  * @brief Fixed number of threads executing submitted tasks.
+  *
+  * @details Tasks are executed in the order of submission by the next free
+  * thread. Tasks may submit further tasks. The destructor executes all
+  * pending tasks and joins the threads.
+  *
+  * <b>Example:</b>
+  * @code
+  * CWorkerPool pool(4);
+  * pool.Submit([]() { ... });
+  * pool.WaitIdle();
+  * @endcode
+  ********************************************************************/
+  class CWorkerPool
+  {
+  public:
+    /// @param threads number of threads; 0 for one per hardware thread
+    explicit CWorkerPool(std::size_t threads = 0);
+    ~CWorkerPool();
+
+    CWorkerPool(const CWorkerPool&) = delete;
+    CWorkerPool& operator=(const CWorkerPool&) = delete;
+
+    /// @brief Queues a task for execution.
+    void Submit(std::function<void()> task);
+
+    /// @brief Blocks until no task is queued or running.
+    void WaitIdle();
+
+    /// @return number of threads
+    std::size_t GetThreadCount() const { return m_threads.size(); }
+
+  private:
+    void Run();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_idle;
+    /// @brief Number of tasks being executed
+    std::size_t m_running;
+    bool m_stop;
+  };
+}
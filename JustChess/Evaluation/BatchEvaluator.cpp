@@ -0,0 +1,154 @@
+#include <stdafx.h>
+
+#include "BatchEvaluator.h"
+#include "Evaluator.h"
+#include "..\Profiling\Profiler.h"
+
+#ifdef JC_X86
+#include <immintrin.h>
+#endif
+
+namespace JC
+{
+  namespace
+  {
+    constexpr std::size_t BLOCK_SIZE = CBatchEvaluator::BLOCK_SIZE;
+    constexpr std::size_t SQUARES = RANKS * FILES;
+
+    void EvaluateScalar(const uint8_t* squares, std::size_t blocks,
+      const std::array<std::array<int16_t, 16>, SQUARES>& scores, int16_t* out)
+    {
+      for (std::size_t block = 0; block < blocks; block++)
+      {
+        int16_t* blockOut = out + block * BLOCK_SIZE;
+        std::fill(blockOut, blockOut + BLOCK_SIZE, int16_t(0));
+        for (std::size_t square = 0; square < SQUARES; square++)
+        {
+          const uint8_t* codes = squares + (block * SQUARES + square) * BLOCK_SIZE;
+          for (std::size_t ind = 0; ind < BLOCK_SIZE; ind++)
+          {
+            blockOut[ind] = static_cast<int16_t>(blockOut[ind] + scores[square][codes[ind]]);
+          }
+        }
+      }
+    }
+
+#ifdef JC_X86
+    JC_TARGET_SSE4 void EvaluateSse4(const uint8_t* squares, std::size_t blocks,
+      const uint8_t* lowBytes, const uint8_t* highBytes, int16_t* out)
+    {
+      for (std::size_t block = 0; block < blocks; block++)
+      {
+        // two halves of 16 positions
+        for (std::size_t half = 0; half < BLOCK_SIZE; half += 16)
+        {
+          __m128i sum0 = _mm_setzero_si128();
+          __m128i sum1 = _mm_setzero_si128();
+          for (std::size_t square = 0; square < SQUARES; square++)
+          {
+            const __m128i codes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+              squares + (block * SQUARES + square) * BLOCK_SIZE + half));
+            const __m128i low = _mm_shuffle_epi8(
+              _mm_load_si128(reinterpret_cast<const __m128i*>(lowBytes + square * 32)), codes);
+            const __m128i high = _mm_shuffle_epi8(
+              _mm_load_si128(reinterpret_cast<const __m128i*>(highBytes + square * 32)), codes);
+            // interleaving low and high bytes gives the 16 bit scores
+            sum0 = _mm_add_epi16(sum0, _mm_unpacklo_epi8(low, high));
+            sum1 = _mm_add_epi16(sum1, _mm_unpackhi_epi8(low, high));
+          }
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + block * BLOCK_SIZE + half), sum0);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + block * BLOCK_SIZE + half + 8), sum1);
+        }
+      }
+    }
+
+    JC_TARGET_AVX2 void EvaluateAvx2(const uint8_t* squares, std::size_t blocks,
+      const uint8_t* lowBytes, const uint8_t* highBytes, int16_t* out)
+    {
+      for (std::size_t block = 0; block < blocks; block++)
+      {
+        __m256i sum0 = _mm256_setzero_si256();
+        __m256i sum1 = _mm256_setzero_si256();
+        for (std::size_t square = 0; square < SQUARES; square++)
+        {
+          const __m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+            squares + (block * SQUARES + square) * BLOCK_SIZE));
+          const __m256i low = _mm256_shuffle_epi8(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(lowBytes + square * 32)), codes);
+          const __m256i high = _mm256_shuffle_epi8(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(highBytes + square * 32)), codes);
+          // unpacking works per 128 bit lane: sum0 holds positions 0-7 and 16-23, sum1 8-15 and 24-31
+          sum0 = _mm256_add_epi16(sum0, _mm256_unpacklo_epi8(low, high));
+          sum1 = _mm256_add_epi16(sum1, _mm256_unpackhi_epi8(low, high));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + block * BLOCK_SIZE),
+          _mm256_permute2x128_si256(sum0, sum1, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + block * BLOCK_SIZE + 16),
+          _mm256_permute2x128_si256(sum0, sum1, 0x31));
+      }
+    }
+#endif
+  }
+
+  CBatchEvaluator::CBatchEvaluator(eSimdLevel level)
+    : m_level(std::min(level, DetectSimdLevel()))
+    , m_size(0)
+  {
+    for (uint8_t square = 0; square < SQUARES; square++)
+    {
+      for (uint8_t code = 0; code < 16; code++)
+      {
+        const int16_t score = PieceSquareScore(code, square);
+        m_scores[square][code] = score;
+        const uint16_t bits = static_cast<uint16_t>(score);
+        m_lowBytes[square * 32 + code] = m_lowBytes[square * 32 + 16 + code] = static_cast<uint8_t>(bits & 0xFF);
+        m_highBytes[square * 32 + code] = m_highBytes[square * 32 + 16 + code] = static_cast<uint8_t>(bits >> 8);
+      }
+    }
+  }
+
+  void CBatchEvaluator::Clear()
+  {
+    m_size = 0;
+    m_squares.clear();
+  }
+
+  void CBatchEvaluator::Add(const SPosition& position)
+  {
+    const std::size_t block = m_size / BLOCK_SIZE;
+    const std::size_t ind = m_size % BLOCK_SIZE;
+    if (ind == 0)
+    {
+      // empty squares of unused positions in the last block score 0
+      m_squares.resize((block + 1) * SQUARES * BLOCK_SIZE, NO_PIECE);
+    }
+    for (std::size_t square = 0; square < SQUARES; square++)
+    {
+      m_squares[(block * SQUARES + square) * BLOCK_SIZE + ind] =
+        position.m_board[square] & (PIECE_TYPE_MASK | PIECE_WHITE_BIT);
+    }
+    m_size++;
+  }
+
+  void CBatchEvaluator::Evaluate(std::vector<int16_t>& scores) const
+  {
+    JC_PROFILE_ZONE("CBatchEvaluator::Evaluate");
+    const std::size_t blocks = (m_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    scores.resize(blocks * BLOCK_SIZE);
+    switch (m_level)
+    {
+#ifdef JC_X86
+    case eSimdLevel::avx2:
+      EvaluateAvx2(m_squares.data(), blocks, m_lowBytes.data(), m_highBytes.data(), scores.data());
+      break;
+    case eSimdLevel::sse4:
+      EvaluateSse4(m_squares.data(), blocks, m_lowBytes.data(), m_highBytes.data(), scores.data());
+      break;
+#endif
+    default:
+      EvaluateScalar(m_squares.data(), blocks, m_scores, scores.data());
+      break;
+    }
+    scores.resize(m_size);
+  }
+}
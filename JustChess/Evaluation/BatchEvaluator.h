@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Functional/ChessBoard/ChessBoard.h"
+#include "Platform/CpuFeatures.h"
+
+namespace JC
+{
+  /*!******************************************************************
+  * @class CBatchEvaluator
+  *
+  * @ingroup evaluation
+  *
+  * @brief Evaluates many positions at once with SIMD instructions.
+  *
+  * @details The positions are stored as structure of arrays in blocks of
+  * @c BLOCK_SIZE positions: for every square the pieces of all positions of
+  * a block are contiguous bytes. One byte shuffle per square then looks up the
+  * scores of 16 (SSE4) or 32 (AVX2) positions at once in a 16 entry table
+  * holding the low (and a second one holding the high) bytes of the scores
+  * of all piece codes on this square.
+  *
+  * The results are identical to @c EvaluatePosition(). The instruction set
+  * is detected at runtime; the scalar kernel is used if neither AVX2 nor SSE4
+  * is available.
+  *
+  * <b>Example:</b>
+  * @code
+  * CBatchEvaluator evaluator;
+  * for (const auto& position : positions)
+  * {
+  *   evaluator.Add(position); // e.g. from CChessBoard::Snapshot()
+  * }
+  * std::vector<int16_t> scores;
+  * evaluator.Evaluate(scores);
+  * @endcode
+  ********************************************************************/
+  class CBatchEvaluator
+  {
+  public:
+    /// @brief Number of positions evaluated together by the widest kernel
+    static constexpr std::size_t BLOCK_SIZE = 32;
+
+    /// @param level instruction set of the kernel; reduced to the one supported by the CPU
+    explicit CBatchEvaluator(eSimdLevel level = DetectSimdLevel());
+
+    /// @brief Removes all positions.
+    void Clear();
+
+    /// @brief Appends a position to the batch.
+    void Add(const SPosition& position);
+
+    /// @return number of positions in the batch
+    std::size_t Size() const { return m_size; }
+
+    /// @return instruction set of the kernel
+    eSimdLevel GetSimdLevel() const { return m_level; }
+
+    /// @brief Evaluates all positions of the batch.
+    /// @param scores resized to @c Size(); score in centipawns from white's point of view per position
+    void Evaluate(std::vector<int16_t>& scores) const;
+
+  private:
+    eSimdLevel m_level;
+    std::size_t m_size;
+    /// @brief Piece codes (type and color) per block, square and position in the block
+    std::vector<uint8_t> m_squares;
+    /// @brief Score per square and piece code
+    std::array<std::array<int16_t, 16>, RANKS * FILES> m_scores;
+    /// @brief Low and high bytes of @c m_scores, 16 bytes per square repeated for both AVX2 lanes
+    alignas(32) std::array<uint8_t, RANKS * FILES * 32> m_lowBytes;
+    alignas(32) std::array<uint8_t, RANKS * FILES * 32> m_highBytes;
+  };
+}
@@ -0,0 +1,136 @@
+#include <stdafx.h>
+
+#include "Evaluator.h"
+
+namespace JC
+{
+  namespace
+  {
+    using table_t = std::array<int16_t, RANKS * FILES>;
+
+    /// @brief Material value per @c ePiece
+    constexpr std::array<int16_t, 8> s_pieceValues{ 0, 100, 500, 320, 330, 900, 0, 0 };
+
+    // Piece-square tables from white's point of view, written as seen on a
+    // diagram: the first row is rank 8, the last row is rank 1.
+    constexpr table_t s_pawnTable{
+        0,   0,   0,   0,   0,   0,   0,   0,
+       50,  50,  50,  50,  50,  50,  50,  50,
+       10,  10,  20,  30,  30,  20,  10,  10,
+        5,   5,  10,  25,  25,  10,   5,   5,
+        0,   0,   0,  20,  20,   0,   0,   0,
+        5,  -5, -10,   0,   0, -10,  -5,   5,
+        5,  10,  10, -20, -20,  10,  10,   5,
+        0,   0,   0,   0,   0,   0,   0,   0 };
+
+    constexpr table_t s_knightTable{
+      -50, -40, -30, -30, -30, -30, -40, -50,
+      -40, -20,   0,   0,   0,   0, -20, -40,
+      -30,   0,  10,  15,  15,  10,   0, -30,
+      -30,   5,  15,  20,  20,  15,   5, -30,
+      -30,   0,  15,  20,  20,  15,   0, -30,
+      -30,   5,  10,  15,  15,  10,   5, -30,
+      -40, -20,   0,   5,   5,   0, -20, -40,
+      -50, -40, -30, -30, -30, -30, -40, -50 };
+
+    constexpr table_t s_bishopTable{
+      -20, -10, -10, -10, -10, -10, -10, -20,
+      -10,   0,   0,   0,   0,   0,   0, -10,
+      -10,   0,   5,  10,  10,   5,   0, -10,
+      -10,   5,   5,  10,  10,   5,   5, -10,
+      -10,   0,  10,  10,  10,  10,   0, -10,
+      -10,  10,  10,  10,  10,  10,  10, -10,
+      -10,   5,   0,   0,   0,   0,   5, -10,
+      -20, -10, -10, -10, -10, -10, -10, -20 };
+
+    constexpr table_t s_rookTable{
+        0,   0,   0,   0,   0,   0,   0,   0,
+        5,  10,  10,  10,  10,  10,  10,   5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+       -5,   0,   0,   0,   0,   0,   0,  -5,
+        0,   0,   0,   5,   5,   0,   0,   0 };
+
+    constexpr table_t s_queenTable{
+      -20, -10, -10,  -5,  -5, -10, -10, -20,
+      -10,   0,   0,   0,   0,   0,   0, -10,
+      -10,   0,   5,   5,   5,   5,   0, -10,
+       -5,   0,   5,   5,   5,   5,   0,  -5,
+        0,   0,   5,   5,   5,   5,   0,  -5,
+      -10,   5,   5,   5,   5,   5,   0, -10,
+      -10,   0,   5,   0,   0,   0,   0, -10,
+      -20, -10, -10,  -5,  -5, -10, -10, -20 };
+
+    constexpr table_t s_kingTable{
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -20, -30, -30, -40, -40, -30, -30, -20,
+      -10, -20, -20, -20, -20, -20, -20, -10,
+       20,  20,   0,   0,   0,   0,  20,  20,
+       20,  30,  10,   0,   0,  10,  30,  20 };
+
+    const table_t& PieceTable(ePiece type)
+    {
+      switch (type)
+      {
+      case ePiece::pawn:   return s_pawnTable;
+      case ePiece::knight: return s_knightTable;
+      case ePiece::bishop: return s_bishopTable;
+      case ePiece::rook:   return s_rookTable;
+      case ePiece::queen:  return s_queenTable;
+      default:             return s_kingTable;
+      }
+    }
+
+    /// @brief Scores of all pieces (type and color, index @c piece & 0x0F) on all squares
+    using scores_t = std::array<table_t, 16>;
+
+    const scores_t& GetScores()
+    {
+      static const scores_t s_scores = []()
+      {
+        scores_t scores{};
+        for (uint8_t code = 0; code < scores.size(); code++)
+        {
+          const ePiece type = PieceType(code);
+          if (type == ePiece::none || type > ePiece::king)
+          {
+            continue;
+          }
+          const bool isWhite = PieceIsWhite(code);
+          for (uint8_t square = 0; square < RANKS * FILES; square++)
+          {
+            // white looks at the table from rank 1, black from rank 8 (mirrored)
+            const int rank = square / FILES;
+            const int row = isWhite ? (RANKS - 1 - rank) : rank;
+            const int16_t score = static_cast<int16_t>(
+              s_pieceValues[_UINT8(type)] + PieceTable(type)[row * FILES + square % FILES]);
+            scores[code][square] = isWhite ? score : static_cast<int16_t>(-score);
+          }
+        }
+        return scores;
+      }();
+      return s_scores;
+    }
+  }
+
+  int16_t PieceSquareScore(packedpiece_t piece, uint8_t square)
+  {
+    return GetScores()[piece & (PIECE_TYPE_MASK | PIECE_WHITE_BIT)][square];
+  }
+
+  int EvaluatePosition(const SPosition& position)
+  {
+    const scores_t& scores = GetScores();
+    int score = 0;
+    for (uint8_t square = 0; square < RANKS * FILES; square++)
+    {
+      score += scores[position.m_board[square] & (PIECE_TYPE_MASK | PIECE_WHITE_BIT)][square];
+    }
+    return score;
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Functional/ChessBoard/ChessBoard.h"
+
+/**
+ *  @defgroup evaluation Evaluation
+ */
+
+namespace JC
+{
+  /// @brief Score of a chess piece on a square in centipawns (material plus piece-square bonus).
+  /// Positive for white pieces, negative for black pieces, 0 for an empty square.
+  /// @param piece packed chess piece (the moved flag is ignored)
+  /// @param square @c SquareIndex(rank, file)
+  int16_t PieceSquareScore(packedpiece_t piece, uint8_t square);
+
+  /// @brief Static evaluation of a position: sum of @c PieceSquareScore() over all squares.
+  /// @return score in centipawns from white's point of view
+  int EvaluatePosition(const SPosition& position);
+
+  /// @brief Interface of static evaluations, so evaluations can be exchanged (e.g. @c CNnue)
+  class IEvaluator
+  {
+  public:
+    virtual ~IEvaluator() = default;
+
+    /// @return score of the position in centipawns from white's point of view
+    virtual int Evaluate(const SPosition& position) const = 0;
+  };
+
+  /// @brief Material and piece-square tables, see @c EvaluatePosition()
+  class CMaterialEvaluator : public IEvaluator
+  {
+  public:
+    int Evaluate(const SPosition& position) const override
+    {
+      return EvaluatePosition(position);
+    }
+  };
+}
@@ -0,0 +1,320 @@
+#include <stdafx.h>
+
+#include "Nnue.h"
+#include "..\Profiling\Profiler.h"
+
+#ifdef JC_X86
+#include <immintrin.h>
+#endif
+
+namespace JC
+{
+  namespace
+  {
+    constexpr std::size_t HIDDEN = CNnue::HIDDEN;
+    constexpr std::size_t L1 = CNnue::L1;
+    constexpr std::size_t L1_INPUTS = 2 * HIDDEN;
+    /// @brief L1 sums are divided by 2^L1_SHIFT before the clipped ReLU
+    constexpr int L1_SHIFT = 6;
+    /// @brief Output divided by this gives centipawns
+    constexpr int OUTPUT_SCALE = 16;
+    /// @brief More changed squares than after castling: refresh instead of update
+    constexpr std::size_t MAX_UPDATED_SQUARES = 4;
+    constexpr char MAGIC[4] = { 'J', 'C', 'N', 'N' };
+
+    void AddColumnScalar(int16_t* values, const int16_t* column, int sign)
+    {
+      for (std::size_t ind = 0; ind < HIDDEN; ind++)
+      {
+        values[ind] = static_cast<int16_t>(values[ind] + sign * column[ind]);
+      }
+    }
+
+    void ClipScalar(const int16_t* values, uint8_t* out)
+    {
+      for (std::size_t ind = 0; ind < HIDDEN; ind++)
+      {
+        out[ind] = static_cast<uint8_t>(std::clamp<int>(values[ind], 0, 127));
+      }
+    }
+
+    /// @brief L1 sums of all neurons: biases plus weights (one row per neuron) times inputs
+    void AffineScalar(const uint8_t* inputs, const int8_t* weights, const int32_t* biases, int32_t* sums)
+    {
+      for (std::size_t neuron = 0; neuron < L1; neuron++)
+      {
+        int32_t sum = biases[neuron];
+        for (std::size_t ind = 0; ind < L1_INPUTS; ind++)
+        {
+          sum += inputs[ind] * weights[neuron * L1_INPUTS + ind];
+        }
+        sums[neuron] = sum;
+      }
+    }
+
+#ifdef JC_X86
+    JC_TARGET_AVX2 void AddColumnAvx2(int16_t* values, const int16_t* column, int sign)
+    {
+      for (std::size_t ind = 0; ind < HIDDEN; ind += 16)
+      {
+        __m256i* target = reinterpret_cast<__m256i*>(values + ind);
+        const __m256i weights = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + ind));
+        _mm256_store_si256(target, sign > 0 ?
+          _mm256_add_epi16(_mm256_load_si256(target), weights) :
+          _mm256_sub_epi16(_mm256_load_si256(target), weights));
+      }
+    }
+
+    JC_TARGET_AVX2 void ClipAvx2(const int16_t* values, uint8_t* out)
+    {
+      const __m256i max = _mm256_set1_epi8(127);
+      for (std::size_t ind = 0; ind < HIDDEN; ind += 32)
+      {
+        const __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + ind));
+        const __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + ind + 16));
+        // packing saturates to 0..255 and works per 128 bit lane, the permutation restores the order
+        const __m256i packed = _mm256_min_epu8(_mm256_packus_epi16(low, high), max);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(out + ind), _mm256_permute4x64_epi64(packed, 0xD8));
+      }
+    }
+
+    JC_TARGET_AVX2 void AffineAvx2(const uint8_t* inputs, const int8_t* weights, const int32_t* biases, int32_t* sums)
+    {
+      const __m256i ones = _mm256_set1_epi16(1);
+      // four neurons at once, so each input chunk is loaded once per four rows
+      for (std::size_t neuron = 0; neuron < L1; neuron += 4)
+      {
+        __m256i sum[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(),
+                           _mm256_setzero_si256(), _mm256_setzero_si256() };
+        for (std::size_t ind = 0; ind < L1_INPUTS; ind += 32)
+        {
+          const __m256i in = _mm256_load_si256(reinterpret_cast<const __m256i*>(inputs + ind));
+          for (std::size_t row = 0; row < 4; row++)
+          {
+            const __m256i w = _mm256_loadu_si256(
+              reinterpret_cast<const __m256i*>(weights + (neuron + row) * L1_INPUTS + ind));
+            // inputs <= 127, so the pairwise 16 bit sums can't saturate
+            sum[row] = _mm256_add_epi32(sum[row], _mm256_madd_epi16(_mm256_maddubs_epi16(in, w), ones));
+          }
+        }
+        // horizontal sums of the four rows
+        const __m256i pairs = _mm256_hadd_epi32(_mm256_hadd_epi32(sum[0], sum[1]), _mm256_hadd_epi32(sum[2], sum[3]));
+        const __m128i total = _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + neuron),
+          _mm_add_epi32(total, _mm_loadu_si128(reinterpret_cast<const __m128i*>(biases + neuron))));
+      }
+    }
+#endif
+
+    template<typename T>
+    bool ReadArray(std::istream& in, T* data, std::size_t count)
+    {
+      return static_cast<bool>(in.read(reinterpret_cast<char*>(data), count * sizeof(T)));
+    }
+
+    template<typename T>
+    void WriteArray(std::ostream& out, const T* data, std::size_t count)
+    {
+      out.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+    }
+  }
+
+  CNnue::CNnue(eSimdLevel level)
+    : m_level(std::min(level, DetectSimdLevel()) == eSimdLevel::avx2 ? eSimdLevel::avx2 : eSimdLevel::scalar)
+    , m_featureWeights(FEATURES * HIDDEN, 0)
+    , m_featureBiases()
+    , m_l1Weights(L1 * L1_INPUTS, 0)
+    , m_l1Biases()
+    , m_outputWeights()
+    , m_outputBias(0)
+  {
+  }
+
+  bool CNnue::LoadWeights(const std::string& path)
+  {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    uint32_t header[4];
+    if (!in || !ReadArray(in, magic, 4) || !ReadArray(in, header, 4) ||
+        std::memcmp(magic, MAGIC, 4) != 0 || header[0] != VERSION ||
+        header[1] != FEATURES || header[2] != HIDDEN || header[3] != L1)
+    {
+      return false;
+    }
+    // read into a temporary network, so a failed read leaves this one unchanged
+    CNnue loaded(m_level);
+    if (!ReadArray(in, loaded.m_featureWeights.data(), loaded.m_featureWeights.size()) ||
+        !ReadArray(in, loaded.m_featureBiases.data(), loaded.m_featureBiases.size()) ||
+        !ReadArray(in, loaded.m_l1Weights.data(), loaded.m_l1Weights.size()) ||
+        !ReadArray(in, loaded.m_l1Biases.data(), loaded.m_l1Biases.size()) ||
+        !ReadArray(in, loaded.m_outputWeights.data(), loaded.m_outputWeights.size()) ||
+        !ReadArray(in, &loaded.m_outputBias, 1))
+    {
+      return false;
+    }
+    *this = std::move(loaded);
+    return true;
+  }
+
+  bool CNnue::SaveWeights(const std::string& path) const
+  {
+    std::ofstream out(path, std::ios::binary);
+    const uint32_t header[4] = { VERSION, FEATURES, HIDDEN, L1 };
+    WriteArray(out, MAGIC, 4);
+    WriteArray(out, header, 4);
+    WriteArray(out, m_featureWeights.data(), m_featureWeights.size());
+    WriteArray(out, m_featureBiases.data(), m_featureBiases.size());
+    WriteArray(out, m_l1Weights.data(), m_l1Weights.size());
+    WriteArray(out, m_l1Biases.data(), m_l1Biases.size());
+    WriteArray(out, m_outputWeights.data(), m_outputWeights.size());
+    WriteArray(out, &m_outputBias, 1);
+    return static_cast<bool>(out);
+  }
+
+  void CNnue::InitRandom(uint32_t seed)
+  {
+    std::mt19937 random(seed);
+    auto uniform = [&random](int min, int max)
+    {
+      return std::uniform_int_distribution<int>(min, max)(random);
+    };
+    for (auto& weight : m_featureWeights)
+    {
+      weight = static_cast<int16_t>(uniform(-32, 32));
+    }
+    for (auto& bias : m_featureBiases)
+    {
+      bias = static_cast<int16_t>(uniform(0, 64));
+    }
+    for (auto& weight : m_l1Weights)
+    {
+      weight = static_cast<int8_t>(uniform(-16, 16));
+    }
+    for (auto& bias : m_l1Biases)
+    {
+      bias = uniform(-256, 256);
+    }
+    for (auto& weight : m_outputWeights)
+    {
+      weight = static_cast<int8_t>(uniform(-64, 64));
+    }
+    m_outputBias = 0;
+  }
+
+  std::size_t CNnue::FeatureIndex(packedpiece_t piece, uint8_t square, bool whitePerspective)
+  {
+    // own pieces first; black sees the board mirrored (rank 8 becomes rank 1)
+    const std::size_t relativeColor = PieceIsWhite(piece) == whitePerspective ? 0 : 1;
+    const std::size_t relativeSquare = whitePerspective ? square : (square ^ 56);
+    return (relativeColor * 6 + _UINT8(PieceType(piece)) - 1) * RANKS * FILES + relativeSquare;
+  }
+
+  void CNnue::ApplyFeature(packedpiece_t piece, uint8_t square, int sign, SAccumulator& accumulator) const
+  {
+    for (std::size_t perspective = 0; perspective < 2; perspective++)
+    {
+      const int16_t* column = &m_featureWeights[FeatureIndex(piece, square, perspective == 0) * HIDDEN];
+#ifdef JC_X86
+      if (m_level == eSimdLevel::avx2)
+      {
+        AddColumnAvx2(accumulator.m_values[perspective].data(), column, sign);
+        continue;
+      }
+#endif
+      AddColumnScalar(accumulator.m_values[perspective].data(), column, sign);
+    }
+  }
+
+  void CNnue::Refresh(const CChessBoard::board_t& board, SAccumulator& accumulator) const
+  {
+    JC_PROFILE_ZONE("CNnue::Refresh");
+    accumulator.m_values[0] = m_featureBiases;
+    accumulator.m_values[1] = m_featureBiases;
+    for (uint8_t square = 0; square < RANKS * FILES; square++)
+    {
+      if (board[square] != NO_PIECE)
+      {
+        ApplyFeature(board[square], square, 1, accumulator);
+      }
+    }
+  }
+
+  void CNnue::Update(const CChessBoard::board_t& before, const CChessBoard::board_t& after,
+    SAccumulator& accumulator) const
+  {
+    JC_PROFILE_ZONE("CNnue::Update");
+    // compare eight squares at once; only type and color are features,
+    // a changed moved flag does not matter
+    constexpr uint64_t FEATURE_MASK = 0x0101010101010101ull * (PIECE_TYPE_MASK | PIECE_WHITE_BIT);
+    std::array<uint8_t, RANKS * FILES> changed;
+    std::size_t changedCount = 0;
+    for (uint8_t rank = 0; rank < RANKS; rank++)
+    {
+      uint64_t beforeRank;
+      uint64_t afterRank;
+      std::memcpy(&beforeRank, before.data() + rank * FILES, sizeof(beforeRank));
+      std::memcpy(&afterRank, after.data() + rank * FILES, sizeof(afterRank));
+      const uint64_t diff = (beforeRank ^ afterRank) & FEATURE_MASK;
+      for (uint8_t file = 0; diff != 0 && file < FILES; file++)
+      {
+        if ((diff >> (8 * file)) & 0xFF)
+        {
+          changed[changedCount++] = SquareIndex(rank, file);
+        }
+      }
+    }
+    if (changedCount > MAX_UPDATED_SQUARES)
+    {
+      Refresh(after, accumulator);
+      return;
+    }
+    for (std::size_t ind = 0; ind < changedCount; ind++)
+    {
+      const uint8_t square = changed[ind];
+      if (before[square] != NO_PIECE)
+      {
+        ApplyFeature(before[square], square, -1, accumulator);
+      }
+      if (after[square] != NO_PIECE)
+      {
+        ApplyFeature(after[square], square, 1, accumulator);
+      }
+    }
+  }
+
+  int CNnue::Evaluate(const SAccumulator& accumulator, bool whiteToMove) const
+  {
+    // clipped accumulators of the side to move first
+    alignas(32) std::array<uint8_t, L1_INPUTS> inputs;
+    const std::size_t own = whiteToMove ? 0 : 1;
+    std::array<int32_t, L1> sums;
+#ifdef JC_X86
+    if (m_level == eSimdLevel::avx2)
+    {
+      ClipAvx2(accumulator.m_values[own].data(), inputs.data());
+      ClipAvx2(accumulator.m_values[1 - own].data(), inputs.data() + HIDDEN);
+      AffineAvx2(inputs.data(), m_l1Weights.data(), m_l1Biases.data(), sums.data());
+    }
+    else
+#endif
+    {
+      ClipScalar(accumulator.m_values[own].data(), inputs.data());
+      ClipScalar(accumulator.m_values[1 - own].data(), inputs.data() + HIDDEN);
+      AffineScalar(inputs.data(), m_l1Weights.data(), m_l1Biases.data(), sums.data());
+    }
+
+    int32_t output = m_outputBias;
+    for (std::size_t neuron = 0; neuron < L1; neuron++)
+    {
+      output += m_outputWeights[neuron] * std::clamp(sums[neuron] / (1 << L1_SHIFT), 0, 127);
+    }
+    return (whiteToMove ? output : -output) / OUTPUT_SCALE;
+  }
+
+  int CNnue::Evaluate(const SPosition& position) const
+  {
+    SAccumulator accumulator;
+    Refresh(position.m_board, accumulator);
+    return Evaluate(accumulator, position.m_whiteToMove);
+  }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Evaluator.h"
+#include "..\Platform\CpuFeatures.h"
+
+namespace JC
+{
+  /*!******************************************************************
+  * @class CNnue
+  *
+  * @ingroup evaluation
+  *
+  * @brief Efficiently updatable neural network evaluation.
+  *
+  * @details Network: 768 inputs (piece type and color relative to a
+  * perspective times 64 squares) -> @c HIDDEN int16 accumulators per
+  * perspective -> clipped ReLU (0..127) of both accumulators, side to move
+  * first -> @c L1 int8 neurons -> clipped ReLU -> one output.
+  *
+  * The accumulators are the sums of the first layer columns of all pieces on
+  * the board. After a move only the columns of the changed squares are
+  * subtracted and added (@c Update()), which is much cheaper than summing the
+  * columns of all pieces again (@c Refresh()). The integer layers use AVX2 if
+  * available (same results as the scalar code).
+  *
+  * Weights file (little endian): "JCNN", version, input count, @c HIDDEN, @c L1
+  * (each uint32), feature weights int16[768][HIDDEN], feature biases int16[HIDDEN],
+  * L1 weights int8[L1][2 * HIDDEN], L1 biases int32[L1], output weights int8[L1],
+  * output bias int32.
+  *
+  * <b>Example:</b>
+  * @code
+  * CNnue nnue;
+  * if (!nnue.LoadWeights("net.jcnn")) { ... }
+  * CNnue::SAccumulator accumulator;
+  * nnue.Refresh(board.GetBoard(), accumulator);
+  * const auto before = board.GetBoard();
+  * board.Move(...);
+  * nnue.Update(before, board.GetBoard(), accumulator);
+  * int score = nnue.Evaluate(accumulator, board.IsWhiteToMove());
+  * @endcode
+  ********************************************************************/
+  class CNnue : public IEvaluator
+  {
+  public:
+    static constexpr std::size_t FEATURES = 2 * 6 * RANKS * FILES;
+    static constexpr std::size_t HIDDEN = 128;
+    static constexpr std::size_t L1 = 32;
+    static constexpr uint32_t VERSION = 1;
+
+    /// @brief First layer outputs of white's (index 0) and black's (index 1) perspective
+    struct SAccumulator
+    {
+      alignas(32) std::array<std::array<int16_t, HIDDEN>, 2> m_values;
+    };
+
+    /// @param level instruction set of the kernels; reduced to the one supported by the CPU
+    explicit CNnue(eSimdLevel level = DetectSimdLevel());
+
+    /// @brief Loads the weights (see file format above).
+    /// @return @c false if the file can't be read or doesn't match the network; the weights are unchanged then
+    bool LoadWeights(const std::string& path);
+
+    /// @return @c false if the file can't be written
+    bool SaveWeights(const std::string& path) const;
+
+    /// @brief Small random weights, e.g. to measure the speed without a trained network
+    void InitRandom(uint32_t seed);
+
+    /// @brief Computes the accumulators from all pieces of the board.
+    void Refresh(const CChessBoard::board_t& board, SAccumulator& accumulator) const;
+
+    /// @brief Updates the accumulators with the squares which differ between two boards
+    /// (usually before and after one move). Refreshes if too many squares changed.
+    void Update(const CChessBoard::board_t& before, const CChessBoard::board_t& after,
+      SAccumulator& accumulator) const;
+
+    /// @brief Output of the network for given accumulators.
+    /// @return score in centipawns from white's point of view
+    int Evaluate(const SAccumulator& accumulator, bool whiteToMove) const;
+
+    /// @brief Refreshes the accumulators and evaluates the position.
+    int Evaluate(const SPosition& position) const override;
+
+    /// @return instruction set of the kernels
+    eSimdLevel GetSimdLevel() const { return m_level; }
+
+  private:
+    /// @brief Index of the first layer column of a piece on a square for a perspective
+    static std::size_t FeatureIndex(packedpiece_t piece, uint8_t square, bool whitePerspective);
+    /// @brief Adds (@p sign 1) or subtracts (@p sign -1) the columns of a piece on a square
+    void ApplyFeature(packedpiece_t piece, uint8_t square, int sign, SAccumulator& accumulator) const;
+
+    eSimdLevel m_level;
+    std::vector<int16_t> m_featureWeights;
+    std::array<int16_t, HIDDEN> m_featureBiases;
+    std::vector<int8_t> m_l1Weights;
+    std::array<int32_t, L1> m_l1Biases;
+    std::array<int8_t, L1> m_outputWeights;
+    int32_t m_outputBias;
+  };
+}
@@ -0,0 +1,208 @@
+#include <stdafx.h>
+
+#include "PawnStructure.h"
+#include "..\Profiling\Profiler.h"
+
+namespace JC
+{
+  namespace
+  {
+    constexpr bitboard_t FILE_A = 0x0101010101010101ull;
+
+    constexpr int16_t DOUBLED_PENALTY = 12;
+    constexpr int16_t ISOLATED_PENALTY = 12;
+    constexpr int16_t BACKWARD_PENALTY = 8;
+    /// @brief Bonus of a passed pawn per rank from its own side (the first and last rank can't occur)
+    constexpr std::array<int16_t, RANKS> s_passedBonus{ 0, 5, 10, 20, 35, 60, 100, 0 };
+    /// @brief Bonus of a shield pawn one and two ranks in front of the king
+    constexpr int16_t SHIELD_NEAR_BONUS = 12;
+    constexpr int16_t SHIELD_FAR_BONUS = 6;
+
+    int BitCount(bitboard_t bits)
+    {
+      int count = 0;
+      for (; bits; bits &= bits - 1)
+      {
+        count++;
+      }
+      return count;
+    }
+
+    constexpr bitboard_t FileMask(int file)
+    {
+      return FILE_A << file;
+    }
+
+    /// @return squares on the files next to @p file
+    constexpr bitboard_t AdjacentFiles(int file)
+    {
+      return (file > 0 ? FileMask(file - 1) : 0) | (file < FILES - 1 ? FileMask(file + 1) : 0);
+    }
+
+    /// @return squares on the ranks in front of @p rank from the point of view of a color
+    constexpr bitboard_t RanksInFront(int rank, bool white)
+    {
+      if (white)
+      {
+        return rank < RANKS - 1 ? ~bitboard_t(0) << (8 * (rank + 1)) : 0;
+      }
+      return rank > 0 ? ~bitboard_t(0) >> (8 * (RANKS - rank)) : 0;
+    }
+
+    /// @brief Pawn terms of one color (positive is good for this color)
+    int EvaluatePawnsOfColor(bitboard_t own, bitboard_t opponent, bool white)
+    {
+      int score = 0;
+      const bitboard_t opponentAttacks = PawnAttacks(opponent, !white);
+      for (int file = 0; file < FILES; file++)
+      {
+        const int count = BitCount(own & FileMask(file));
+        if (count > 1)
+        {
+          score -= DOUBLED_PENALTY * (count - 1);
+        }
+      }
+      for (bitboard_t pawns = own; pawns; pawns &= pawns - 1)
+      {
+        const bitboard_t pawn = pawns & (~pawns + 1);
+        const int square = BitCount(pawn - 1);
+        const int rank = square / FILES;
+        const int file = square % FILES;
+        const bitboard_t neighbours = own & AdjacentFiles(file);
+        if (!neighbours)
+        {
+          score -= ISOLATED_PENALTY;
+        }
+        // no neighbour on the same rank or behind can defend it, and its stop square is attacked
+        else if (!(neighbours & ~RanksInFront(rank, white)) &&
+                 (opponentAttacks & (white ? pawn << 8 : pawn >> 8)))
+        {
+          score -= BACKWARD_PENALTY;
+        }
+        if (!(opponent & (FileMask(file) | AdjacentFiles(file)) & RanksInFront(rank, white)))
+        {
+          score += s_passedBonus[white ? rank : RANKS - 1 - rank];
+        }
+      }
+      return score;
+    }
+  }
+
+  int16_t EvaluatePawns(bitboard_t whitePawns, bitboard_t blackPawns)
+  {
+    return static_cast<int16_t>(EvaluatePawnsOfColor(whitePawns, blackPawns, true) -
+                                EvaluatePawnsOfColor(blackPawns, whitePawns, false));
+  }
+
+  int16_t EvaluatePawnShield(bitboard_t ownPawns, uint8_t kingSquare, bool white)
+  {
+    const int rank = kingSquare / FILES;
+    const int file = kingSquare % FILES;
+    if ((white && rank > 1) || (!white && rank < RANKS - 2))
+    {
+      return 0; // the king left its home ranks
+    }
+    const int direction = white ? 1 : -1;
+    int16_t bonus = 0;
+    for (int shieldFile = std::max(file - 1, 0); shieldFile <= std::min(file + 1, FILES - 1); shieldFile++)
+    {
+      if (ownPawns & SquareBit(rank + direction, shieldFile))
+      {
+        bonus += SHIELD_NEAR_BONUS;
+      }
+      else if (ownPawns & SquareBit(rank + 2 * direction, shieldFile))
+      {
+        bonus += SHIELD_FAR_BONUS;
+      }
+    }
+    return bonus;
+  }
+
+  int EvaluatePawnStructure(const SPosition& position)
+  {
+    bitboard_t pawns[2] = { 0, 0 };
+    for (uint8_t square = 0; square < RANKS * FILES; square++)
+    {
+      if (PieceType(position.m_board[square]) == ePiece::pawn)
+      {
+        pawns[PieceIsWhite(position.m_board[square]) ? 0 : 1] |= bitboard_t(1) << square;
+      }
+    }
+    return EvaluatePawns(pawns[0], pawns[1]) +
+           EvaluatePawnShield(pawns[0], position.m_whiteKingSquare, true) -
+           EvaluatePawnShield(pawns[1], position.m_blackKingSquare, false);
+  }
+
+  CPawnHashTable::CPawnHashTable(std::size_t entries)
+  {
+    std::size_t size = 1;
+    while (size < entries)
+    {
+      size <<= 1;
+    }
+    m_entries.resize(size);
+  }
+
+  int CPawnHashTable::Evaluate(const SPosition& position)
+  {
+    JC_PROFILE_COUNT("CPawnHashTable: probes", 1);
+    m_statistics.m_probes++;
+    SEntry& entry = m_entries[position.m_pawnKey & (m_entries.size() - 1)];
+    const std::array<uint8_t, 2> kingSquares{ position.m_whiteKingSquare, position.m_blackKingSquare };
+    const bool hit = entry.m_used && entry.m_key == position.m_pawnKey;
+    if (hit && entry.m_kingSquares == kingSquares)
+    {
+      JC_PROFILE_COUNT("CPawnHashTable: hits", 1);
+      m_statistics.m_hits++;
+      m_statistics.m_shieldHits++;
+      return entry.m_pawns + entry.m_shields[0] - entry.m_shields[1];
+    }
+
+    bitboard_t pawns[2] = { 0, 0 };
+    for (uint8_t square = 0; square < RANKS * FILES; square++)
+    {
+      if (PieceType(position.m_board[square]) == ePiece::pawn)
+      {
+        pawns[PieceIsWhite(position.m_board[square]) ? 0 : 1] |= bitboard_t(1) << square;
+      }
+    }
+    if (hit)
+    {
+      JC_PROFILE_COUNT("CPawnHashTable: hits", 1);
+      m_statistics.m_hits++;
+    }
+    else
+    {
+      entry.m_key = position.m_pawnKey;
+      entry.m_pawns = EvaluatePawns(pawns[0], pawns[1]);
+      entry.m_used = true;
+    }
+    // only the shields of the kings which moved have to be computed again
+    for (std::size_t color = 0; color < 2; color++)
+    {
+      if (!hit || entry.m_kingSquares[color] != kingSquares[color])
+      {
+        entry.m_kingSquares[color] = kingSquares[color];
+        entry.m_shields[color] = EvaluatePawnShield(pawns[color], kingSquares[color], color == 0);
+      }
+    }
+    return entry.m_pawns + entry.m_shields[0] - entry.m_shields[1];
+  }
+
+  void CPawnHashTable::Clear()
+  {
+    std::fill(m_entries.begin(), m_entries.end(), SEntry());
+    m_statistics = SPawnHashStatistics();
+  }
+
+  CPawnHashTable& CPawnHashTable::ForThisThread()
+  {
+    thread_local CPawnHashTable s_table;
+    return s_table;
+  }
+
+  int CPawnStructureEvaluator::Evaluate(const SPosition& position) const
+  {
+    return EvaluatePosition(position) + CPawnHashTable::ForThisThread().Evaluate(position);
+  }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Evaluator.h"
+
+namespace JC
+{
+  /// @brief Pawn structure terms of both colors in centipawns from white's point of view:
+  /// doubled, isolated, backward and passed pawns.
+  /// @param whitePawns squares of the white pawns
+  /// @param blackPawns squares of the black pawns
+  int16_t EvaluatePawns(bitboard_t whitePawns, bitboard_t blackPawns);
+
+  /// @brief Bonus for own pawns in front of a king on its first two ranks.
+  /// @param ownPawns squares of the pawns of the king's color
+  /// @param kingSquare @c SquareIndex(rank, file) of the king
+  /// @param white color of the king
+  /// @return bonus in centipawns (not negative, from the king's point of view)
+  int16_t EvaluatePawnShield(bitboard_t ownPawns, uint8_t kingSquare, bool white);
+
+  /// @brief @c EvaluatePawns() plus the pawn shields of both kings, computed without cache.
+  /// @return score in centipawns from white's point of view
+  int EvaluatePawnStructure(const SPosition& position);
+
+  /// @brief Counters of a @c CPawnHashTable
+  struct SPawnHashStatistics
+  {
+    uint64_t m_probes = 0;
+    /// @brief Probes which found the pawn structure of the position
+    uint64_t m_hits = 0;
+    /// @brief Hits which also found the pawn shields of both king squares
+    uint64_t m_shieldHits = 0;
+
+    /// @return fraction of probes which were hits, 0 without probes
+    double HitRate() const
+    {
+      return m_probes ? static_cast<double>(m_hits) / static_cast<double>(m_probes) : 0.0;
+    }
+  };
+
+  /*!******************************************************************
+  * @class CPawnHashTable
+  *
+  * @ingroup evaluation
+  *
+  * @brief Cache of pawn structure evaluations, indexed by the pawn hash key.
+  *
+  * @details Pawn structures change only on pawn moves and pawn captures, so
+  * most positions of a game or a search share the pawn structure of an earlier
+  * position. The table stores @c EvaluatePawns() per pawn hash key
+  * (@c SPosition::m_pawnKey) and the pawn shields for the last king squares
+  * seen with this structure; only these are recomputed if the kings moved.
+  *
+  * A table is not thread-safe; every thread uses its own (@c ForThisThread()).
+  * The counters are available per table and, if profiling is compiled in, as
+  * the profiler counters "CPawnHashTable: probes" and "CPawnHashTable: hits".
+  *
+  * <b>Example:</b>
+  * @code
+  * CPawnHashTable& table = CPawnHashTable::ForThisThread();
+  * int score = EvaluatePosition(position) + table.Evaluate(position);
+  * double hitRate = table.GetStatistics().HitRate();
+  * @endcode
+  ********************************************************************/
+  class CPawnHashTable
+  {
+  public:
+    static constexpr std::size_t DEFAULT_ENTRIES = std::size_t(1) << 14;
+
+    /// @param entries number of entries, rounded up to a power of two
+    explicit CPawnHashTable(std::size_t entries = DEFAULT_ENTRIES);
+
+    /// @brief Same result as @c EvaluatePawnStructure(), from the table if possible.
+    /// @param position position with the pawn hash key of its board, e.g. from @c CChessBoard::Snapshot()
+    int Evaluate(const SPosition& position);
+
+    /// @brief Removes all entries and resets the counters.
+    void Clear();
+
+    const SPawnHashStatistics& GetStatistics() const { return m_statistics; }
+
+    /// @return table of the calling thread (created on first use)
+    static CPawnHashTable& ForThisThread();
+
+  private:
+    struct SEntry
+    {
+      uint64_t m_key = 0;
+      int16_t m_pawns = 0;
+      /// @brief Pawn shield of white (index 0) and black (index 1) for @c m_kingSquares
+      std::array<int16_t, 2> m_shields{};
+      std::array<uint8_t, 2> m_kingSquares{ NO_SQUARE, NO_SQUARE };
+      bool m_used = false;
+    };
+
+    std::vector<SEntry> m_entries;
+    SPawnHashStatistics m_statistics;
+  };
+
+  /// @brief Material, piece-square tables (@c EvaluatePosition()) and pawn structure
+  /// from the pawn hash table of the calling thread
+  class CPawnStructureEvaluator : public IEvaluator
+  {
+  public:
+    int Evaluate(const SPosition& position) const override;
+  };
+}
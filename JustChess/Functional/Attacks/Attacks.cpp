@@ -0,0 +1,141 @@
+#include <stdafx.h>
+
+#include "Attacks.h"
+
+#ifdef JC_X86
+#include <immintrin.h>
+#endif
+
+namespace JC
+{
+  namespace
+  {
+    constexpr bitboard_t NOT_FILE_A = 0xFEFEFEFEFEFEFEFEull;
+    constexpr bitboard_t NOT_FILE_H = 0x7F7F7F7F7F7F7F7Full;
+    constexpr bitboard_t NOT_FILE_AB = 0xFCFCFCFCFCFCFCFCull;
+    constexpr bitboard_t NOT_FILE_GH = 0x3F3F3F3F3F3F3F3Full;
+
+    /// @brief Ray attacks of the generators in the direction of a left shift (north, east, north-east, north-west).
+    /// @param shift 8 (north), 1 (east), 9 (north-east) or 7 (north-west)
+    /// @param wrapMask squares which can't be reached without wrapping around the board
+    bitboard_t FillLeft(bitboard_t gen, bitboard_t empty, int shift, bitboard_t wrapMask)
+    {
+      bitboard_t pro = empty & wrapMask;
+      gen |= pro & (gen << shift);
+      pro &= pro << shift;
+      gen |= pro & (gen << (2 * shift));
+      pro &= pro << (2 * shift);
+      gen |= pro & (gen << (4 * shift));
+      return (gen << shift) & wrapMask;
+    }
+
+    /// @brief Ray attacks in the direction of a right shift (south, west, south-west, south-east).
+    bitboard_t FillRight(bitboard_t gen, bitboard_t empty, int shift, bitboard_t wrapMask)
+    {
+      bitboard_t pro = empty & wrapMask;
+      gen |= pro & (gen >> shift);
+      pro &= pro >> shift;
+      gen |= pro & (gen >> (2 * shift));
+      pro &= pro >> (2 * shift);
+      gen |= pro & (gen >> (4 * shift));
+      return (gen >> shift) & wrapMask;
+    }
+
+    using sliderAttacks_t = bitboard_t(*)(bitboard_t, bitboard_t, bitboard_t);
+
+    sliderAttacks_t SelectSliderAttacks()
+    {
+#ifdef JC_X86
+      if (DetectSimdLevel() >= eSimdLevel::avx2)
+      {
+        return &SliderAttacksAvx2;
+      }
+#endif
+      return &SliderAttacksScalar;
+    }
+  }
+
+  bitboard_t SliderAttacks(bitboard_t rooksQueens, bitboard_t bishopsQueens, bitboard_t occupied)
+  {
+    static const sliderAttacks_t s_sliderAttacks = SelectSliderAttacks();
+    return s_sliderAttacks(rooksQueens, bishopsQueens, occupied);
+  }
+
+  bitboard_t SliderAttacksScalar(bitboard_t rooksQueens, bitboard_t bishopsQueens, bitboard_t occupied)
+  {
+    const bitboard_t empty = ~occupied;
+    return FillLeft(rooksQueens, empty, 8, ~bitboard_t(0)) |
+           FillLeft(rooksQueens, empty, 1, NOT_FILE_A) |
+           FillLeft(bishopsQueens, empty, 9, NOT_FILE_A) |
+           FillLeft(bishopsQueens, empty, 7, NOT_FILE_H) |
+           FillRight(rooksQueens, empty, 8, ~bitboard_t(0)) |
+           FillRight(rooksQueens, empty, 1, NOT_FILE_H) |
+           FillRight(bishopsQueens, empty, 9, NOT_FILE_H) |
+           FillRight(bishopsQueens, empty, 7, NOT_FILE_A);
+  }
+
+#ifdef JC_X86
+  JC_TARGET_AVX2 bitboard_t SliderAttacksAvx2(bitboard_t rooksQueens, bitboard_t bishopsQueens, bitboard_t occupied)
+  {
+    // lanes: north and east (rooks), north-east and north-west (bishops);
+    // the same shift counts to the right give south, west, south-west and south-east
+    const __m256i gen0 = _mm256_setr_epi64x(static_cast<long long>(rooksQueens),
+      static_cast<long long>(rooksQueens), static_cast<long long>(bishopsQueens), static_cast<long long>(bishopsQueens));
+    const __m256i shift1 = _mm256_setr_epi64x(8, 1, 9, 7);
+    const __m256i shift2 = _mm256_setr_epi64x(16, 2, 18, 14);
+    const __m256i shift4 = _mm256_setr_epi64x(32, 4, 36, 28);
+    const __m256i empty = _mm256_set1_epi64x(static_cast<long long>(~occupied));
+    const long long notFileA = static_cast<long long>(NOT_FILE_A);
+    const long long notFileH = static_cast<long long>(NOT_FILE_H);
+    const __m256i leftMask = _mm256_setr_epi64x(-1, notFileA, notFileA, notFileH);
+    const __m256i rightMask = _mm256_setr_epi64x(-1, notFileH, notFileH, notFileA);
+
+    __m256i genLeft = gen0;
+    __m256i proLeft = _mm256_and_si256(empty, leftMask);
+    __m256i genRight = gen0;
+    __m256i proRight = _mm256_and_si256(empty, rightMask);
+
+    genLeft = _mm256_or_si256(genLeft, _mm256_and_si256(proLeft, _mm256_sllv_epi64(genLeft, shift1)));
+    genRight = _mm256_or_si256(genRight, _mm256_and_si256(proRight, _mm256_srlv_epi64(genRight, shift1)));
+    proLeft = _mm256_and_si256(proLeft, _mm256_sllv_epi64(proLeft, shift1));
+    proRight = _mm256_and_si256(proRight, _mm256_srlv_epi64(proRight, shift1));
+
+    genLeft = _mm256_or_si256(genLeft, _mm256_and_si256(proLeft, _mm256_sllv_epi64(genLeft, shift2)));
+    genRight = _mm256_or_si256(genRight, _mm256_and_si256(proRight, _mm256_srlv_epi64(genRight, shift2)));
+    proLeft = _mm256_and_si256(proLeft, _mm256_sllv_epi64(proLeft, shift2));
+    proRight = _mm256_and_si256(proRight, _mm256_srlv_epi64(proRight, shift2));
+
+    genLeft = _mm256_or_si256(genLeft, _mm256_and_si256(proLeft, _mm256_sllv_epi64(genLeft, shift4)));
+    genRight = _mm256_or_si256(genRight, _mm256_and_si256(proRight, _mm256_srlv_epi64(genRight, shift4)));
+
+    const __m256i attacks = _mm256_or_si256(
+      _mm256_and_si256(_mm256_sllv_epi64(genLeft, shift1), leftMask),
+      _mm256_and_si256(_mm256_srlv_epi64(genRight, shift1), rightMask));
+
+    // combine the four lanes
+    const __m128i half = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+    return static_cast<bitboard_t>(_mm_cvtsi128_si64(_mm_or_si128(half, _mm_unpackhi_epi64(half, half))));
+  }
+#endif
+
+  bitboard_t KnightAttacks(bitboard_t knights)
+  {
+    return ((knights << 17) & NOT_FILE_A) | ((knights << 15) & NOT_FILE_H) |
+           ((knights << 10) & NOT_FILE_AB) | ((knights << 6) & NOT_FILE_GH) |
+           ((knights >> 17) & NOT_FILE_H) | ((knights >> 15) & NOT_FILE_A) |
+           ((knights >> 10) & NOT_FILE_GH) | ((knights >> 6) & NOT_FILE_AB);
+  }
+
+  bitboard_t KingAttacks(bitboard_t king)
+  {
+    const bitboard_t row = king | ((king << 1) & NOT_FILE_A) | ((king >> 1) & NOT_FILE_H);
+    return (row | (row << 8) | (row >> 8)) & ~king;
+  }
+
+  bitboard_t PawnAttacks(bitboard_t pawns, bool white)
+  {
+    return white ?
+      ((pawns << 9) & NOT_FILE_A) | ((pawns << 7) & NOT_FILE_H) :
+      ((pawns >> 7) & NOT_FILE_A) | ((pawns >> 9) & NOT_FILE_H);
+  }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Platform/CpuFeatures.h"
+
+namespace JC
+{
+  /// @brief Set of squares, bit @c SquareIndex(rank, file) (a1 is bit 0, h1 bit 7, a8 bit 56)
+  using bitboard_t = uint64_t;
+
+  /// @brief Squares attacked by all rooks, bishops and queens of one color.
+  /// Rays are computed with Kogge-Stone occluded fills (no lookup tables); with AVX2
+  /// four directions are processed in parallel lanes, otherwise the scalar fills are used.
+  /// @param rooksQueens squares of the rooks and queens
+  /// @param bishopsQueens squares of the bishops and queens
+  /// @param occupied squares of all pieces (rays stop at the first occupied square, which is attacked)
+  /// @return attacked squares
+  bitboard_t SliderAttacks(bitboard_t rooksQueens, bitboard_t bishopsQueens, bitboard_t occupied);
+
+  /// @brief @c SliderAttacks() without SIMD instructions
+  bitboard_t SliderAttacksScalar(bitboard_t rooksQueens, bitboard_t bishopsQueens, bitboard_t occupied);
+
+#ifdef JC_X86
+  /// @brief @c SliderAttacks() with AVX2 (the CPU has to support it, see @c DetectSimdLevel())
+  bitboard_t SliderAttacksAvx2(bitboard_t rooksQueens, bitboard_t bishopsQueens, bitboard_t occupied);
+#endif
+
+  /// @return squares attacked by knights
+  bitboard_t KnightAttacks(bitboard_t knights);
+
+  /// @return squares attacked by a king
+  bitboard_t KingAttacks(bitboard_t king);
+
+  /// @return squares attacked by pawns of a color
+  bitboard_t PawnAttacks(bitboard_t pawns, bool white);
+}
@@ -1,31 +1,78 @@
 ﻿#include <stdafx.h>
 
 #include "ChessBoard.h"
-#include "..\ChessPieces\OtherPieces.h"
+#include "..\..\Profiling\Profiler.h"
+#include "..\..\Profiling\Tracer.h"
 
 namespace JC
 {
+  namespace
+  {
+    /// @brief Constants of one color for the move generation templated on the color
+    template<bool White>
+    struct SColor
+    {
+      /// @brief Rank direction of pawn moves
+      static constexpr int PAWN_DIR = White ? 1 : -1;
+      /// @brief Rank of king and rooks at the start (castling rank)
+      static constexpr eRank BACK_RANK = White ? eRank::_1 : eRank::_8;
+      /// @brief Rank of the pawns at the start (double step possible)
+      static constexpr eRank PAWN_RANK = White ? eRank::_2 : eRank::_7;
+      /// @brief Last rank of the pawns (promotion is not supported, so they can't move there)
+      static constexpr eRank PROMOTION_RANK = White ? eRank::_8 : eRank::_1;
+      static constexpr packedpiece_t KING = PackPiece(ePiece::king, White);
+      static constexpr packedpiece_t ROOK = PackPiece(ePiece::rook, White);
+      static constexpr packedpiece_t OPPONENT_PAWN = PackPiece(ePiece::pawn, !White);
+    };
+  }
 
   CChessBoard::piece_t CChessBoard::GetPieceType(eRank rank, eFile file) const
   {
-    if (!m_board[_UINT8(rank)][_UINT8(file)])
+    const packedpiece_t piece = m_board[SquareIndex(rank, file)];
+    return std::pair(PieceType(piece), PieceIsWhite(piece));
+  }
+
+  std::optional<CChessPiece> CChessBoard::GetPiece(eRank rank, eFile file) const
+  {
+    const packedpiece_t piece = m_board[SquareIndex(rank, file)];
+    if (piece == NO_PIECE)
     {
-      return std::pair(ePiece::none, false);
+      return std::nullopt;
     }
-    return std::pair(m_board[_UINT8(rank)][_UINT8(file)]->GetType(), 
-                     m_board[_UINT8(rank)][_UINT8(file)]->IsWhite());
+    return CChessPiece(piece);
   }
 
-  JC::CChessBoard::boolmat_t CChessBoard::GetValidMoves(eRank rank, eFile file, bool forWhite) const
+  bitboard_t CChessBoard::GetValidMoves(eRank rank, eFile file, bool forWhite) const
+  {
+    JC_PROFILE_ZONE("CChessBoard::GetValidMoves");
+    JC_TRACE_SCOPE("CChessBoard::GetValidMoves");
+    return GetMoveCache(forWhite).m_destinations[SquareIndex(rank, file)];
+  }
+
+  JC::CChessBoard::boolmat_t CChessBoard::ToBoolMat(bitboard_t squares)
   {
     boolmat_t boolmat(RANKS, std::vector<bool>(FILES));
-    auto& piece = m_board[_UINT8(rank)][_UINT8(file)];
-    if (!piece || piece->GetType() == ePiece::none || piece->IsWhite() != forWhite)
+    for (uint8_t ind = 0; squares != 0 && ind < RANKS * FILES; ind++)
+    {
+      boolmat[ind / FILES][ind % FILES] = (squares & (uint64_t(1) << ind)) != 0;
+    }
+    return boolmat;
+  }
+
+  template<bool White>
+  uint64_t CChessBoard::GenerateValidMoves(eRank rank, eFile file) const
+  {
+    using color = SColor<White>;
+    uint64_t validMoves = 0;
+    const packedpiece_t piece = m_board[SquareIndex(rank, file)];
+    const ePiece pieceType = PieceType(piece);
+    if (pieceType == ePiece::none || PieceIsWhite(piece) != White)
     {
-      return boolmat;
+      return validMoves;
     }
+    const bool canMoveMultipleSteps = s_moveMultipleStepsMap.at(pieceType);
 
-    for (const auto& dir : piece->GetMoveDirs())
+    for (const auto& dir : s_moveDirMap.at(pieceType))
     {
       int newRank = _UINT8(rank) + dir.first;
       int newFile = _UINT8(file) + dir.second;
@@ -36,24 +83,22 @@ namespace JC
         {
           break; // outside of the board
         }
-        auto newPieceType = GetPieceType(static_cast<eRank>(newRank), static_cast<eFile>(newFile));
+        const packedpiece_t newPiece = m_board[SquareIndex(newRank, newFile)];
 
         //check if new position on board is free to move
-        if (newPieceType.first == ePiece::none)
+        if (newPiece == NO_PIECE)
         {
-          if (!WouldBeCheckedAfterMove(rank, file, static_cast<eRank>(newRank),
-            static_cast<eFile>(newFile), forWhite))
+          if (!WouldBeCheckedAfterMove<White>(rank, file, static_cast<eRank>(newRank), static_cast<eFile>(newFile)))
           {
-            boolmat[newRank][newFile] = true;
+            validMoves |= SquareBit(newRank, newFile);
           }
         }
         //check if at new position is a piece of the opponent
-        else if (newPieceType.second != forWhite)
+        else if (PieceIsWhite(newPiece) != White)
         {
-          if (!WouldBeCheckedAfterMove(rank, file, static_cast<eRank>(newRank),
-            static_cast<eFile>(newFile), forWhite))
+          if (!WouldBeCheckedAfterMove<White>(rank, file, static_cast<eRank>(newRank), static_cast<eFile>(newFile)))
           {
-            boolmat[newRank][newFile] = true;
+            validMoves |= SquareBit(newRank, newFile);
           }
           break; // exit loop because piece can't move further in this direction after capturing
         }
@@ -64,123 +109,209 @@ namespace JC
         }
         newRank += dir.first;
         newFile += dir.second;
-      } while (piece->CanMoveMultipleSteps());
+      } while (canMoveMultipleSteps);
     }
     // special treatment for pawns
-    if (piece->GetType() == ePiece::pawn && rank != eRank::_1 && rank != eRank::_8)
+    if (pieceType == ePiece::pawn && rank != color::PROMOTION_RANK && rank != color::BACK_RANK)
     {
-      if (GetPieceType(static_cast<eRank>(_UINT8(rank) + (forWhite ? 1 : -1)), file).first == ePiece::none)
+      const eRank forwardRank = static_cast<eRank>(_UINT8(rank) + color::PAWN_DIR);
+      if (m_board[SquareIndex(forwardRank, file)] == NO_PIECE)
       {
-        if (!WouldBeCheckedAfterMove(rank, file, static_cast<eRank>(_UINT8(rank) + (forWhite ? 1 : -1)),
-          static_cast<eFile>(file), forWhite))
+        if (!WouldBeCheckedAfterMove<White>(rank, file, forwardRank, file))
         {
-          boolmat[_INT64(rank) + (forWhite ? 1 : -1)][_UINT8(file)] = true;
+          validMoves |= SquareBit(forwardRank, file);
         }
         // check if double step is possible
-        if (rank == (forWhite ? eRank::_2 : eRank::_7))
+        if (rank == color::PAWN_RANK)
         {
-          if (GetPieceType(static_cast<eRank>(_UINT8(rank)+ (forWhite ? 2 : -2)), file).first == ePiece::none)
+          const eRank doubleStepRank = static_cast<eRank>(_UINT8(rank) + 2 * color::PAWN_DIR);
+          if (m_board[SquareIndex(doubleStepRank, file)] == NO_PIECE &&
+              !WouldBeCheckedAfterMove<White>(rank, file, doubleStepRank, file))
           {
-            if (!WouldBeCheckedAfterMove(rank, file, static_cast<eRank>(_UINT8(rank) + (forWhite ? 2 : -2)),
-              static_cast<eFile>(file), forWhite))
-            {
-              boolmat[_INT64(rank) + (forWhite ? 2 : -2)][_UINT8(file)] = true;
-            }
+            validMoves |= SquareBit(doubleStepRank, file);
           }
         }
       }
-      // check if pawn can capture a piece
-      if (file >= eFile::B)
+      // check if pawn can capture a piece (to the left and to the right)
+      for (const int side : { -1, 1 })
       {
-        auto leftPiece = GetPieceType(static_cast<eRank>(_UINT8(rank) + (forWhite ? 1 : -1)), static_cast<eFile>(_UINT8(file) - 1));
-        if ((leftPiece.first != ePiece::none && leftPiece.second != forWhite) ||
-             // check also if en passant capture is possible
+        const int captureFile = _UINT8(file) + side;
+        if (captureFile < 0 || captureFile >= FILES)
+        {
+          continue;
+        }
+        const packedpiece_t target = m_board[SquareIndex(forwardRank, static_cast<eFile>(captureFile))];
+        if ((target != NO_PIECE && PieceIsWhite(target) != White) ||
+            // check also if en passant capture is possible
             (m_enPassantPos.has_value() &&
-             m_enPassantPos->first == static_cast<eRank>(_UINT8(rank )+ (forWhite ? 1 : -1)) &&
-             m_enPassantPos->second == static_cast<eFile>(_UINT8(file) - 1)))
+             m_enPassantPos->first == forwardRank &&
+             m_enPassantPos->second == static_cast<eFile>(captureFile)))
         {
-          if (!WouldBeCheckedAfterMove(rank, file, static_cast<eRank>(_UINT8(rank) + (forWhite ? 1 : -1)),
-            static_cast<eFile>(_UINT8(file) - 1), forWhite))
+          if (!WouldBeCheckedAfterMove<White>(rank, file, forwardRank, static_cast<eFile>(captureFile)))
           {
-            boolmat[_INT64(rank) + (forWhite ? 1 : -1)][_UINT8(file) - 1] = true;
+            validMoves |= SquareBit(forwardRank, static_cast<eFile>(captureFile));
           }
         }
       }
-      if (file <= eFile::G)
+    }
+    // check if castling is possible
+    if (pieceType == ePiece::king)
+    {
+      if (CanCastle<White, true>())
       {
-        auto rightPiece = GetPieceType(static_cast<eRank>(_UINT8(rank) + (forWhite ? 1 : -1)), static_cast<eFile>(_UINT8(file) + 1));
-        if ((rightPiece.first != ePiece::none && rightPiece.second != forWhite) ||
-             // check also if en passant capture is possible
-            (m_enPassantPos.has_value() &&
-             m_enPassantPos->first == static_cast<eRank>(_UINT8(rank) + (forWhite ? 1 : -1)) &&
-             m_enPassantPos->second == static_cast<eFile>(_UINT8(file) + 1)))
+        validMoves |= SquareBit(color::BACK_RANK, eFile::C);
+      }
+      if (CanCastle<White, false>())
+      {
+        validMoves |= SquareBit(color::BACK_RANK, eFile::G);
+      }
+    }
+    return validMoves;
+  }
+
+  void CChessBoard::GetAllValidMoves(bool forWhite, std::vector<SMove>& moves) const
+  {
+    const SMoveCache& cache = GetMoveCache(forWhite);
+    for (uint8_t from = 0; from < RANKS * FILES; from++)
+    {
+      const uint64_t validMoves = cache.m_destinations[from];
+      for (uint8_t to = 0; validMoves != 0 && to < RANKS * FILES; to++)
+      {
+        if (validMoves & (uint64_t(1) << to))
         {
-          if (!WouldBeCheckedAfterMove(rank, file, static_cast<eRank>(_UINT8(rank) + (forWhite ? 1 : -1)),
-            static_cast<eFile>(_UINT8(file) + 1), forWhite))
-          {
-            boolmat[_INT64(rank) + (forWhite ? 1 : -1)][_INT64(file) + 1] = true;
-          }
+          moves.push_back(SMove{ static_cast<eRank>(from / FILES), static_cast<eFile>(from % FILES),
+                                 static_cast<eRank>(to / FILES), static_cast<eFile>(to % FILES) });
         }
       }
     }
-    // check if castling is possible
-    if (piece->GetType() == ePiece::king)
+  }
+
+  std::size_t CChessBoard::CountValidMoves(bool forWhite) const
+  {
+    return GetMoveCache(forWhite).m_count;
+  }
+
+  const CChessBoard::SMoveCache& CChessBoard::GetMoveCache(bool forWhite) const
+  {
+    SMoveCache& cache = m_moveCache[forWhite ? 0 : 1];
+    // double-checked: filled once per position, afterwards readers only need the acquire load
+    if (!cache.m_valid.load(std::memory_order_acquire))
     {
-      if (CanCastle(forWhite, true))
+      std::lock_guard<std::mutex> lock(cache.m_mutex);
+      if (!cache.m_valid.load(std::memory_order_relaxed))
       {
-        boolmat[forWhite ? _INT64(eRank::_1) : _INT64(eRank::_8)][_INT64(eFile::C)] = true;
+        if (forWhite)
+        {
+          FillMoveCache<true>(cache);
+        }
+        else
+        {
+          FillMoveCache<false>(cache);
+        }
+        cache.m_valid.store(true, std::memory_order_release);
       }
-      if (CanCastle(forWhite, false))
+    }
+    return cache;
+  }
+
+  template<bool White>
+  void CChessBoard::FillMoveCache(SMoveCache& cache) const
+  {
+    // one zone per instantiation, so the name tells the color
+    JC_PROFILE_ZONE(White ? "CChessBoard::FillMoveCache<white>" : "CChessBoard::FillMoveCache<black>");
+    JC_TRACE_SCOPE("CChessBoard::FillMoveCache");
+    cache.m_count = 0;
+    cache.m_destinations.fill(0);
+    const SPieceList& pieces = m_pieceLists[White ? 0 : 1];
+    for (uint8_t ind = 0; ind < pieces.m_count; ind++)
+    {
+      const uint8_t square = pieces.m_squares[ind];
+      uint64_t validMoves = GenerateValidMoves<White>(static_cast<eRank>(square / FILES), static_cast<eFile>(square % FILES));
+      cache.m_destinations[square] = validMoves;
+      for (; validMoves != 0; validMoves &= validMoves - 1)
       {
-        boolmat[forWhite ? _INT64(eRank::_1) : _INT64(eRank::_8)][_INT64(eFile::G)] = true;
+        cache.m_count++;
       }
     }
-    return boolmat;
   }
 
-  bool CChessBoard::IsChecked(bool forWhite) const
+  void CChessBoard::InvalidateCaches()
+  {
+    for (SMoveCache& cache : m_moveCache)
+    {
+      cache.m_valid.store(false, std::memory_order_relaxed);
+      cache.m_status.store(SMoveCache::NO_STATUS, std::memory_order_relaxed);
+    }
+  }
+
+  bool CChessBoard::HasValidMove(bool forWhite) const
+  {
+    const SMoveCache& cache = m_moveCache[forWhite ? 0 : 1];
+    if (cache.m_valid.load(std::memory_order_acquire))
+    {
+      return cache.m_count > 0;
+    }
+    return forWhite ? HasValidMove<true>() : HasValidMove<false>();
+  }
+
+  template<bool White>
+  bool CChessBoard::HasValidMove() const
   {
-    const auto& kingPos = forWhite ? m_whiteKingPos : m_blackKingPos;
-    const auto& oppKingPos = forWhite ? m_blackKingPos : m_whiteKingPos;
+    const SPieceList& pieces = m_pieceLists[White ? 0 : 1];
+    for (uint8_t ind = 0; ind < pieces.m_count; ind++)
+    {
+      const uint8_t square = pieces.m_squares[ind];
+      if (GenerateValidMoves<White>(static_cast<eRank>(square / FILES), static_cast<eFile>(square % FILES)) != 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
 
+  bool CChessBoard::IsChecked(bool forWhite) const
+  {
+    JC_PROFILE_ZONE("CChessBoard::IsChecked");
     if (m_record.empty())
     {
-      m_logger->Error("There are no records: IsChecked() not possible.", __FILE__, __LINE__);
+      JC_LOG_ERROR(m_logger, "There are no records: IsChecked() not possible.");
       return false;
     }
-    const auto& boardView = m_record.back();
+    return forWhite ?
+      IsCheckedInView<true>(m_record.back(), m_whiteKingPos, m_blackKingPos) :
+      IsCheckedInView<false>(m_record.back(), m_blackKingPos, m_whiteKingPos);
+  }
 
+  template<bool White>
+  bool CChessBoard::IsCheckedInView(const view_t& boardView, std::pair<eRank, eFile> kingPos,
+    std::pair<eRank, eFile> oppKingPos)
+  {
+    using color = SColor<White>;
     // assert that kings are actually at correct (saved) position
-    DEBUG_ASSERT(boardView[_UINT8(kingPos.first)][_UINT8(kingPos.second)].first == ePiece::king &&
-                 boardView[_UINT8(kingPos.first)][_UINT8(kingPos.second)].second == forWhite);
-    DEBUG_ASSERT(boardView[_UINT8(oppKingPos.first)][_UINT8(oppKingPos.second)].first == ePiece::king &&
-                 boardView[_UINT8(oppKingPos.first)][_UINT8(oppKingPos.second)].second != forWhite);
+    DEBUG_ASSERT(boardView[SquareIndex(kingPos.first, kingPos.second)] == color::KING);
+    DEBUG_ASSERT(boardView[SquareIndex(oppKingPos.first, oppKingPos.second)] == PackPiece(ePiece::king, !White));
 
     // check if king is checked by one the following pieces (queen is included in bishop and rook)
-    if (IsCheckedPieceDirection(ePiece::bishop, forWhite) ||
-        IsCheckedPieceDirection(ePiece::rook, forWhite)   ||
-        IsCheckedPieceDirection(ePiece::knight, forWhite))
+    if (IsCheckedPieceDirection<White>(boardView, kingPos, ePiece::bishop) ||
+        IsCheckedPieceDirection<White>(boardView, kingPos, ePiece::rook)   ||
+        IsCheckedPieceDirection<White>(boardView, kingPos, ePiece::knight))
     {
       return true;
     }
 
-    // check if king is checked by a pawn
-    if (forWhite)
+    // check if king is checked by a pawn (pawns of the opponent attack towards the king's side)
+    const int pawnRank = _UINT8(kingPos.first) + color::PAWN_DIR;
+    if (pawnRank >= 0 && pawnRank < RANKS)
     {
-      if (kingPos.first < eRank::_7)
+      if (kingPos.second >= eFile::B &&
+          boardView[SquareIndex(pawnRank, _UINT8(kingPos.second) - 1)] == color::OPPONENT_PAWN)
       {
-        if (kingPos.second >= eFile::B &&
-            boardView[_INT64(kingPos.first) + 1][_UINT8(kingPos.second) - 1].second != forWhite &&
-            boardView[_INT64(kingPos.first) + 1][_UINT8(kingPos.second) - 1].first == ePiece::pawn)
-        {
-          return true;
-        }
-        if (kingPos.second <= eFile::G &&
-          boardView[_INT64(kingPos.first) + 1][_INT64(kingPos.second) + 1].second != forWhite &&
-          boardView[_INT64(kingPos.first) + 1][_INT64(kingPos.second) + 1].first == ePiece::pawn)
-        {
-          return true;
-        }
+        return true;
+      }
+      if (kingPos.second <= eFile::G &&
+          boardView[SquareIndex(pawnRank, _UINT8(kingPos.second) + 1)] == color::OPPONENT_PAWN)
+      {
+        return true;
       }
     }
     
@@ -196,54 +327,42 @@ namespace JC
 
   bool CChessBoard::Move(eRank fromRank, eFile fromFile, eRank toRank, eFile toFile, bool forWhite)
   {
-    boolmat_t validMoves = GetValidMoves(fromRank, fromFile, forWhite);
+    JC_PROFILE_ZONE("CChessBoard::Move");
+    JC_TRACE_SCOPE("CChessBoard::Move");
+    // use the cached moves if the position was already queried, otherwise only generate the moves of this piece
+    const SMoveCache& cache = m_moveCache[forWhite ? 0 : 1];
+    const uint64_t validMoves = cache.m_valid.load(std::memory_order_acquire) ?
+      cache.m_destinations[SquareIndex(fromRank, fromFile)] :
+      (forWhite ? GenerateValidMoves<true>(fromRank, fromFile) : GenerateValidMoves<false>(fromRank, fromFile));
 
-    if (!validMoves[_UINT8(toRank)][_UINT8(toFile)])
+    if (!(validMoves & SquareBit(toRank, toFile)))
     {
       return false;
     }
-    m_removed.push_back(std::move(m_board[_UINT8(toRank)][_UINT8(toFile)]));
-    m_board[_UINT8(toRank)][_UINT8(toFile)] = std::move(m_board[_UINT8(fromRank)][_UINT8(fromFile)]);
+    const uint8_t fromInd = SquareIndex(fromRank, fromFile);
+    const uint8_t toInd = SquareIndex(toRank, toFile);
+    const ePiece movedType = PieceType(m_board[fromInd]);
+    const bool isCapture = m_board[toInd] != NO_PIECE;
+    m_material -= MaterialKey(m_board[toInd], toInd);
+    m_pawnKey ^= PawnKey(m_board[toInd], toInd) ^ PawnKey(m_board[fromInd], fromInd) ^
+                 PawnKey(m_board[fromInd], toInd);
+    MovePiece(fromInd, toInd);
 
     // if king was moved two files, it was castling and also the rook has to be moved
-    if (m_board[_UINT8(toRank)][_UINT8(toFile)] && m_board[_UINT8(toRank)][_UINT8(toFile)]->GetType() == ePiece::king)
+    if (movedType == ePiece::king)
     {
       if (fromFile == eFile::E && toFile == eFile::C)
       {
-        m_board[_UINT8(toRank)][_UINT8(eFile::D)] = std::move(m_board[_UINT8(toRank)][_UINT8(eFile::A)]);
+        MovePiece(SquareIndex(toRank, eFile::A), SquareIndex(toRank, eFile::D));
       }
       else if (fromFile == eFile::E && toFile == eFile::G)
       {
-        m_board[_UINT8(toRank)][_UINT8(eFile::F)] = std::move(m_board[_UINT8(toRank)][_UINT8(eFile::H)]);
-      }
-      else
-      {
-        auto& kingMoved = (forWhite ? m_whiteKingMoved : m_blackKingMoved);
-        kingMoved = true;
-      }
-    }
-    // if rook was moved from initial position, set corresponding flag for castling
-    if (m_board[_UINT8(toRank)][_UINT8(toFile)] && m_board[_UINT8(toRank)][_UINT8(toFile)]->GetType() == ePiece::rook)
-    {
-      if (fromRank == eRank::_1 && fromFile == eFile::A)
-      {
-        m_whiteRookAtQueenSideMoved = true;
-      }
-      else if (fromRank == eRank::_1 && fromFile == eFile::H)
-      {
-        m_whiteRookAtKingSideMoved = true;
-      }
-      else if (fromRank == eRank::_8 && fromFile == eFile::A)
-      {
-        m_blackRookAtQueenSideMoved = true;
-      }
-      else if (fromRank == eRank::_8 && fromFile == eFile::H)
-      {
-        m_blackRookAtKingSideMoved = true;
+        MovePiece(SquareIndex(toRank, eFile::H), SquareIndex(toRank, eFile::F));
       }
     }
-    // if pawn was moved, reset corresponding counter
-    else if (m_board[_UINT8(toRank)][_UINT8(toFile)] && m_board[_UINT8(toRank)][_UINT8(toFile)]->GetType() == ePiece::pawn)
+    // if pawn was moved or a piece was captured, reset corresponding counter
+    // (the position before can't be repeated anymore)
+    if (movedType == ePiece::pawn || isCapture)
     {
       m_turnsWithoutPawn = 0;
     }
@@ -252,27 +371,27 @@ namespace JC
       m_turnsWithoutPawn++;
     }
     // if king was moved, update his position
-    if (m_board[_UINT8(toRank)][_UINT8(toFile)] && m_board[_UINT8(toRank)][_UINT8(toFile)]->GetType() == ePiece::king)
+    if (movedType == ePiece::king)
     {
       auto& refKingPos = forWhite ? m_whiteKingPos : m_blackKingPos;
       refKingPos = std::pair(toRank, toFile);
     }
     // check if pawn captured en passant
-    else if (m_board[_UINT8(toRank)][_UINT8(toFile)] && m_board[_UINT8(toRank)][_UINT8(toFile)]->GetType() == ePiece::pawn &&
+    else if (movedType == ePiece::pawn &&
       m_enPassantPos.has_value() &&
       m_enPassantPos->first == toRank && m_enPassantPos->second == toFile)
     {
       // delete pawn which was captured en passant (and assert that it actually is a pawn)
-      eRank rankOfPawnToCapture = static_cast<eRank>(_UINT8(toRank) + (forWhite ? -1 : 1));
-      DEBUG_ASSERT(m_board[_UINT8(rankOfPawnToCapture)][_UINT8(toFile)] &&
-                   m_board[_UINT8(rankOfPawnToCapture)][_UINT8(toFile)]->GetType() == ePiece::pawn &&
-                   m_board[_UINT8(rankOfPawnToCapture)][_UINT8(toFile)]->IsWhite() != forWhite);
-      m_removed.back() = std::move(m_board[_UINT8(rankOfPawnToCapture)][_UINT8(toFile)]);
+      const uint8_t capturedInd = SquareIndex(static_cast<eRank>(_UINT8(toRank) + (forWhite ? -1 : 1)), toFile);
+      DEBUG_ASSERT(PieceType(m_board[capturedInd]) == ePiece::pawn &&
+                   PieceIsWhite(m_board[capturedInd]) != forWhite);
+      m_material -= MaterialKey(m_board[capturedInd], capturedInd);
+      m_pawnKey ^= PawnKey(m_board[capturedInd], capturedInd);
+      SetSquare(capturedInd, NO_PIECE);
     }
 
     // if pawn did double step, set en passant capture position
-    if (m_board[_UINT8(toRank)][_UINT8(toFile)] && m_board[_UINT8(toRank)][_UINT8(toFile)]->GetType() == ePiece::pawn &&
-        std::abs((int)fromRank - (int)toRank) == 2)
+    if (movedType == ePiece::pawn && std::abs((int)fromRank - (int)toRank) == 2)
     {
       // set en passant capture position: one rank below (for white) or above (for black) the current pawn position
       m_enPassantPos = std::make_optional<std::pair<eRank, eFile>>();
@@ -283,55 +402,92 @@ namespace JC
     {
       m_enPassantPos.reset();
     }
+    m_whiteToMove = !forWhite;
+    m_plyCount++;
+    InvalidateCaches();
     CreateNextRecord();
     return true;
   }
 
   bool CChessBoard::CanCastle(bool forWhite, bool forQueenSide) const
   {
-    bool kingMoved = forWhite ? m_whiteKingMoved : m_blackKingMoved;
-    bool rookMoved = forWhite ? 
-      (forQueenSide ? m_whiteRookAtQueenSideMoved : m_whiteRookAtKingSideMoved) :
-      (forQueenSide ? m_blackRookAtQueenSideMoved : m_blackRookAtKingSideMoved);
-    if (kingMoved || rookMoved)
+    if (forWhite)
     {
-      return false;
+      return forQueenSide ? CanCastle<true, true>() : CanCastle<true, false>();
     }
+    return forQueenSide ? CanCastle<false, true>() : CanCastle<false, false>();
+  }
 
-    eRank rank = forWhite ? eRank::_1 : eRank::_8;
-    eFile fromFile = eFile::E;
-    eFile toFile1 = forQueenSide ? eFile::C : eFile::F;
-    eFile toFile2 = forQueenSide ? eFile::D : eFile::G;
-    
-    if (m_board[_UINT8(rank)][_UINT8(toFile1)] != nullptr ||
-        m_board[_UINT8(rank)][_UINT8(toFile2)] != nullptr)
+  template<bool White, bool QueenSide>
+  bool CChessBoard::CanCastle() const
+  {
+    JC_PROFILE_ZONE(White ? (QueenSide ? "CChessBoard::CanCastle<white,queenside>" : "CChessBoard::CanCastle<white,kingside>")
+                          : (QueenSide ? "CChessBoard::CanCastle<black,queenside>" : "CChessBoard::CanCastle<black,kingside>"));
+    using color = SColor<White>;
+    constexpr eRank rank = color::BACK_RANK;
+    constexpr eFile fromFile = eFile::E;
+    constexpr eFile toFile1 = QueenSide ? eFile::C : eFile::F;
+    constexpr eFile toFile2 = QueenSide ? eFile::D : eFile::G;
+
+    // king and rook have to be at their start positions and must not have moved
+    if (m_board[SquareIndex(rank, fromFile)] != color::KING ||
+        m_board[SquareIndex(rank, QueenSide ? eFile::A : eFile::H)] != color::ROOK)
     {
       return false;
     }
-    if (IsChecked(forWhite) ||
-        WouldBeCheckedAfterMove(rank, fromFile, rank, toFile1, forWhite) ||
-        WouldBeCheckedAfterMove(rank, fromFile, rank, toFile2, forWhite))
+    if (m_board[SquareIndex(rank, toFile1)] != NO_PIECE ||
+        m_board[SquareIndex(rank, toFile2)] != NO_PIECE ||
+        (QueenSide && m_board[SquareIndex(rank, eFile::B)] != NO_PIECE))
     {
       return false;
     }
-    return true;
+    // the king must not be in check and must not pass or land on an attacked square
+    constexpr bitboard_t kingPath = SquareBit(rank, fromFile) | SquareBit(rank, toFile1) | SquareBit(rank, toFile2);
+    return (GetAttackedSquares(!White) & kingPath) == 0;
   }
 
-  eState CChessBoard::CheckmateState(bool forWhite) const
+  bitboard_t CChessBoard::GetAttackedSquares(bool byWhite) const
   {
-    /// count number of valid moves for all pieces for black or white;
-    /// if number is zero, player is either checkmate or it's a stalemate
-    
-    std::size_t countValidMoves = 0;
-    for (uint8_t rank = 0; rank < RANKS; rank++)
-    {
-      for (uint8_t file = 0; file < FILES; file++)
+    JC_PROFILE_ZONE("CChessBoard::GetAttackedSquares");
+    bitboard_t occupied = 0;
+    bitboard_t pawns = 0;
+    bitboard_t knights = 0;
+    bitboard_t rooksQueens = 0;
+    bitboard_t bishopsQueens = 0;
+    bitboard_t king = 0;
+    const SPieceList& opponents = m_pieceLists[byWhite ? 1 : 0];
+    for (uint8_t ind = 0; ind < opponents.m_count; ind++)
+    {
+      occupied |= bitboard_t(1) << opponents.m_squares[ind];
+    }
+    const SPieceList& attackers = m_pieceLists[byWhite ? 0 : 1];
+    for (uint8_t ind = 0; ind < attackers.m_count; ind++)
+    {
+      const uint8_t square = attackers.m_squares[ind];
+      const bitboard_t bit = bitboard_t(1) << square;
+      occupied |= bit;
+      switch (PieceType(m_board[square]))
       {
-        auto boolMat = GetValidMoves(static_cast<eRank>(rank), 
-                                     static_cast<eFile>(file), forWhite);
-        countValidMoves += CountBoolMat(boolMat);
+      case ePiece::pawn:   pawns |= bit; break;
+      case ePiece::knight: knights |= bit; break;
+      case ePiece::rook:   rooksQueens |= bit; break;
+      case ePiece::bishop: bishopsQueens |= bit; break;
+      case ePiece::queen:  rooksQueens |= bit; bishopsQueens |= bit; break;
+      case ePiece::king:   king |= bit; break;
+      default: break;
       }
     }
+    return SliderAttacks(rooksQueens, bishopsQueens, occupied) | KnightAttacks(knights) |
+           KingAttacks(king) | PawnAttacks(pawns, byWhite);
+  }
+
+  eState CChessBoard::CheckmateState(bool forWhite) const
+  {
+    JC_PROFILE_ZONE("CChessBoard::CheckmateState");
+    JC_TRACE_SCOPE("CChessBoard::CheckmateState");
+    /// count number of valid moves for all pieces for black or white;
+    /// if number is zero, player is either checkmate or it's a stalemate
+    const std::size_t countValidMoves = CountValidMoves(forWhite);
 
     bool inCheck = IsChecked(forWhite);
     if (inCheck)
@@ -358,8 +514,10 @@ namespace JC
     }
   }
 
-  bool CChessBoard::ThreefoldRepetition()
+  bool CChessBoard::ThreefoldRepetition() const
   {
+    JC_PROFILE_ZONE("CChessBoard::ThreefoldRepetition");
+    JC_TRACE_SCOPE("CChessBoard::ThreefoldRepetition");
     // look up the last moves until a pawn was moved,
     // because with pawn move a repetition is not possible
     if (m_turnsWithoutPawn < 12)
@@ -369,9 +527,24 @@ namespace JC
     }
     int repetitions = 0;
     const auto& currentView = m_record.back();
+    const std::size_t historySize = m_history ? m_history->size() : 0;
     for (std::size_t ind = 1; ind <= m_turnsWithoutPawn; ind++) 
     {
-      if (m_record[m_record.size() - 1 - ind] == currentView)
+      // views before the first record are taken from the shared history (if any)
+      const view_t* view;
+      if (ind < m_record.size())
+      {
+        view = &m_record[m_record.size() - 1 - ind];
+      }
+      else if (ind - m_record.size() < historySize)
+      {
+        view = &(*m_history)[historySize - 1 - (ind - m_record.size())];
+      }
+      else
+      {
+        break; // history was truncated
+      }
+      if (*view == currentView)
       {
         repetitions++;
         if (repetitions == 3)
@@ -383,55 +556,272 @@ namespace JC
     return false;
   }
 
-  bool CChessBoard::DueFiftyMovesRule()
+  bool CChessBoard::DueFiftyMovesRule() const
+  {
+    // fifty moves of each side
+    return m_turnsWithoutPawn >= 100;
+  }
+
+  bool CChessBoard::MaterialInsufficient() const
+  {
+    DEBUG_ASSERT(m_material == ComputeMaterial(m_board));
+    std::size_t knights = 0;
+    std::size_t bishops = 0;
+    std::size_t lightBishops = 0;
+    for (bool isWhite : { true, false })
+    {
+      if (MaterialCount(m_material, ePiece::pawn, isWhite) > 0 ||
+          MaterialCount(m_material, ePiece::rook, isWhite) > 0 ||
+          MaterialCount(m_material, ePiece::queen, isWhite) > 0)
+      {
+        return false;
+      }
+      knights += MaterialCount(m_material, ePiece::knight, isWhite);
+      bishops += MaterialCount(m_material, ePiece::bishop, isWhite);
+      lightBishops += MaterialLightBishops(m_material, isWhite);
+    }
+    // a single minor piece can't checkmate; neither can bishops which are all on one square color
+    return knights + bishops <= 1 ||
+           (knights == 0 && (lightBishops == 0 || lightBishops == bishops));
+  }
+
+  eGameStatus CChessBoard::GetGameStatus() const
+  {
+    JC_PROFILE_ZONE("CChessBoard::GetGameStatus");
+    JC_TRACE_SCOPE("CChessBoard::GetGameStatus");
+    SMoveCache& cache = m_moveCache[m_whiteToMove ? 0 : 1];
+    const uint8_t cached = cache.m_status.load(std::memory_order_relaxed);
+    if (cached != SMoveCache::NO_STATUS)
+    {
+      return static_cast<eGameStatus>(cached);
+    }
+
+    // computing the status is deterministic, so concurrent callers store the same value
+    eGameStatus status;
+    const bool inCheck = IsChecked(m_whiteToMove);
+    if (!HasValidMove(m_whiteToMove))
+    {
+      status = inCheck ? eGameStatus::eCheckmate : eGameStatus::eStalemate;
+    }
+    else if (MaterialInsufficient())
+    {
+      status = eGameStatus::eInsufficientMaterial;
+    }
+    else if (ThreefoldRepetition())
+    {
+      status = eGameStatus::eThreefoldRepetition;
+    }
+    else if (DueFiftyMovesRule())
+    {
+      status = eGameStatus::eFiftyMoves;
+    }
+    else
+    {
+      status = inCheck ? eGameStatus::eInCheck : eGameStatus::eOngoing;
+    }
+    cache.m_status.store(_UINT8(status), std::memory_order_relaxed);
+    return status;
+  }
+
+  material_t CChessBoard::ComputeMaterial(const board_t& board)
+  {
+    material_t material = 0;
+    for (uint8_t ind = 0; ind < board.size(); ind++)
+    {
+      material += MaterialKey(board[ind], ind);
+    }
+    return material;
+  }
+
+  uint64_t CChessBoard::ComputePawnKey(const board_t& board)
   {
-    return m_turnsWithoutPawn >= 50;
+    uint64_t key = 0;
+    for (uint8_t ind = 0; ind < board.size(); ind++)
+    {
+      key ^= PawnKey(board[ind], ind);
+    }
+    return key;
   }
 
-  std::pair<eRank, eFile> CChessBoard::FindKing(const view_t& boardView, bool forWhite) const
+  uint64_t CChessBoard::ComputePieceKey(const board_t& board)
   {
-    for (std::uint16_t rankInt = 0; rankInt < boardView.size(); rankInt++)
+    uint64_t key = 0;
+    for (uint8_t ind = 0; ind < board.size(); ind++)
     {
-      for (std::uint16_t fileInt = 0; fileInt < boardView[rankInt].size(); fileInt++)
+      key ^= PieceKey(board[ind], ind);
+    }
+    return key;
+  }
+
+  uint64_t CChessBoard::GetPositionKey() const
+  {
+    uint64_t key = m_pieceKey ^ (m_whiteToMove ? 0 : BLACK_TO_MOVE_KEY);
+    // the en passant square only matters if a pawn can capture there
+    if (m_enPassantPos.has_value())
+    {
+      const int pawnRank = _UINT8(m_enPassantPos->first) + (m_whiteToMove ? -1 : 1);
+      const int file = _UINT8(m_enPassantPos->second);
+      const packedpiece_t pawn = PackPiece(ePiece::pawn, m_whiteToMove);
+      if ((file > 0 && (m_board[SquareIndex(pawnRank, file - 1)] & ~PIECE_MOVED_BIT) == pawn) ||
+          (file < FILES - 1 && (m_board[SquareIndex(pawnRank, file + 1)] & ~PIECE_MOVED_BIT) == pawn))
       {
-        if (boardView[rankInt][fileInt].first == ePiece::king &&
-          boardView[rankInt][fileInt].second == forWhite)
-        {
-          return std::pair(static_cast<eRank>(rankInt), static_cast<eFile>(fileInt));
-        }
+        key ^= HashMix(uint64_t(file) + 0x1000);
       }
     }
-    DEBUG_ASSERT(false); // no king found, should never happen
-    return std::pair(eRank::_1, eFile::A);
+    return key;
   }
 
-  void CChessBoard::Reset()
+  void CChessBoard::SetSquare(uint8_t ind, packedpiece_t piece)
   {
-    m_board.clear();
-    m_board.resize(RANKS);
-    for (auto& rank : m_board)
+    m_pieceKey ^= PieceKey(m_board[ind], ind) ^ PieceKey(piece, ind);
+    // remove the old piece: the last piece of the list takes its place
+    if (m_board[ind] != NO_PIECE)
+    {
+      SPieceList& pieces = m_pieceLists[PieceIsWhite(m_board[ind]) ? 0 : 1];
+      const uint8_t listInd = m_pieceListIndex[ind];
+      const uint8_t lastSquare = pieces.m_squares[--pieces.m_count];
+      pieces.m_squares[listInd] = lastSquare;
+      m_pieceListIndex[lastSquare] = listInd;
+      m_pieceListIndex[ind] = NO_SQUARE;
+    }
+    if (piece != NO_PIECE)
     {
-      rank.resize(FILES);
+      SPieceList& pieces = m_pieceLists[PieceIsWhite(piece) ? 0 : 1];
+      DEBUG_ASSERT(pieces.m_count < MAX_PIECES);
+      m_pieceListIndex[ind] = pieces.m_count;
+      pieces.m_squares[pieces.m_count++] = ind;
     }
+    m_board[ind] = piece;
+  }
+
+  void CChessBoard::MovePiece(uint8_t fromInd, uint8_t toInd)
+  {
+    if (m_board[toInd] != NO_PIECE)
+    {
+      SetSquare(toInd, NO_PIECE); // capture
+    }
+    const packedpiece_t piece = m_board[fromInd] | PIECE_MOVED_BIT;
+    m_pieceKey ^= PieceKey(m_board[fromInd], fromInd) ^ PieceKey(piece, toInd);
+    // the piece keeps its place in the list, only the square changes
+    const uint8_t listInd = m_pieceListIndex[fromInd];
+    m_pieceLists[PieceIsWhite(piece) ? 0 : 1].m_squares[listInd] = toInd;
+    m_pieceListIndex[toInd] = listInd;
+    m_pieceListIndex[fromInd] = NO_SQUARE;
+    m_board[toInd] = piece;
+    m_board[fromInd] = NO_PIECE;
+  }
 
-    for (auto type : PIECES)
+  void CChessBoard::ComputePieceLists()
+  {
+    m_pieceLists = {};
+    m_pieceListIndex.fill(NO_SQUARE);
+    for (uint8_t ind = 0; ind < RANKS * FILES; ind++)
     {
-      for (bool isWhite : {true, false})
+      if (m_board[ind] != NO_PIECE)
       {
-        for (const auto& pos : CChessPiece::GetStartPositions(type, isWhite))
-        {
-          auto [rank, file] = pos;
-          m_board[rank][file] = std::move(CreatePiece(type, isWhite));
-        }
+        SPieceList& pieces = m_pieceLists[PieceIsWhite(m_board[ind]) ? 0 : 1];
+        DEBUG_ASSERT(pieces.m_count < MAX_PIECES);
+        m_pieceListIndex[ind] = pieces.m_count;
+        pieces.m_squares[pieces.m_count++] = ind;
+      }
+    }
+  }
+
+  std::pair<eRank, eFile> CChessBoard::FindKing(bool forWhite) const
+  {
+    const SPieceList& pieces = m_pieceLists[forWhite ? 0 : 1];
+    for (uint8_t ind = 0; ind < pieces.m_count; ind++)
+    {
+      const uint8_t square = pieces.m_squares[ind];
+      if (PieceType(m_board[square]) == ePiece::king)
+      {
+        return std::pair(static_cast<eRank>(square / FILES), static_cast<eFile>(square % FILES));
       }
     }
+    DEBUG_ASSERT(false); // no king found, should never happen
+    return std::pair(eRank::_1, eFile::A);
+  }
+
+  void CChessBoard::Reset()
+  {
+    JC_PROFILE_ZONE("CChessBoard::Reset");
+    m_board = GetStartBoard();
 
     m_whiteKingPos = std::pair(eRank::_1, eFile::E);
     m_blackKingPos = std::pair(eRank::_8, eFile::E);
     m_enPassantPos.reset();
+    m_turnsWithoutPawn = 0;
+    m_plyCount = 0;
+    m_whiteToMove = true;
+    m_material = ComputeMaterial(m_board);
+    m_pawnKey = ComputePawnKey(m_board);
+    m_pieceKey = ComputePieceKey(m_board);
+    ComputePieceLists();
+
+    m_history.reset();
+    m_record.clear();
+    m_record.reserve(RECORD_CAPACITY);
+    InvalidateCaches();
+    CreateNextRecord();
+  }
 
-    m_removed.clear();
+  SPosition CChessBoard::Snapshot() const
+  {
+    SPosition position;
+    position.m_board = m_board;
+    position.m_enPassantSquare = m_enPassantPos.has_value() ?
+      SquareIndex(m_enPassantPos->first, m_enPassantPos->second) : NO_SQUARE;
+    position.m_whiteKingSquare = SquareIndex(m_whiteKingPos.first, m_whiteKingPos.second);
+    position.m_blackKingSquare = SquareIndex(m_blackKingPos.first, m_blackKingPos.second);
+    position.m_whiteToMove = m_whiteToMove;
+    position.m_turnsWithoutPawn = static_cast<uint16_t>(m_turnsWithoutPawn);
+    position.m_plyCount = static_cast<uint16_t>(m_plyCount);
+    position.m_pawnKey = m_pawnKey;
+    return position;
+  }
+
+  CChessBoard::history_t CChessBoard::GetHistory() const
+  {
+    // only views since the last pawn move can be repeated
+    auto history = std::make_shared<record_t>();
+    const std::size_t historySize = m_history ? m_history->size() : 0;
+    const std::size_t count = std::min(m_turnsWithoutPawn, m_record.size() - 1 + historySize);
+    history->reserve(count);
+    for (std::size_t ind = count; ind >= 1; ind--)
+    {
+      history->push_back(ind < m_record.size() ?
+        m_record[m_record.size() - 1 - ind] :
+        (*m_history)[historySize - 1 - (ind - m_record.size())]);
+    }
+    return history;
+  }
+
+  void CChessBoard::Restore(const SPosition& position, history_t history)
+  {
+    m_board = position.m_board;
+    m_enPassantPos.reset();
+    if (position.m_enPassantSquare != NO_SQUARE)
+    {
+      m_enPassantPos = std::pair(static_cast<eRank>(position.m_enPassantSquare / FILES),
+                                 static_cast<eFile>(position.m_enPassantSquare % FILES));
+    }
+    m_whiteKingPos = std::pair(static_cast<eRank>(position.m_whiteKingSquare / FILES),
+                               static_cast<eFile>(position.m_whiteKingSquare % FILES));
+    m_blackKingPos = std::pair(static_cast<eRank>(position.m_blackKingSquare / FILES),
+                               static_cast<eFile>(position.m_blackKingSquare % FILES));
+    m_whiteToMove = position.m_whiteToMove;
+    m_turnsWithoutPawn = position.m_turnsWithoutPawn;
+    m_plyCount = position.m_plyCount;
+    m_material = ComputeMaterial(m_board);
+    m_pawnKey = ComputePawnKey(m_board);
+    m_pieceKey = ComputePieceKey(m_board);
+    ComputePieceLists();
+    DEBUG_ASSERT(FindKing(true) == m_whiteKingPos && FindKing(false) == m_blackKingPos);
+
+    m_history = std::move(history);
     m_record.clear();
+    m_record.reserve(RECORD_CAPACITY);
+    InvalidateCaches();
     CreateNextRecord();
   }
 
@@ -444,7 +834,7 @@ namespace JC
       std::cout << "\n " << rank + 1 << " | ";
       for (int file = 0; file < FILES; file++)
       {
-        std::cout << PieceCharRep(m_board[rank][file]) << " | ";
+        std::cout << PieceCharRep(m_board[SquareIndex(rank, file)]) << " | ";
       }
       std::cout << "\n   +---+---+---+---+---+---+---+---+";
     }
@@ -481,8 +871,8 @@ namespace JC
     }
     if (uind >= m_record.size())
     {
-      m_logger->Error("Index " + std::to_string(uind) + " exceeds number of records (" +
-        std::to_string(m_record.size()) + ")", __FILE__, __LINE__);
+      JC_LOG_ERROR(m_logger, "Index " + std::to_string(uind) + " exceeds number of records (" +
+        std::to_string(m_record.size()) + ")");
       return;
     }
     std::cout << "   +---+---+---+---+---+---+---+---+";
@@ -492,63 +882,60 @@ namespace JC
       std::cout << "\n " << rank + 1 << " | ";
       for (int file = 0; file < FILES; file++)
       {
-        std::cout << s_charRepMap.at(m_record[uind][rank][file]) << " | ";
+        std::cout << PieceCharRep(m_record[uind][SquareIndex(rank, file)]) << " | ";
       }
       std::cout << "\n   +---+---+---+---+---+---+---+---+";
     }
     std::cout << "\n     A   B   C   D   E   F   G   H" << std::endl;
   }
 
-  std::unique_ptr<JC::CChessPiece> CChessBoard::CreatePiece(ePiece type, bool isWhite)
+  const CChessBoard::board_t& CChessBoard::GetStartBoard()
   {
-    switch (type)
+    static const board_t s_startBoard = []()
     {
-    case ePiece::pawn:
-      return std::make_unique<CPawn>(isWhite);
-    case ePiece::rook:
-      return std::make_unique<CRook>(isWhite);
-    case ePiece::knight:
-      return std::make_unique<CKnight>(isWhite);
-    case ePiece::bishop:
-      return std::make_unique<CBishop>(isWhite);
-    case ePiece::queen:
-      return std::make_unique<CQueen>(isWhite);
-    case ePiece::king:
-      return std::make_unique<CKing>(isWhite);
-    default:
-      return nullptr;
-    }
+      board_t board;
+      board.fill(NO_PIECE);
+      for (auto type : PIECES)
+      {
+        for (bool isWhite : {true, false})
+        {
+          for (const auto& pos : CChessPiece::GetStartPositions(type, isWhite))
+          {
+            auto [rank, file] = pos;
+            board[SquareIndex(rank, file)] = PackPiece(type, isWhite);
+          }
+        }
+      }
+      return board;
+    }();
+    return s_startBoard;
   }
 
   void CChessBoard::CreateNextRecord()
   {
-    view_t view;
-    view.resize(RANKS);
-    for (int rank = 0; rank < RANKS; rank++)
-    {
-      view[rank].resize(FILES);
-      for (int file = 0; file < FILES; file++)
+    JC_PROFILE_ZONE("CChessBoard::CreateNextRecord");
+    JC_TRACE_SCOPE("CChessBoard::CreateNextRecord");
+    // the moved flags are not part of the view, so equal positions have equal views
+    view_t& view = m_record.emplace_back();
+    view.fill(NO_PIECE);
+    for (const SPieceList& pieces : m_pieceLists)
+    {
+      for (uint8_t ind = 0; ind < pieces.m_count; ind++)
       {
-        view[rank][file] = m_board[rank][file] ? 
-        std::pair(m_board[rank][file]->GetType(), m_board[rank][file]->IsWhite()) :
-        std::pair(ePiece::none, true);
+        const uint8_t square = pieces.m_squares[ind];
+        view[square] = m_board[square] & ~PIECE_MOVED_BIT;
       }
     }
-    m_record.push_back(view);
   }
 
-  char CChessBoard::PieceCharRep(const std::unique_ptr<CChessPiece>& pPiece) const
+  char CChessBoard::PieceCharRep(packedpiece_t piece) const
   {
-    if (pPiece)
-      return s_charRepMap.at(std::pair(pPiece->GetType(), pPiece->IsWhite()));
-    else
-      return s_charRepMap.at(std::pair(ePiece::none, true));
+    return s_charRepMap.at(std::pair(PieceType(piece), PieceIsWhite(piece)));
   }
 
-  bool CChessBoard::IsCheckedPieceDirection(ePiece pieceDir, bool forWhite) const
+  template<bool White>
+  bool CChessBoard::IsCheckedPieceDirection(const view_t& boardView, std::pair<eRank, eFile> kingPos, ePiece pieceDir)
   {
-    const auto& kingPos = forWhite ? m_whiteKingPos : m_blackKingPos;
-
     bool bishopOrRook = (pieceDir == ePiece::bishop || pieceDir == ePiece::rook);
 
     int newRank;
@@ -568,16 +955,17 @@ namespace JC
           break; // outside of the board
         }
         // check if piece is in the way
-        if (m_record.back()[newRank][newFile].first != ePiece::none)
+        const packedpiece_t piece = boardView[SquareIndex(newRank, newFile)];
+        if (piece != NO_PIECE)
         {
           // break if own piece is in the way
-          if (m_record.back()[newRank][newFile].second == forWhite)
+          if (PieceIsWhite(piece) == White)
           {
             break;
           }
           // check if current piece (or queen) is in the way
-          if (m_record.back()[newRank][newFile].first == pieceDir ||
-              (bishopOrRook && m_record.back()[newRank][newFile].first == ePiece::queen))
+          if (PieceType(piece) == pieceDir ||
+              (bishopOrRook && PieceType(piece) == ePiece::queen))
           {
             return true;
           }
@@ -589,44 +977,32 @@ namespace JC
     return false;
   }
 
-  bool CChessBoard::WouldBeCheckedAfterMove(eRank fromRank, eFile fromFile, 
-    eRank toRank, eFile toFile, bool forWhite) const
+  template<bool White>
+  bool CChessBoard::WouldBeCheckedAfterMove(eRank fromRank, eFile fromFile, eRank toRank, eFile toFile) const
   {
-    bool wouldBeChecked;
+    JC_PROFILE_ZONE(White ? "CChessBoard::WouldBeCheckedAfterMove<white>" : "CChessBoard::WouldBeCheckedAfterMove<black>");
 
-    // change current board view
-    piece_t pieceCopy = m_record.back()[_UINT8(toRank)][_UINT8(toFile)];
-    m_record.back()[_UINT8(toRank)][_UINT8(toFile)] = m_record.back()[_UINT8(fromRank)][_UINT8(fromFile)];
-    m_record.back()[_UINT8(fromRank)][_UINT8(fromFile)] = std::pair(ePiece::none, true);
+    // do the move on a copy of the current board view, so the board itself
+    // is not touched and concurrent queries do not interfere
+    view_t view = m_record.back();
+    const uint8_t fromInd = SquareIndex(fromRank, fromFile);
+    const uint8_t toInd = SquareIndex(toRank, toFile);
+    const packedpiece_t captured = view[toInd];
+    view[toInd] = view[fromInd];
+    view[fromInd] = NO_PIECE;
 
-    if (m_record.back()[_UINT8(toRank)][_UINT8(toFile)].first == ePiece::king)
+    // pawn moving diagonally to an empty square captures en passant
+    if (PieceType(view[toInd]) == ePiece::pawn && fromFile != toFile && captured == NO_PIECE)
     {
-      auto& refKingPos = forWhite ? m_whiteKingPos : m_blackKingPos;
-      refKingPos.first = toRank;
-      refKingPos.second = toFile;
-      wouldBeChecked = IsChecked(forWhite);
-      refKingPos.first = fromRank;
-      refKingPos.second = fromFile;
+      view[SquareIndex(fromRank, toFile)] = NO_PIECE;
     }
-    else
-    {
-      wouldBeChecked = IsChecked(forWhite);
-    }
-    // undo changed board view
-    m_record.back()[_UINT8(fromRank)][_UINT8(fromFile)] = m_record.back()[_UINT8(toRank)][_UINT8(toFile)];
-    m_record.back()[_UINT8(toRank)][_UINT8(toFile)] = pieceCopy;
-    
-    return wouldBeChecked;
-  }
 
-  std::size_t CChessBoard::CountBoolMat(const boolmat_t& boolMat) const
-  {
-    std::size_t count = 0;
-    for (const auto& vec : boolMat)
+    auto kingPos = KingPos<White>();
+    if (PieceType(view[toInd]) == ePiece::king)
     {
-      count += std::count(vec.begin(), vec.end(), true);
+      kingPos = std::pair(toRank, toFile);
     }
-    return count;
+    return IsCheckedInView<White>(view, kingPos, KingPos<!White>());
   }
 
 }
@@ -9,43 +9,115 @@
 #define RANKS 8
 #define FILES 8
 
-#include "Logger/Logger.h"
+#include "Logger/LogMacros.h"
+#include "Functional/ChessPieces/ChessPiece.h"
+#include "Functional/Attacks/Attacks.h"
 
 namespace JC
 {
-  class CChessPiece;
+  /// @brief Move of a chess piece from one square to another
+  struct SMove
+  {
+    eRank m_fromRank;
+    eFile m_fromFile;
+    eRank m_toRank;
+    eFile m_toFile;
+  };
+
+  /// @brief Square index for "no square" (e.g. no en passant capture possible)
+  constexpr uint8_t NO_SQUARE = 0xFF;
+  /// @brief Maximum number of pieces of one color on a board
+  constexpr std::size_t MAX_PIECES = 16;
+
+  /// @brief Trivially copyable position of a chess board, see @c CChessBoard::Snapshot().
+  /// Contains everything needed to continue the game except the record of former positions.
+  struct SPosition
+  {
+    /// @brief Packed chess pieces, index is @c SquareIndex(rank, file)
+    std::array<packedpiece_t, RANKS * FILES> m_board;
+    /// @brief Square to capture en passant or @c NO_SQUARE
+    uint8_t m_enPassantSquare;
+    uint8_t m_whiteKingSquare;
+    uint8_t m_blackKingSquare;
+    bool m_whiteToMove;
+    /// @brief Number of turns since the last pawn move or capture (fifty-move rule)
+    uint16_t m_turnsWithoutPawn;
+    /// @brief Number of moves since the start position
+    uint16_t m_plyCount;
+    /// @brief Hash of the pawns only, see @c CChessBoard::GetPawnKey()
+    uint64_t m_pawnKey;
+  };
 
   class CChessBoard
   {
   public:
+    /// @brief Board views of former positions, see @c Snapshot()
+    using history_t = std::shared_ptr<const std::vector<std::array<packedpiece_t, RANKS * FILES>>>;
+
     CChessBoard(Logger logger)
       : m_logger(logger)
       , m_whiteKingPos()
       , m_blackKingPos()
       , m_enPassantPos(std::nullopt)
       , m_turnsWithoutPawn(0)
-      , m_whiteRookAtQueenSideMoved(false)
-      , m_whiteRookAtKingSideMoved(false)
-      , m_whiteKingMoved(false)
-      , m_blackRookAtQueenSideMoved(false)
-      , m_blackRookAtKingSideMoved(false)
-      , m_blackKingMoved(false)
-    {}
+      , m_plyCount(0)
+      , m_whiteToMove(true)
+      , m_material(0)
+      , m_pawnKey(0)
+      , m_pieceKey(0)
+      , m_pieceLists()
+    {
+      m_board.fill(NO_PIECE);
+      m_pieceListIndex.fill(NO_SQUARE);
+    }
+    /// @brief Creates a board at the position of a snapshot, see @c Restore().
+    CChessBoard(Logger logger, const SPosition& position, history_t history = nullptr)
+      : CChessBoard(logger)
+    {
+      Restore(position, std::move(history));
+    }
     virtual ~CChessBoard() = default;
 
-    using board_t = std::vector<std::vector<std::unique_ptr<CChessPiece>>>;
-    using removed_t = std::vector<std::unique_ptr<CChessPiece>>;
+    /// @brief Flat array of packed chess pieces, index is @c SquareIndex(rank, file)
+    using board_t = std::array<packedpiece_t, RANKS * FILES>;
     using boolmat_t = std::vector<std::vector<bool>>;
     using intmat_t = std::vector<std::vector<int>>;
     using piece_t = std::pair<ePiece, bool>; /// type and color of chess piece
-    using view_t = std::vector<std::vector<piece_t>>;
+    /// @brief Board without the moved flags (only type and color of the pieces)
+    using view_t = board_t;
+    static_assert(std::is_trivially_copyable_v<SPosition>);
     using record_t = std::vector<view_t>;
 
     piece_t GetPieceType(eRank rank, eFile file) const;
-    boolmat_t GetValidMoves(eRank rank, eFile file, bool forWhite) const;
+    /// @brief Facade object of the chess piece at a square.
+    /// @return chess piece or @c std::nullopt if the square is empty
+    std::optional<CChessPiece> GetPiece(eRank rank, eFile file) const;
+    /// @return all squares of the board
+    const board_t& GetBoard() const { return m_board; }
+
+    /// @brief Valid moves of the piece at a square.
+    /// The valid moves of all pieces of a color are computed on the first query
+    /// of a position and cached until the next @c Move(), @c Reset() or @c Restore().
+    /// Does not allocate memory.
+    /// @return squares the piece can move to (bit @c SquareIndex(rank, file))
+    bitboard_t GetValidMoves(eRank rank, eFile file, bool forWhite) const;
+
+    /// @brief Converts squares to a matrix indexed by rank and file, e.g. for @c PrintBoolMat().
+    /// @param squares bit @c SquareIndex(rank, file) per square (see @c GetValidMoves())
+    static boolmat_t ToBoolMat(bitboard_t squares);
+
+    /// @brief Collects the valid moves of all pieces of one color (from the cache).
+    /// @param forWhite
+    /// @param moves valid moves are appended
+    void GetAllValidMoves(bool forWhite, std::vector<SMove>& moves) const;
+
+    /// @return number of valid moves of all pieces of one color (from the cache)
+    std::size_t CountValidMoves(bool forWhite) const;
 
     /// @brief Check if white or black is checked. 
     /// Makes use of last board view in records.
+    /// Like all const queries, it does not modify the board, so any number of
+    /// threads can query the same board concurrently (as long as no thread moves).
     /// @param forWhite
     /// @return @c true if specified color is checked.
     bool IsChecked(bool forWhite) const;
@@ -60,23 +132,65 @@ namespace JC
     bool Move(eRank fromRank, eFile fromFile, eRank toRank, eFile toFile, bool forWhite);
 
     /// @brief Check if castling is possible for either black or white.
+    /// King and rook must not have moved yet.
     /// @param forWhite for white or black
     /// @param queenSide for queen side or king side
     /// @return @c true if castling is possible.
     bool CanCastle(bool forWhite, bool forQueenSide) const;
 
-    //intmat_t GetFieldsAttacked(bool byWhite);
+    /// @brief All squares attacked by the pieces of one color (whether the
+    /// attacking piece is pinned or not), computed without lookup tables.
+    /// @param byWhite color of the attacking pieces
+    /// @return attacked squares (bit @c SquareIndex(rank, file))
+    bitboard_t GetAttackedSquares(bool byWhite) const;
     //void PromotePawn(eRank rank, eFile file, ePiece pieceType);
     
     /// @brief State (checkmate or stalemate)
     eState CheckmateState(bool forWhite) const;
-    
-    //bool MaterialInsufficient();
-    bool ThreefoldRepetition();
-    bool DueFiftyMovesRule();
+
+    /// @brief Neither side can checkmate anymore: only kings and at most one
+    /// knight or bishop, or only bishops which are all on squares of the same color.
+    /// Uses the material signature updated in @c Move().
+    bool MaterialInsufficient() const;
+    bool ThreefoldRepetition() const;
+    bool DueFiftyMovesRule() const;
+
+    /// @brief Status of the game for the side to move, combining checkmate,
+    /// stalemate, insufficient material, threefold repetition and fifty-move rule
+    /// (in this order). The search for valid moves stops at the first one found.
+    /// The result is cached until the position changes.
+    eGameStatus GetGameStatus() const;
 
     /// @brief Reset the chess board.
     void Reset();
+
+    /// @brief Current position as a small, trivially copyable object.
+    /// Copying it to other threads is cheap; use @c Restore() or the
+    /// constructor to continue from it.
+    SPosition Snapshot() const;
+
+    /// @brief Board views since the last pawn move (without the current one).
+    /// Pass it to @c Restore() if threefold repetitions have to be detected
+    /// after restoring. The history is immutable, so one instance can be shared
+    /// by any number of boards.
+    history_t GetHistory() const;
+
+    /// @brief Continue from a position taken by @c Snapshot().
+    /// @param position
+    /// @param history Former board views shared with other boards (see @c GetHistory()),
+    /// or @c nullptr to truncate the history at the restored position
+    void Restore(const SPosition& position, history_t history = nullptr);
+
+    /// @return @c true if white has to do the next move
+    bool IsWhiteToMove() const { return m_whiteToMove; }
+    /// @brief Hash of the pawns of both colors (xor of @c PawnKey() of all pawns).
+    /// Updated by @c Move() only if a pawn moves or is captured, so it can be
+    /// used to cache pawn structure evaluations.
+    uint64_t GetPawnKey() const { return m_pawnKey; }
+    /// @brief Hash of the position: pieces (with castling rights), side to move and
+    /// en passant file if a capture is possible there. Equal positions have equal keys.
+    /// The piece part is updated incrementally by @c Move().
+    uint64_t GetPositionKey() const;
     void PrintCurrentBoard();
     void PrintBoolMat(boolmat_t boolmat);
 
@@ -85,45 +199,148 @@ namespace JC
     void PrintRecord(int ind);
     void CreateNextRecord();
 
-    static std::unique_ptr<CChessPiece> CreatePiece(ePiece type, bool isWhite);
+    /// @return board with all pieces at their start positions
+    static const board_t& GetStartBoard();
 
   private:
+    /// @brief Board views reserved by @c Reset() and @c Restore(), so @c Move()
+    /// does not allocate memory during games of up to this length
+    static constexpr std::size_t RECORD_CAPACITY = 256;
+    /// @brief Xor-ed into the position hash key if black is to move
+    static constexpr uint64_t BLACK_TO_MOVE_KEY = 0xF1E2D3C4B5A69788ull;
+
+    /// @brief Valid moves of all pieces of one color in the current position.
+    /// Copies start empty, so boards stay copyable.
+    struct SMoveCache
+    {
+      SMoveCache() = default;
+      SMoveCache(const SMoveCache&) {}
+      SMoveCache& operator=(const SMoveCache&)
+      {
+        m_valid.store(false, std::memory_order_relaxed);
+        m_status.store(NO_STATUS, std::memory_order_relaxed);
+        return *this;
+      }
+
+      static constexpr uint8_t NO_STATUS = 0xFF;
+
+      /// @brief Destination squares per square of origin (bit @c SquareIndex(rank, file))
+      std::array<uint64_t, RANKS * FILES> m_destinations;
+      std::size_t m_count = 0;
+      /// @brief Set (release) after the cache was filled, cleared by @c InvalidateCaches()
+      std::atomic<bool> m_valid = false;
+      /// @brief Game status if this color is to move, or @c NO_STATUS
+      std::atomic<uint8_t> m_status = NO_STATUS;
+      /// @brief Serializes filling if several threads query the same position
+      std::mutex m_mutex;
+    };
+
     Logger m_logger;
     board_t m_board;
-    removed_t m_removed;
     /// @brief Record of all board views.
-    mutable record_t m_record;
-    mutable std::size_t m_turnsWithoutPawn;
+    record_t m_record;
+    std::size_t m_turnsWithoutPawn;
 
     /// @brief Save white king position for faster access
-    mutable std::pair<eRank, eFile> m_whiteKingPos;
+    std::pair<eRank, eFile> m_whiteKingPos;
     /// @brief Save black king position for faster access
-    mutable std::pair<eRank, eFile> m_blackKingPos;
+    std::pair<eRank, eFile> m_blackKingPos;
     /// @brief Remember position to capture en passant
     std::optional<std::pair<eRank, eFile>> m_enPassantPos;
+    /// @brief Number of moves since the start position
+    std::size_t m_plyCount;
+    bool m_whiteToMove;
+    /// @brief Board views before the first record of a restored board
+    history_t m_history;
+    /// @brief Material of both colors, updated by @c Move() on captures
+    material_t m_material;
+    /// @brief Pawn hash key, updated by @c Move() on pawn moves and pawn captures
+    uint64_t m_pawnKey;
+    /// @brief Xor of @c PieceKey() of all squares, updated by @c SetSquare() and @c MovePiece()
+    uint64_t m_pieceKey;
+    /// @brief Cached valid moves of white (index 0) and black (index 1)
+    mutable std::array<SMoveCache, 2> m_moveCache;
 
-    bool m_whiteRookAtQueenSideMoved;
-    bool m_whiteRookAtKingSideMoved;
-    bool m_whiteKingMoved;
+    /// @brief Squares of the pieces of one color, in no particular order
+    struct SPieceList
+    {
+      std::array<uint8_t, MAX_PIECES> m_squares;
+      uint8_t m_count = 0;
+    };
+    /// @brief Pieces of white (index 0) and black (index 1), updated by @c SetSquare() and @c MovePiece(),
+    /// so whole-side operations do not have to scan all squares
+    std::array<SPieceList, 2> m_pieceLists;
+    /// @brief Position of the piece at a square in the list of its color, or @c NO_SQUARE if empty
+    std::array<uint8_t, RANKS * FILES> m_pieceListIndex;
 
-    bool m_blackRookAtQueenSideMoved;
-    bool m_blackRookAtKingSideMoved;
-    bool m_blackKingMoved;
+    /// @brief Valid moves of one color, computed on the first call per position.
+    /// Thread-safe: concurrent callers wait for the first one filling the cache.
+    const SMoveCache& GetMoveCache(bool forWhite) const;
+    /// @brief Clears the cached moves and game status; has to be called whenever the position changes.
+    void InvalidateCaches();
+    /// @brief Fills the move cache of one color.
+    template<bool White>
+    void FillMoveCache(SMoveCache& cache) const;
+    /// @brief Checks if one color has at least one valid move (stops at the first one found).
+    bool HasValidMove(bool forWhite) const;
+    template<bool White>
+    bool HasValidMove() const;
+    /// @return material signature of a board
+    static material_t ComputeMaterial(const board_t& board);
+    /// @return pawn hash key of a board
+    static uint64_t ComputePawnKey(const board_t& board);
+    /// @return xor of @c PieceKey() of all squares of a board
+    static uint64_t ComputePieceKey(const board_t& board);
+    /// @brief Puts a piece (or @c NO_PIECE) on a square and updates @c m_pieceKey and the piece lists.
+    void SetSquare(uint8_t ind, packedpiece_t piece);
+    /// @brief Moves a piece (capturing a piece at the destination) and sets its moved flag.
+    /// Updates @c m_pieceKey and the piece lists in O(1).
+    void MovePiece(uint8_t fromInd, uint8_t toInd);
+    /// @brief Rebuilds the piece lists from @c m_board (after @c Reset() and @c Restore()).
+    void ComputePieceLists();
+    /// @brief Computes the valid moves of the piece at a square (without the cache).
+    /// Move generation, check detection and castling are templated on the color,
+    /// so directions and ranks are constants; the public functions dispatch once.
+    /// @return destination squares (bit @c SquareIndex(rank, file))
+    template<bool White>
+    uint64_t GenerateValidMoves(eRank rank, eFile file) const;
+    template<bool White, bool QueenSide>
+    bool CanCastle() const;
+    /// @return saved position of the king of one color
+    template<bool White>
+    const std::pair<eRank, eFile>& KingPos() const
+    {
+      if constexpr (White)
+      {
+        return m_whiteKingPos;
+      }
+      else
+      {
+        return m_blackKingPos;
+      }
+    }
 
-    /// @brief Returns current position of white or black king
-    /// @param boardView 
+    /// @brief Returns current position of white or black king (from the piece list)
     /// @param forWhite 
     /// @return position: rank, file
-    std::pair<eRank, eFile> FindKing(const view_t& boardView, bool forWhite) const;
-
-    /// @brief Counts the number of 'true' elements in a boolean matrix
-    /// @param boolMat vector of vector of booleans
-    /// @return count of true elements
-    std::size_t CountBoolMat(const boolmat_t& boolMat) const;
+    std::pair<eRank, eFile> FindKing(bool forWhite) const;
 
-    char PieceCharRep(const std::unique_ptr<CChessPiece>& pPiece) const;
-    bool IsCheckedPieceDirection(ePiece pieceDir, bool forWhite) const;
-    bool WouldBeCheckedAfterMove(eRank fromRank, eFile fromFile, eRank toRank, eFile toFile, bool forWhite) const;
+    char PieceCharRep(packedpiece_t piece) const;
+    /// @brief Check detection on any board view (e.g. a local copy).
+    /// @param boardView
+    /// @param kingPos position of the king to check
+    /// @param oppKingPos position of the opponent's king
+    /// @tparam White color of the king to check
+    /// @return @c true if the king is checked
+    template<bool White>
+    static bool IsCheckedInView(const view_t& boardView, std::pair<eRank, eFile> kingPos,
+      std::pair<eRank, eFile> oppKingPos);
+    template<bool White>
+    static bool IsCheckedPieceDirection(const view_t& boardView, std::pair<eRank, eFile> kingPos, ePiece pieceDir);
+    /// @brief Check if the king would be checked after a move.
+    /// The move is done on a local copy of the current board view.
+    template<bool White>
+    bool WouldBeCheckedAfterMove(eRank fromRank, eFile fromFile, eRank toRank, eFile toFile) const;
 
   };
 }
@@ -1,8 +1,12 @@
 #pragma once
 
+#include "PackedPiece.h"
+
 namespace JC
 {
-  /// @brief Base class for all chess pieces
+  /// @brief Base class for all chess pieces.
+  /// The chess board stores pieces as @c packedpiece_t; this class is a facade
+  /// for code which prefers an object per chess piece.
   class CChessPiece
   {
   public:
@@ -12,6 +16,14 @@ namespace JC
       , m_moveCount(0)
     {
     };
+    /// @brief Creates the facade of a packed chess piece.
+    /// The move count is 1 if the piece has moved, since the packed piece only keeps a flag.
+    explicit CChessPiece(packedpiece_t piece)
+      : m_type(PieceType(piece))
+      , m_isWhite(PieceIsWhite(piece))
+      , m_moveCount(PieceHasMoved(piece) ? 1 : 0)
+    {
+    };
     virtual ~CChessPiece() = default;
 
     /// @brief
@@ -25,6 +37,8 @@ namespace JC
     uint16_t GetMoveCount() const { return m_moveCount; }
     /// @brief 
     void IncrementMoveCount();
+    /// @return chess piece packed into one byte
+    packedpiece_t Pack() const { return PackPiece(m_type, m_isWhite, m_moveCount > 0); }
     /// @brief 
     /// @return all possible directions this piece can move
     const vecPairRankFile_t& GetMoveDirs() const;
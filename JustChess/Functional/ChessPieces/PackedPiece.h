@@ -0,0 +1,130 @@
+#pragma once
+
+namespace JC
+{
+  /// @brief Chess piece packed into one byte:
+  /// bits 0-2 type (@c ePiece), bit 3 color (set for white), bit 4 has moved.
+  /// An empty square is @c NO_PIECE.
+  using packedpiece_t = uint8_t;
+
+  constexpr packedpiece_t NO_PIECE = 0x00;
+  constexpr packedpiece_t PIECE_TYPE_MASK = 0x07;
+  constexpr packedpiece_t PIECE_WHITE_BIT = 0x08;
+  constexpr packedpiece_t PIECE_MOVED_BIT = 0x10;
+
+  /// @brief Packs type, color and moved flag of a chess piece into one byte
+  constexpr packedpiece_t PackPiece(ePiece type, bool isWhite, bool hasMoved = false)
+  {
+    return static_cast<packedpiece_t>(_UINT8(type) |
+      (isWhite ? PIECE_WHITE_BIT : 0) | (hasMoved ? PIECE_MOVED_BIT : 0));
+  }
+
+  /// @return type of the packed chess piece (@c ePiece::none for an empty square)
+  constexpr ePiece PieceType(packedpiece_t piece)
+  {
+    return static_cast<ePiece>(piece & PIECE_TYPE_MASK);
+  }
+
+  /// @return @c true if the packed chess piece is white
+  constexpr bool PieceIsWhite(packedpiece_t piece)
+  {
+    return (piece & PIECE_WHITE_BIT) != 0;
+  }
+
+  /// @return @c true if the packed chess piece has already moved
+  constexpr bool PieceHasMoved(packedpiece_t piece)
+  {
+    return (piece & PIECE_MOVED_BIT) != 0;
+  }
+
+  /// @return index of a square in a flat board array (rank * 8 + file)
+  constexpr uint8_t SquareIndex(eRank rank, eFile file)
+  {
+    return static_cast<uint8_t>(_UINT8(rank) * 8 + _UINT8(file));
+  }
+
+  constexpr uint8_t SquareIndex(int rank, int file)
+  {
+    return static_cast<uint8_t>(rank * 8 + file);
+  }
+
+  /// @return mask with the bit of a square set (bit index is @c SquareIndex(rank, file))
+  constexpr uint64_t SquareBit(eRank rank, eFile file)
+  {
+    return uint64_t(1) << SquareIndex(rank, file);
+  }
+
+  constexpr uint64_t SquareBit(int rank, int file)
+  {
+    return uint64_t(1) << SquareIndex(rank, file);
+  }
+
+  /// @brief Material signature: count of each piece type and color in 4 bits,
+  /// nibble index is type + 8 for white. Nibble 7 (+ 8 for white) counts the
+  /// bishops on light squares, which matters for insufficient material.
+  using material_t = uint64_t;
+
+  /// @return number of pieces of a type and color in a material signature
+  constexpr uint8_t MaterialCount(material_t material, ePiece type, bool isWhite)
+  {
+    return static_cast<uint8_t>((material >> (4 * (_UINT8(type) + (isWhite ? 8 : 0)))) & 0x0F);
+  }
+
+  /// @return number of bishops of a color on light squares in a material signature
+  constexpr uint8_t MaterialLightBishops(material_t material, bool isWhite)
+  {
+    return static_cast<uint8_t>((material >> (4 * (7 + (isWhite ? 8 : 0)))) & 0x0F);
+  }
+
+  /// @return value to add to (or subtract from) a material signature for a piece at a square
+  constexpr material_t MaterialKey(packedpiece_t piece, uint8_t square)
+  {
+    if (piece == NO_PIECE)
+    {
+      return 0;
+    }
+    const int colorShift = PieceIsWhite(piece) ? 32 : 0;
+    material_t key = material_t(1) << (4 * _UINT8(PieceType(piece)) + colorShift);
+    // a square is light if the sum of rank and file is odd
+    if (PieceType(piece) == ePiece::bishop && ((square / 8 + square % 8) & 1))
+    {
+      key += material_t(1) << (28 + colorShift);
+    }
+    return key;
+  }
+
+  /// @brief SplitMix64 finalizer: spreads the bits of a small number over 64 bits,
+  /// so hash keys need no random tables
+  constexpr uint64_t HashMix(uint64_t value)
+  {
+    uint64_t key = value * 0x9E3779B97F4A7C15ull;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+    return key ^ (key >> 31);
+  }
+
+  /// @brief Random-looking value of a pawn at a square for the pawn hash key
+  /// @return value to xor into the pawn hash key, 0 if the piece is no pawn
+  constexpr uint64_t PawnKey(packedpiece_t piece, uint8_t square)
+  {
+    if (PieceType(piece) != ePiece::pawn)
+    {
+      return 0;
+    }
+    return HashMix(uint64_t(square) + (PieceIsWhite(piece) ? 65 : 1));
+  }
+
+  /// @brief Random-looking value of a piece at a square for the position hash key.
+  /// The moved flag is included for kings and rooks only (castling rights).
+  /// @return value to xor into the position hash key, 0 for an empty square
+  constexpr uint64_t PieceKey(packedpiece_t piece, uint8_t square)
+  {
+    if (piece == NO_PIECE)
+    {
+      return 0;
+    }
+    const bool castlingPiece = PieceType(piece) == ePiece::king || PieceType(piece) == ePiece::rook;
+    const packedpiece_t code = castlingPiece ? piece : static_cast<packedpiece_t>(piece & ~PIECE_MOVED_BIT);
+    return HashMix((uint64_t(code) << 6 | square) + 0x100);
+  }
+}
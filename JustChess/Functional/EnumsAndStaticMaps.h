@@ -13,6 +13,18 @@ namespace JC
     eCheckmate,
     eStalemate
   };
+
+  /// @brief Status of a game for the side to move, see @c CChessBoard::GetGameStatus()
+  enum class eGameStatus : uint8_t
+  {
+    eOngoing = 0,
+    eInCheck,
+    eCheckmate,
+    eStalemate,
+    eThreefoldRepetition,
+    eFiftyMoves,
+    eInsufficientMaterial
+  };
   
   /// @brief Types of chess pieces
   enum class ePiece : uint8_t
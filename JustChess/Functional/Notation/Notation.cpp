@@ -0,0 +1,366 @@
+#include <stdafx.h>
+
+#include "Notation.h"
+
+namespace JC
+{
+  bool CharToChessRank(char rankChar, eRank& rank)
+  {
+    switch (rankChar)
+    {
+    case '1': rank = eRank::_1; break;
+    case '2': rank = eRank::_2; break;
+    case '3': rank = eRank::_3; break;
+    case '4': rank = eRank::_4; break;
+    case '5': rank = eRank::_5; break;
+    case '6': rank = eRank::_6; break;
+    case '7': rank = eRank::_7; break;
+    case '8': rank = eRank::_8; break;
+    default:
+      return false;
+    }
+    return true;
+  }
+
+  bool CharToChessFile(char fileChar, eFile& file)
+  {
+    switch (fileChar)
+    {
+    case 'A': file = eFile::A; break;
+    case 'a': file = eFile::A; break;
+    case 'B': file = eFile::B; break;
+    case 'b': file = eFile::B; break;
+    case 'C': file = eFile::C; break;
+    case 'c': file = eFile::C; break;
+    case 'D': file = eFile::D; break;
+    case 'd': file = eFile::D; break;
+    case 'E': file = eFile::E; break;
+    case 'e': file = eFile::E; break;
+    case 'F': file = eFile::F; break;
+    case 'f': file = eFile::F; break;
+    case 'G': file = eFile::G; break;
+    case 'g': file = eFile::G; break;
+    case 'H': file = eFile::H; break;
+    case 'h': file = eFile::H; break;
+    default:
+      return false;
+    }
+    return true;
+  }
+
+  bool ParseMove(std::string_view text, SMove& move)
+  {
+    return text.length() == 4 &&
+      CharToChessFile(text[0], move.m_fromFile) &&
+      CharToChessRank(text[1], move.m_fromRank) &&
+      CharToChessFile(text[2], move.m_toFile) &&
+      CharToChessRank(text[3], move.m_toRank);
+  }
+
+  bool ParseMoveList(std::string_view text, std::vector<SMove>& moves)
+  {
+    moves.clear();
+    std::size_t pos = 0;
+    while (pos < text.size())
+    {
+      if (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')
+      {
+        pos++;
+        continue;
+      }
+      const std::size_t end = std::min(text.find_first_of(" \t\r", pos), text.size());
+      SMove move;
+      if (!ParseMove(text.substr(pos, end - pos), move))
+      {
+        return false;
+      }
+      moves.push_back(move);
+      pos = end;
+    }
+    return true;
+  }
+
+  bool ParseSanMove(const CChessBoard& board, std::string_view text, SMove& move)
+  {
+    // check, mate and annotation marks are not needed to find the move
+    while (!text.empty() && std::strchr("+#!?", text.back()) != nullptr)
+    {
+      text.remove_suffix(1);
+    }
+    const bool white = board.IsWhiteToMove();
+    std::vector<SMove> validMoves;
+    board.GetAllValidMoves(white, validMoves);
+
+    SMove parsed;
+    if (ParseMove(text, parsed))
+    {
+      const auto found = std::find_if(validMoves.begin(), validMoves.end(), [&parsed](const SMove& valid)
+        {
+          return valid.m_fromRank == parsed.m_fromRank && valid.m_fromFile == parsed.m_fromFile &&
+            valid.m_toRank == parsed.m_toRank && valid.m_toFile == parsed.m_toFile;
+        });
+      if (found == validMoves.end())
+      {
+        return false;
+      }
+      move = parsed;
+      return true;
+    }
+
+    ePiece piece = ePiece::pawn;
+    std::optional<eFile> fromFile;
+    std::optional<eRank> fromRank;
+    const eRank homeRank = white ? eRank::_1 : eRank::_8;
+    if (text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0")
+    {
+      // castling is a king move of two files
+      piece = ePiece::king;
+      fromFile = eFile::E;
+      fromRank = homeRank;
+      parsed.m_toRank = homeRank;
+      parsed.m_toFile = text.size() == 3 ? eFile::G : eFile::C;
+    }
+    else
+    {
+      if (text.size() < 2 || text.find('=') != std::string_view::npos)
+      {
+        return false;
+      }
+      switch (text.front())
+      {
+      case 'N': piece = ePiece::knight; break;
+      case 'B': piece = ePiece::bishop; break;
+      case 'R': piece = ePiece::rook; break;
+      case 'Q': piece = ePiece::queen; break;
+      case 'K': piece = ePiece::king; break;
+      default: break;
+      }
+      if (piece != ePiece::pawn)
+      {
+        text.remove_prefix(1);
+      }
+      if (text.size() < 2 ||
+        !CharToChessFile(text[text.size() - 2], parsed.m_toFile) ||
+        !CharToChessRank(text.back(), parsed.m_toRank))
+      {
+        return false;
+      }
+      // what is left are disambiguation and capture mark, e.g. "a", "1", "a1", "x", "ax"
+      text.remove_suffix(2);
+      if (!text.empty() && text.back() == 'x')
+      {
+        text.remove_suffix(1);
+      }
+      for (const char disambiguation : text)
+      {
+        eFile file;
+        eRank rank;
+        if (!fromFile && std::islower(static_cast<unsigned char>(disambiguation)) &&
+          CharToChessFile(disambiguation, file))
+        {
+          fromFile = file;
+        }
+        else if (!fromRank && CharToChessRank(disambiguation, rank))
+        {
+          fromRank = rank;
+        }
+        else
+        {
+          return false;
+        }
+      }
+    }
+
+    std::size_t matches = 0;
+    for (const SMove& valid : validMoves)
+    {
+      if (valid.m_toRank == parsed.m_toRank && valid.m_toFile == parsed.m_toFile &&
+        (!fromFile || valid.m_fromFile == *fromFile) && (!fromRank || valid.m_fromRank == *fromRank) &&
+        board.GetPieceType(valid.m_fromRank, valid.m_fromFile).first == piece)
+      {
+        move = valid;
+        matches++;
+      }
+    }
+    return matches == 1;
+  }
+
+  bool ParseFen(std::string_view text, SPosition& position)
+  {
+    // split into the fields separated by white space
+    std::array<std::string_view, 6> fields;
+    std::size_t fieldCount = 0;
+    std::size_t pos = 0;
+    while (pos < text.size())
+    {
+      if (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')
+      {
+        pos++;
+        continue;
+      }
+      if (fieldCount == fields.size())
+      {
+        return false;
+      }
+      const std::size_t end = std::min(text.find_first_of(" \t\r", pos), text.size());
+      fields[fieldCount++] = text.substr(pos, end - pos);
+      pos = end;
+    }
+    if (fieldCount < 2 || (fields[1] != "w" && fields[1] != "b"))
+    {
+      return false;
+    }
+
+    position = SPosition{};
+    position.m_board.fill(NO_PIECE);
+    position.m_whiteToMove = fields[1] == "w";
+    int rank = RANKS - 1;
+    int file = 0;
+    int kings[2] = { 0, 0 };
+    std::size_t pieces[2] = { 0, 0 };
+    for (const char character : fields[0])
+    {
+      if (character == '/')
+      {
+        if (file != FILES || rank == 0)
+        {
+          return false;
+        }
+        rank--;
+        file = 0;
+        continue;
+      }
+      if (character >= '1' && character <= '8')
+      {
+        file += character - '0';
+        if (file > FILES)
+        {
+          return false;
+        }
+        continue;
+      }
+      const bool isWhite = std::isupper(static_cast<unsigned char>(character)) != 0;
+      ePiece type;
+      switch (std::tolower(static_cast<unsigned char>(character)))
+      {
+      case 'p': type = ePiece::pawn; break;
+      case 'r': type = ePiece::rook; break;
+      case 'n': type = ePiece::knight; break;
+      case 'b': type = ePiece::bishop; break;
+      case 'q': type = ePiece::queen; break;
+      case 'k': type = ePiece::king; break;
+      default:
+        return false;
+      }
+      if (file >= FILES)
+      {
+        return false;
+      }
+      const uint8_t square = SquareIndex(rank, file++);
+      // pawns off their start rank have moved; kings and rooks get their flag from the castling rights
+      const bool hasMoved = type == ePiece::king || type == ePiece::rook ||
+        (type == ePiece::pawn && rank != (isWhite ? 1 : RANKS - 2));
+      position.m_board[square] = PackPiece(type, isWhite, hasMoved);
+      pieces[isWhite ? 0 : 1]++;
+      if (type == ePiece::king)
+      {
+        kings[isWhite ? 0 : 1]++;
+        (isWhite ? position.m_whiteKingSquare : position.m_blackKingSquare) = square;
+      }
+    }
+    if (rank != 0 || file != FILES || kings[0] != 1 || kings[1] != 1 ||
+        pieces[0] > MAX_PIECES || pieces[1] > MAX_PIECES)
+    {
+      return false;
+    }
+
+    if (fieldCount > 2 && fields[2] != "-")
+    {
+      for (const char right : fields[2])
+      {
+        const bool isWhite = std::isupper(static_cast<unsigned char>(right)) != 0;
+        const int backRank = isWhite ? 0 : RANKS - 1;
+        const int rookFile = std::tolower(static_cast<unsigned char>(right)) == 'k' ? FILES - 1 :
+          (std::tolower(static_cast<unsigned char>(right)) == 'q' ? 0 : -1);
+        const uint8_t kingSquare = SquareIndex(backRank, _UINT8(eFile::E));
+        const uint8_t rookSquare = SquareIndex(backRank, rookFile < 0 ? 0 : rookFile);
+        if (rookFile < 0 ||
+            PieceType(position.m_board[kingSquare]) != ePiece::king || PieceIsWhite(position.m_board[kingSquare]) != isWhite ||
+            PieceType(position.m_board[rookSquare]) != ePiece::rook || PieceIsWhite(position.m_board[rookSquare]) != isWhite)
+        {
+          return false;
+        }
+        position.m_board[kingSquare] &= ~PIECE_MOVED_BIT;
+        position.m_board[rookSquare] &= ~PIECE_MOVED_BIT;
+      }
+    }
+
+    position.m_enPassantSquare = NO_SQUARE;
+    if (fieldCount > 3 && fields[3] != "-")
+    {
+      eFile epFile;
+      eRank epRank;
+      if (fields[3].size() != 2 || !CharToChessFile(fields[3][0], epFile) || !CharToChessRank(fields[3][1], epRank) ||
+          epRank != (position.m_whiteToMove ? eRank::_6 : eRank::_3))
+      {
+        return false;
+      }
+      position.m_enPassantSquare = SquareIndex(epRank, epFile);
+    }
+
+    int halfMoves = 0;
+    int fullMoves = 1;
+    try
+    {
+      if (fieldCount > 4)
+      {
+        halfMoves = std::stoi(std::string(fields[4]));
+      }
+      if (fieldCount > 5)
+      {
+        fullMoves = std::stoi(std::string(fields[5]));
+      }
+    }
+    catch (const std::exception&)
+    {
+      return false;
+    }
+    if (halfMoves < 0 || fullMoves < 1)
+    {
+      return false;
+    }
+    position.m_turnsWithoutPawn = static_cast<uint16_t>(halfMoves);
+    position.m_plyCount = static_cast<uint16_t>(2 * (fullMoves - 1) + (position.m_whiteToMove ? 0 : 1));
+    position.m_pawnKey = 0;
+    for (uint8_t square = 0; square < RANKS * FILES; square++)
+    {
+      position.m_pawnKey ^= PawnKey(position.m_board[square], square);
+    }
+    return true;
+  }
+
+  std::string MoveToString(const SMove& move)
+  {
+    std::string text(4, ' ');
+    text[0] = static_cast<char>('a' + _UINT8(move.m_fromFile));
+    text[1] = static_cast<char>('1' + _UINT8(move.m_fromRank));
+    text[2] = static_cast<char>('a' + _UINT8(move.m_toFile));
+    text[3] = static_cast<char>('1' + _UINT8(move.m_toRank));
+    return text;
+  }
+
+  const char* GameStatusToString(eGameStatus status)
+  {
+    switch (status)
+    {
+    case eGameStatus::eOngoing:               return "ongoing";
+    case eGameStatus::eInCheck:               return "check";
+    case eGameStatus::eCheckmate:             return "checkmate";
+    case eGameStatus::eStalemate:             return "stalemate";
+    case eGameStatus::eThreefoldRepetition:   return "threefold";
+    case eGameStatus::eFiftyMoves:            return "fifty-moves";
+    case eGameStatus::eInsufficientMaterial:  return "insufficient-material";
+    default:                                  return "unknown";
+    }
+  }
+}
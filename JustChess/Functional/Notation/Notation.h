@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Functional/ChessBoard/ChessBoard.h"
+
+namespace JC
+{
+  /// @brief Converts a rank character ('1' to '8') to a rank.
+  /// @return @c false if the character is not a rank
+  bool CharToChessRank(char rankChar, eRank& rank);
+
+  /// @brief Converts a file character ('a' to 'h', case insensitive) to a file.
+  /// @return @c false if the character is not a file
+  bool CharToChessFile(char fileChar, eFile& file);
+
+  /// @brief Parses a move in coordinate notation (e.g. "e2e4").
+  /// @param text four characters: from file, from rank, to file, to rank
+  /// @param move parsed move
+  /// @return @c false if the text is not a move in coordinate notation
+  bool ParseMove(std::string_view text, SMove& move);
+
+  /// @brief Parses moves in coordinate notation separated by white space (e.g. "e2e4 e7e5").
+  /// @param moves parsed moves (cleared first)
+  /// @return @c false if a word is not a move in coordinate notation
+  bool ParseMoveList(std::string_view text, std::vector<SMove>& moves);
+
+  /// @brief Parses a move of the side to move in standard algebraic notation
+  /// (e.g. "Nf3", "exd5", "Raxd1+", "O-O") or in coordinate notation.
+  /// The move is looked up in the valid moves of the board, so it is legal.
+  /// @param board position the move is played in
+  /// @param move parsed move
+  /// @return @c false if the text is no valid move or is ambiguous (also for promotions, which are not supported)
+  bool ParseSanMove(const CChessBoard& board, std::string_view text, SMove& move);
+
+  /// @brief Parses a position in Forsyth-Edwards Notation
+  /// (e.g. "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3").
+  /// Castling rights, en passant square and the move counters may be missing
+  /// (as in EPD); kings and rooks without castling rights are marked as moved.
+  /// @param position parsed position
+  /// @return @c false if the text is not a valid FEN, a side has not exactly one king or more than @c MAX_PIECES pieces
+  bool ParseFen(std::string_view text, SPosition& position);
+
+  /// @brief Returns the move in coordinate notation (e.g. "e2e4").
+  std::string MoveToString(const SMove& move);
+
+  /// @brief Returns a short name of the game status (e.g. "checkmate", "threefold").
+  const char* GameStatusToString(eGameStatus status);
+}
@@ -0,0 +1,168 @@
+#include <stdafx.h>
+
+#include "VariationTree.h"
+#include "..\..\Profiling\Profiler.h"
+
+namespace JC
+{
+  namespace
+  {
+    bool SameMove(const SMove& lhs, const SMove& rhs)
+    {
+      return lhs.m_fromRank == rhs.m_fromRank && lhs.m_fromFile == rhs.m_fromFile &&
+             lhs.m_toRank == rhs.m_toRank && lhs.m_toFile == rhs.m_toFile;
+    }
+
+    SPosition StartPosition(Logger logger)
+    {
+      CChessBoard board(logger);
+      board.Reset();
+      return board.Snapshot();
+    }
+  }
+
+  CVariationTree::CVariationTree(Logger logger)
+    : CVariationTree(logger, StartPosition(logger))
+  {}
+
+  CVariationTree::CVariationTree(Logger logger, const SPosition& root)
+    : m_logger(logger)
+    , m_board(logger, root)
+    , m_cursor(ROOT)
+  {
+    SNode node{};
+    node.m_parent = NO_NODE;
+    node.m_firstChild = NO_NODE;
+    node.m_nextSibling = NO_NODE;
+    node.m_snapshot = 0;
+    node.m_positionKey = m_board.GetPositionKey();
+    node.m_depth = 0;
+    node.m_turnsWithoutPawn = root.m_turnsWithoutPawn;
+    m_nodes.push_back(node);
+    m_snapshots.push_back(root);
+  }
+
+  std::optional<CVariationTree::node_t> CVariationTree::AddMove(node_t parent, const SMove& move)
+  {
+    JC_PROFILE_ZONE("CVariationTree::AddMove");
+    const node_t existing = FindChild(parent, move);
+    if (existing != NO_NODE)
+    {
+      m_statistics.m_existingChildren++;
+      return existing;
+    }
+    if (m_nodes.size() == NO_NODE || m_nodes[parent].m_depth == std::numeric_limits<uint16_t>::max())
+    {
+      JC_LOG_ERROR(m_logger, "Variation tree is full");
+      return std::nullopt;
+    }
+
+    MoveCursor(parent);
+    if (!m_board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, m_board.IsWhiteToMove()))
+    {
+      return std::nullopt;
+    }
+    const SPosition position = m_board.Snapshot();
+    const node_t child = static_cast<node_t>(m_nodes.size());
+
+    SNode node;
+    node.m_move = move;
+    node.m_parent = parent;
+    node.m_firstChild = NO_NODE;
+    node.m_nextSibling = m_nodes[parent].m_firstChild;
+    node.m_snapshot = NO_SNAPSHOT;
+    node.m_positionKey = m_board.GetPositionKey();
+    node.m_depth = static_cast<uint16_t>(m_nodes[parent].m_depth + 1);
+    node.m_turnsWithoutPawn = position.m_turnsWithoutPawn;
+    if (node.m_depth % SNAPSHOT_INTERVAL == 0)
+    {
+      node.m_snapshot = static_cast<uint32_t>(m_snapshots.size());
+      m_snapshots.push_back(position);
+    }
+    m_nodes.push_back(node);
+    m_nodes[parent].m_firstChild = child;
+    m_cursor = child;
+    m_statistics.m_addedNodes++;
+    return child;
+  }
+
+  CVariationTree::node_t CVariationTree::FindChild(node_t parent, const SMove& move) const
+  {
+    for (node_t child = m_nodes[parent].m_firstChild; child != NO_NODE; child = m_nodes[child].m_nextSibling)
+    {
+      if (SameMove(m_nodes[child].m_move, move))
+      {
+        return child;
+      }
+    }
+    return NO_NODE;
+  }
+
+  void CVariationTree::Materialize(node_t node, CChessBoard& board) const
+  {
+    JC_PROFILE_ZONE("CVariationTree::Materialize");
+    // moves from the nearest snapshot to the node, the last one first
+    std::array<SMove, SNAPSHOT_INTERVAL> moves;
+    std::size_t count = 0;
+    while (m_nodes[node].m_snapshot == NO_SNAPSHOT)
+    {
+      moves[count++] = m_nodes[node].m_move;
+      node = m_nodes[node].m_parent;
+    }
+    board.Restore(m_snapshots[m_nodes[node].m_snapshot]);
+    while (count > 0)
+    {
+      const SMove& move = moves[--count];
+      board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove());
+    }
+  }
+
+  void CVariationTree::GetLine(node_t node, std::vector<SMove>& moves) const
+  {
+    moves.clear();
+    moves.reserve(m_nodes[node].m_depth);
+    for (; node != ROOT; node = m_nodes[node].m_parent)
+    {
+      moves.push_back(m_nodes[node].m_move);
+    }
+    std::reverse(moves.begin(), moves.end());
+  }
+
+  bool CVariationTree::IsThreefoldRepetition(node_t node) const
+  {
+    // only positions since the last pawn move or capture can be repeated
+    const uint64_t key = m_nodes[node].m_positionKey;
+    int repetitions = 1;
+    node_t ancestor = node;
+    for (uint16_t ply = 0; ply < m_nodes[node].m_turnsWithoutPawn && ancestor != ROOT; ply++)
+    {
+      ancestor = m_nodes[ancestor].m_parent;
+      if (m_nodes[ancestor].m_positionKey == key && ++repetitions == 3)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::size_t CVariationTree::GetMemoryUsage() const
+  {
+    return m_nodes.capacity() * sizeof(SNode) + m_snapshots.capacity() * sizeof(SPosition);
+  }
+
+  void CVariationTree::MoveCursor(node_t node)
+  {
+    if (node == m_cursor)
+    {
+      m_statistics.m_cursorHits++;
+      return;
+    }
+    // the nearest snapshot is at the last depth which is a multiple of the interval
+    const uint16_t replayed = m_nodes[node].m_depth % SNAPSHOT_INTERVAL;
+    m_statistics.m_materializations++;
+    m_statistics.m_snapshotHits += replayed == 0 ? 1 : 0;
+    m_statistics.m_replayedMoves += replayed;
+    Materialize(node, m_board);
+    m_cursor = node;
+  }
+}
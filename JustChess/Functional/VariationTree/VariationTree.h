@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Functional/ChessBoard/ChessBoard.h"
+
+namespace JC
+{
+  /// @brief Counters of the boards set up by @c CVariationTree::AddMove()
+  struct SVariationTreeStatistics
+  {
+    /// @brief Calls of @c AddMove() which created a node
+    uint64_t m_addedNodes = 0;
+    /// @brief Calls of @c AddMove() which found an existing child
+    uint64_t m_existingChildren = 0;
+    /// @brief Created nodes whose parent was the node of the last added move (no board to set up)
+    uint64_t m_cursorHits = 0;
+    /// @brief Boards set up with @c Materialize()
+    uint64_t m_materializations = 0;
+    /// @brief Materializations at a node with a snapshot (no move to apply)
+    uint64_t m_snapshotHits = 0;
+    /// @brief Moves applied after restoring a snapshot
+    uint64_t m_replayedMoves = 0;
+
+    /// @return fraction of the materializations which were snapshot hits, 0 without materializations
+    double SnapshotHitRate() const
+    {
+      return m_materializations ? static_cast<double>(m_snapshotHits) / static_cast<double>(m_materializations) : 0.0;
+    }
+  };
+
+  /*!******************************************************************
+  * @class CVariationTree
+  *
+  * @brief Tree of the variations explored from a root position.
+  *
+  * @details Every node stores only the move leading to it and a few bytes of
+  * incremental state (position key, ply, turns without pawn move). Branches
+  * share the nodes of their common prefix, so the memory grows with the number
+  * of distinct moves explored, not with the number of branches times their
+  * length. Adding a move which already exists at a node returns the existing
+  * child.
+  *
+  * Every @c SNAPSHOT_INTERVAL plies a node additionally keeps a
+  * @c SPosition. A board at any node is materialized by restoring the
+  * snapshot of the nearest ancestor and applying at most
+  * @c SNAPSHOT_INTERVAL - 1 moves.
+  *
+  * Materialized boards have no history before the snapshot, so their
+  * @c CChessBoard::ThreefoldRepetition() only sees the last plies. Use
+  * @c IsThreefoldRepetition(), which compares the position keys of the
+  * ancestors instead.
+  *
+  * <b>Example:</b>
+  * @code
+  * CVariationTree tree(logger);
+  * auto e4 = tree.AddMove(CVariationTree::ROOT, SMove{ eRank::_2, eFile::E, eRank::_4, eFile::E });
+  * auto d4 = tree.AddMove(CVariationTree::ROOT, SMove{ eRank::_2, eFile::D, eRank::_4, eFile::D });
+  * CChessBoard board(logger);
+  * tree.Materialize(*e4, board);
+  * @endcode
+  ********************************************************************/
+  class CVariationTree
+  {
+  public:
+    using node_t = uint32_t;
+
+    static constexpr node_t ROOT = 0;
+    static constexpr node_t NO_NODE = std::numeric_limits<node_t>::max();
+    /// @brief Plies between two nodes with a snapshot
+    static constexpr uint16_t SNAPSHOT_INTERVAL = 8;
+
+    /// @brief Creates a tree rooted at the start position.
+    explicit CVariationTree(Logger logger);
+    /// @brief Creates a tree rooted at a position (e.g. from @c CChessBoard::Snapshot()).
+    CVariationTree(Logger logger, const SPosition& root);
+
+    /// @brief Adds a move at a node, or finds the child with this move if it exists.
+    /// Adding moves along one line is fast: the board of the last added node is kept.
+    /// @return child node, or @c std::nullopt if the move is not valid at @p parent
+    std::optional<node_t> AddMove(node_t parent, const SMove& move);
+
+    /// @return child of @p parent with the move, or @c NO_NODE
+    node_t FindChild(node_t parent, const SMove& move) const;
+
+    /// @brief Sets @p board to the position at a node.
+    void Materialize(node_t node, CChessBoard& board) const;
+
+    /// @brief Moves from the root to a node.
+    /// @param moves cleared first
+    void GetLine(node_t node, std::vector<SMove>& moves) const;
+
+    /// @return @c true if the position at the node occurred at least three times
+    /// on the line from the root (the root counts once, earlier history is unknown)
+    bool IsThreefoldRepetition(node_t node) const;
+
+    /// @return move leading to the node (undefined for @c ROOT)
+    const SMove& GetMove(node_t node) const { return m_nodes[node].m_move; }
+    node_t GetParent(node_t node) const { return m_nodes[node].m_parent; }
+    node_t GetFirstChild(node_t node) const { return m_nodes[node].m_firstChild; }
+    node_t GetNextSibling(node_t node) const { return m_nodes[node].m_nextSibling; }
+    /// @return plies from the root
+    uint16_t GetDepth(node_t node) const { return m_nodes[node].m_depth; }
+    /// @return @c CChessBoard::GetPositionKey() of the position at the node
+    uint64_t GetPositionKey(node_t node) const { return m_nodes[node].m_positionKey; }
+
+    std::size_t GetNodeCount() const { return m_nodes.size(); }
+    std::size_t GetSnapshotCount() const { return m_snapshots.size(); }
+    /// @return bytes used by the nodes and snapshots
+    std::size_t GetMemoryUsage() const;
+    const SVariationTreeStatistics& GetStatistics() const { return m_statistics; }
+
+  private:
+    static constexpr uint32_t NO_SNAPSHOT = std::numeric_limits<uint32_t>::max();
+
+    struct SNode
+    {
+      /// @brief First, so the node has no padding
+      uint64_t m_positionKey;
+      SMove m_move;
+      node_t m_parent;
+      node_t m_firstChild;
+      node_t m_nextSibling;
+      /// @brief Index in @c m_snapshots or @c NO_SNAPSHOT
+      uint32_t m_snapshot;
+      uint16_t m_depth;
+      /// @brief Plies since the last pawn move or capture (limits the repetition search)
+      uint16_t m_turnsWithoutPawn;
+    };
+    static_assert(sizeof(SNode) == 32, "two nodes per cache line");
+
+    /// @brief Sets @c m_board to the position at a node, reusing it if it is at the node or its parent.
+    void MoveCursor(node_t node);
+
+    Logger m_logger;
+    std::vector<SNode> m_nodes;
+    std::vector<SPosition> m_snapshots;
+    /// @brief Board at the node @c m_cursor, used to validate added moves
+    CChessBoard m_board;
+    node_t m_cursor;
+    SVariationTreeStatistics m_statistics;
+  };
+}
@@ -0,0 +1,39 @@
+#include <stdafx.h>
+
+#include "BoardPool.h"
+
+namespace JC
+{
+  std::unique_ptr<CChessBoard> CBoardPool::Acquire()
+  {
+    std::unique_ptr<CChessBoard> board;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_idle.empty())
+      {
+        board = std::move(m_idle.back());
+        m_idle.pop_back();
+      }
+    }
+    if (board)
+    {
+      m_reused.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+      board = std::make_unique<CChessBoard>(m_logger);
+      m_created.fetch_add(1, std::memory_order_relaxed);
+    }
+    board->Reset();
+    return board;
+  }
+
+  void CBoardPool::Release(std::unique_ptr<CChessBoard> board)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_idle.size() < m_maxIdle)
+    {
+      m_idle.push_back(std::move(board));
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Functional/ChessBoard/ChessBoard.h"
+
+/**
+ *  @defgroup host Game host
+ */
+
+namespace JC
+{
+  /*!******************************************************************
+  * @class CBoardPool
+  *
+  * @ingroup host
+  *
+  * @brief Recycles chess boards of finished games (thread-safe).
+  *
+  * @details A released board keeps its allocated record, so a board taken
+  * from the pool plays the next game without allocating again.
+  * All boards share the logger of the pool.
+  ********************************************************************/
+  class CBoardPool
+  {
+  public:
+    /// @param logger logger of all boards
+    /// @param maxIdle boards kept for reuse; further released boards are deleted
+    CBoardPool(Logger logger, std::size_t maxIdle = 4096)
+      : m_logger(logger)
+      , m_maxIdle(maxIdle)
+      , m_created(0)
+      , m_reused(0)
+    {}
+
+    /// @return board at the start position (reused if possible)
+    std::unique_ptr<CChessBoard> Acquire();
+
+    /// @brief Returns a board to the pool.
+    void Release(std::unique_ptr<CChessBoard> board);
+
+    /// @return number of boards created by @c Acquire()
+    std::size_t GetCreatedCount() const { return m_created.load(std::memory_order_relaxed); }
+    /// @return number of boards reused by @c Acquire()
+    std::size_t GetReusedCount() const { return m_reused.load(std::memory_order_relaxed); }
+
+  private:
+    Logger m_logger;
+    std::size_t m_maxIdle;
+    std::vector<std::unique_ptr<CChessBoard>> m_idle;
+    std::mutex m_mutex;
+    std::atomic<std::size_t> m_created;
+    std::atomic<std::size_t> m_reused;
+  };
+}
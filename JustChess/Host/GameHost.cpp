@@ -0,0 +1,289 @@
+#include <stdafx.h>
+
+#include "GameHost.h"
+#include "..\Functional\Notation\Notation.h"
+#include "..\Profiling\Profiler.h"
+#include "..\Profiling\Tracer.h"
+#include "..\Search\Search.h"
+
+namespace JC
+{
+  namespace
+  {
+    /// @brief Tasks of one game executed before the worker is given to other games
+    constexpr std::size_t MAX_TASKS_PER_DRAIN = 32;
+  }
+
+  CGameHost::CGameHost(Logger logger, std::size_t workers, CAnalysisCache* analysisCache)
+    : m_logger(logger)
+    , m_boardPool(logger)
+    , m_nextId(1)
+    , m_analysisCache(analysisCache)
+    , m_workers(workers)
+  {
+  }
+
+  CGameHost::~CGameHost()
+  {
+    m_workers.WaitIdle();
+  }
+
+  void CGameHost::Submit(std::string_view request, reply_t reply)
+  {
+    std::istringstream stream{ std::string(request) };
+    std::string command;
+    std::string idText;
+    std::string argument;
+    stream >> command >> idText >> argument;
+
+    if (command == "new")
+    {
+      auto session = std::make_shared<SSession>();
+      session->m_id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+      session->m_board = m_boardPool.Acquire();
+      {
+        std::unique_lock<std::shared_mutex> lock(m_sessionsMutex);
+        m_sessions.emplace(session->m_id, session);
+      }
+      reply("ok new " + std::to_string(session->m_id));
+      return;
+    }
+    if (command != "move" && command != "moves" && command != "status" && command != "close" &&
+        command != "analyse")
+    {
+      reply("error " + (command.empty() ? std::string("-") : command) + " unknown-command");
+      return;
+    }
+
+    uint64_t id = 0;
+    try
+    {
+      id = std::stoull(idText);
+    }
+    catch (const std::exception&)
+    {
+      reply("error " + command + " invalid-id");
+      return;
+    }
+    std::shared_ptr<SSession> session = FindSession(id);
+    if (!session)
+    {
+      reply("error " + command + " " + idText + " unknown-game");
+      return;
+    }
+    if (command == "close")
+    {
+      // later requests don't find the game anymore; queued ones are still executed
+      std::unique_lock<std::shared_mutex> lock(m_sessionsMutex);
+      m_sessions.erase(id);
+    }
+    Post(session, [this, session, command, argument, reply = std::move(reply)]()
+    {
+      reply(Execute(*session, command, argument));
+    });
+  }
+
+  void CGameHost::WaitIdle()
+  {
+    m_workers.WaitIdle();
+  }
+
+  std::size_t CGameHost::GetSessionCount() const
+  {
+    std::shared_lock<std::shared_mutex> lock(m_sessionsMutex);
+    return m_sessions.size();
+  }
+
+  std::shared_ptr<CGameHost::SSession> CGameHost::FindSession(uint64_t id) const
+  {
+    std::shared_lock<std::shared_mutex> lock(m_sessionsMutex);
+    const auto it = m_sessions.find(id);
+    return it != m_sessions.end() ? it->second : nullptr;
+  }
+
+  void CGameHost::Post(const std::shared_ptr<SSession>& session, std::function<void()> task)
+  {
+    bool schedule;
+    {
+      std::lock_guard<std::mutex> lock(session->m_mutex);
+      session->m_tasks.push_back(std::move(task));
+      schedule = !session->m_scheduled;
+      session->m_scheduled = true;
+    }
+    if (schedule)
+    {
+      m_workers.Submit([this, session]() { Drain(session); });
+    }
+  }
+
+  void CGameHost::Drain(const std::shared_ptr<SSession>& session)
+  {
+    for (std::size_t count = 0; count < MAX_TASKS_PER_DRAIN; count++)
+    {
+      std::function<void()> task;
+      {
+        std::lock_guard<std::mutex> lock(session->m_mutex);
+        if (session->m_tasks.empty())
+        {
+          session->m_scheduled = false;
+          return;
+        }
+        task = std::move(session->m_tasks.front());
+        session->m_tasks.pop_front();
+      }
+      task();
+    }
+    // give other games a chance; the game stays scheduled
+    m_workers.Submit([this, session]() { Drain(session); });
+  }
+
+  std::string CGameHost::Execute(SSession& session, const std::string& command, const std::string& argument)
+  {
+    JC_PROFILE_ZONE("CGameHost::Execute");
+    JC_TRACE_SCOPE("CGameHost::Execute");
+    const std::string id = std::to_string(session.m_id);
+    if (!session.m_board)
+    {
+      return "error " + command + " " + id + " unknown-game";
+    }
+    CChessBoard& board = *session.m_board;
+
+    if (command == "move")
+    {
+      SMove move;
+      if (!ParseMove(argument, move))
+      {
+        return "error move " + id + " invalid-move";
+      }
+      if (!board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove()))
+      {
+        return "error move " + id + " illegal-move";
+      }
+      return "ok move " + id + " " + argument + " " + GameStatusToString(board.GetGameStatus());
+    }
+    if (command == "moves")
+    {
+      std::vector<SMove> moves;
+      board.GetAllValidMoves(board.IsWhiteToMove(), moves);
+      std::string response = "ok moves " + id;
+      for (const auto& move : moves)
+      {
+        response += " " + MoveToString(move);
+      }
+      return response;
+    }
+    if (command == "status")
+    {
+      return "ok status " + id + (board.IsWhiteToMove() ? " white " : " black ") +
+        GameStatusToString(board.GetGameStatus());
+    }
+    if (command == "analyse")
+    {
+      return Analyse(board, id, argument);
+    }
+    // close
+    m_boardPool.Release(std::move(session.m_board));
+    return "ok close " + id;
+  }
+
+  std::string CGameHost::Analyse(const CChessBoard& board, const std::string& id, const std::string& argument)
+  {
+    std::size_t depth = DEFAULT_ANALYSIS_DEPTH;
+    if (!argument.empty())
+    {
+      depth = static_cast<std::size_t>(std::atoi(argument.c_str()));
+      if (depth == 0 || depth > MAX_ANALYSIS_DEPTH)
+      {
+        return "error analyse " + id + " invalid-depth";
+      }
+    }
+    // also drawn positions with valid moves (repetition, fifty moves, insufficient material)
+    const eGameStatus status = board.GetGameStatus();
+    if (status != eGameStatus::eOngoing && status != eGameStatus::eInCheck)
+    {
+      return "error analyse " + id + " game-over";
+    }
+
+    const uint64_t key = board.GetPositionKey();
+    if (m_analysisCache)
+    {
+      const std::optional<SAnalysis> cached = m_analysisCache->Probe(key);
+      if (cached && cached->m_depth >= depth)
+      {
+        return "ok analyse " + id + " " + MoveToString(cached->m_bestMove) + " " +
+          std::to_string(cached->m_score) + " " + std::to_string(cached->m_depth) + " cached";
+      }
+    }
+
+    CSearch search(m_evaluator);
+    const SSearchResult result = search.Search(board, depth);
+    if (!result.m_bestMove)
+    {
+      return "error analyse " + id + " game-over";
+    }
+    if (m_analysisCache)
+    {
+      SAnalysis analysis;
+      analysis.m_bestMove = *result.m_bestMove;
+      analysis.m_score = static_cast<int16_t>(result.m_score);
+      analysis.m_depth = static_cast<uint8_t>(result.m_depth);
+      analysis.m_timestamp = std::time(nullptr);
+      m_analysisCache->Store(key, analysis);
+    }
+    return "ok analyse " + id + " " + MoveToString(*result.m_bestMove) + " " +
+      std::to_string(result.m_score) + " " + std::to_string(result.m_depth) + " searched";
+  }
+
+  int RunHost(Logger logger, const std::vector<std::string>& args)
+  {
+    std::size_t workers = 0;
+    std::string cachePath;
+    std::size_t cacheMegabytes = 64;
+    bool valid = args.size() % 2 == 1;
+    for (std::size_t ind = 1; valid && ind + 1 < args.size(); ind += 2)
+    {
+      if (args[ind] == "--workers")
+      {
+        workers = static_cast<std::size_t>(std::atoi(args[ind + 1].c_str()));
+      }
+      else if (args[ind] == "--cache")
+      {
+        cachePath = args[ind + 1];
+      }
+      else if (args[ind] == "--cache-mb")
+      {
+        cacheMegabytes = static_cast<std::size_t>(std::atoi(args[ind + 1].c_str()));
+        valid = cacheMegabytes > 0;
+      }
+      else
+      {
+        valid = false;
+      }
+    }
+    if (!valid)
+    {
+      std::cerr << "Usage: JustChess host [--workers N] [--cache FILE] [--cache-mb N]" << std::endl;
+      return 2;
+    }
+
+    CAnalysisCache cache(logger);
+    if (!cachePath.empty() && !cache.Open(cachePath, cacheMegabytes << 20))
+    {
+      return 1;
+    }
+
+    std::mutex outMutex;
+    CGameHost host(logger, workers, cache.IsOpen() ? &cache : nullptr);
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+      host.Submit(line, [&outMutex](const std::string& response)
+      {
+        std::lock_guard<std::mutex> lock(outMutex);
+        std::cout << response << '\n' << std::flush;
+      });
+    }
+    host.WaitIdle();
+    return 0;
+  }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "BoardPool.h"
+#include "Concurrency/WorkerPool.h"
+#include "Evaluation/PawnStructure.h"
+#include "Storage/AnalysisCache.h"
+
+namespace JC
+{
+  /// @brief Receives the response line (without line break) of a request
+  using reply_t = std::function<void(const std::string&)>;
+
+  /*!******************************************************************
+  * @class CGameHost
+  *
+  * @ingroup host
+  *
+  * @brief Hosts many chess games, identified by session IDs.
+  *
+  * @details Requests are text lines (the same protocol is served on stdin
+  * and stdout by the command "host", see @c RunHost()):
+  * <table>
+  * <tr><th>Request</th><th>Response</th></tr>
+  * <tr><td>new</td><td>ok new ID</td></tr>
+  * <tr><td>move ID e2e4</td><td>ok move ID e2e4 STATUS</td></tr>
+  * <tr><td>moves ID</td><td>ok moves ID e2e4 d2d4 ...</td></tr>
+  * <tr><td>status ID</td><td>ok status ID white|black STATUS</td></tr>
+  * <tr><td>analyse ID [DEPTH]</td><td>ok analyse ID e2e4 SCORE DEPTH cached|searched</td></tr>
+  * <tr><td>close ID</td><td>ok close ID</td></tr>
+  * </table>
+  * STATUS is one of @c GameStatusToString(). Failed requests are answered
+  * with "error COMMAND [ID] REASON".
+  *
+  * The requests of a game are executed one after another in the order of
+  * submission, different games in parallel on a fixed worker pool. Boards
+  * of closed games are recycled with a @c CBoardPool.
+  *
+  * "analyse" searches the position with @c CSearch (default depth 3, at most
+  * @c MAX_ANALYSIS_DEPTH); SCORE is in centipawns from the point of view of
+  * the side to move. With a @c CAnalysisCache, positions analysed before (also
+  * by earlier processes) at the same or a higher depth are answered from the cache.
+  ********************************************************************/
+  class CGameHost
+  {
+  public:
+    static constexpr std::size_t DEFAULT_ANALYSIS_DEPTH = 3;
+    static constexpr std::size_t MAX_ANALYSIS_DEPTH = 6;
+
+    /// @param workers number of worker threads; 0 for one per hardware thread
+    /// @param analysisCache open cache of "analyse" results, or @c nullptr (has to outlive the host)
+    CGameHost(Logger logger, std::size_t workers = 0, CAnalysisCache* analysisCache = nullptr);
+    /// @brief Executes all submitted requests.
+    ~CGameHost();
+
+    CGameHost(const CGameHost&) = delete;
+    CGameHost& operator=(const CGameHost&) = delete;
+
+    /// @brief Handles one request. @p reply is called exactly once, on a worker
+    /// thread, or immediately for "new" and malformed requests.
+    void Submit(std::string_view request, reply_t reply);
+
+    /// @brief Blocks until all submitted requests are answered.
+    void WaitIdle();
+
+    /// @return number of open games
+    std::size_t GetSessionCount() const;
+
+    const CBoardPool& GetBoardPool() const { return m_boardPool; }
+    std::size_t GetWorkerCount() const { return m_workers.GetThreadCount(); }
+
+  private:
+    struct SSession
+    {
+      uint64_t m_id = 0;
+      /// @brief @c nullptr after the game was closed
+      std::unique_ptr<CChessBoard> m_board;
+      /// @brief Requests waiting for execution (protected by @c m_mutex)
+      std::deque<std::function<void()>> m_tasks;
+      /// @brief @c true while a worker executes (or is about to execute) the requests
+      bool m_scheduled = false;
+      std::mutex m_mutex;
+    };
+
+    std::shared_ptr<SSession> FindSession(uint64_t id) const;
+    /// @brief Queues a task of a game; the game's tasks never run concurrently.
+    void Post(const std::shared_ptr<SSession>& session, std::function<void()> task);
+    /// @brief Executes queued tasks of a game (on a worker thread).
+    void Drain(const std::shared_ptr<SSession>& session);
+    /// @brief Executes a request of a game and returns the response.
+    std::string Execute(SSession& session, const std::string& command, const std::string& argument);
+    /// @brief Executes "analyse", see @c Execute().
+    std::string Analyse(const CChessBoard& board, const std::string& id, const std::string& argument);
+
+    Logger m_logger;
+    CBoardPool m_boardPool;
+    std::unordered_map<uint64_t, std::shared_ptr<SSession>> m_sessions;
+    mutable std::shared_mutex m_sessionsMutex;
+    std::atomic<uint64_t> m_nextId;
+    CPawnStructureEvaluator m_evaluator;
+    CAnalysisCache* m_analysisCache;
+    /// @brief Declared last, so pending tasks finish before the sessions are destroyed
+    CWorkerPool m_workers;
+  };
+
+  /// @brief Entry point of the command "host": serves the protocol of @c CGameHost
+  /// on stdin (requests) and stdout (responses) until the end of the input.
+  /// Options: --workers N, --cache FILE (persistent @c CAnalysisCache), --cache-mb N (default 64).
+  /// @return process exit code
+  int RunHost(Logger logger, const std::vector<std::string>& args);
+}
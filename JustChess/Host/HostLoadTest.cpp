@@ -0,0 +1,284 @@
+#include <stdafx.h>
+
+#include "HostLoadTest.h"
+
+namespace JC
+{
+  namespace
+  {
+    using clock_t = std::chrono::steady_clock;
+
+    /// @brief One simulated client; only one of its requests is pending at a time
+    struct SClient
+    {
+      std::mt19937 m_random;
+      std::string m_id;
+      std::size_t m_plies = 0;
+      /// @brief Latency of each request in ns
+      std::vector<uint64_t> m_latencies;
+    };
+
+    /// @brief State shared by all clients of a run
+    struct SLoadState
+    {
+      CGameHost* m_host = nullptr;
+      std::size_t m_games = 0;
+      std::size_t m_maxPlies = 0;
+      std::atomic<std::size_t> m_started{ 0 };
+      std::atomic<std::size_t> m_moves{ 0 };
+      std::atomic<std::size_t> m_failures{ 0 };
+      std::atomic<std::size_t> m_activeClients{ 0 };
+      std::mutex m_mutex;
+      std::condition_variable m_done;
+    };
+
+    std::vector<std::string> Split(const std::string& text)
+    {
+      std::vector<std::string> tokens;
+      std::istringstream stream(text);
+      std::string token;
+      while (stream >> token)
+      {
+        tokens.push_back(token);
+      }
+      return tokens;
+    }
+
+    void StartGame(SLoadState& state, SClient& client);
+
+    /// @brief Submits a request and passes the tokens of the response to @p next.
+    void Send(SLoadState& state, SClient& client, const std::string& request,
+      std::function<void(const std::vector<std::string>&)> next)
+    {
+      const auto start = clock_t::now();
+      state.m_host->Submit(request, [&state, &client, start, next = std::move(next)](const std::string& response)
+      {
+        client.m_latencies.push_back(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count()));
+        std::vector<std::string> tokens = Split(response);
+        if (tokens.empty() || tokens[0] != "ok")
+        {
+          state.m_failures.fetch_add(1, std::memory_order_relaxed);
+        }
+        next(tokens);
+      });
+    }
+
+    void FinishGame(SLoadState& state, SClient& client)
+    {
+      if (state.m_started.fetch_add(1, std::memory_order_relaxed) < state.m_games)
+      {
+        StartGame(state, client);
+      }
+      else if (state.m_activeClients.fetch_sub(1) == 1)
+      {
+        std::lock_guard<std::mutex> lock(state.m_mutex);
+        state.m_done.notify_all();
+      }
+    }
+
+    void PlayMove(SLoadState& state, SClient& client)
+    {
+      Send(state, client, "moves " + client.m_id, [&state, &client](const std::vector<std::string>& moves)
+      {
+        // "ok moves ID" followed by the moves
+        if (moves.size() <= 3)
+        {
+          Send(state, client, "close " + client.m_id, [&state, &client](const auto&) { FinishGame(state, client); });
+          return;
+        }
+        const std::string& move = moves[3 + client.m_random() % (moves.size() - 3)];
+        Send(state, client, "move " + client.m_id + " " + move, [&state, &client](const std::vector<std::string>& tokens)
+        {
+          state.m_moves.fetch_add(1, std::memory_order_relaxed);
+          client.m_plies++;
+          // "ok move ID MOVE STATUS"
+          const bool over = tokens.size() < 5 || (tokens[4] != "ongoing" && tokens[4] != "check");
+          if (over || client.m_plies >= state.m_maxPlies)
+          {
+            Send(state, client, "close " + client.m_id, [&state, &client](const auto&) { FinishGame(state, client); });
+          }
+          else
+          {
+            PlayMove(state, client);
+          }
+        });
+      });
+    }
+
+    void StartGame(SLoadState& state, SClient& client)
+    {
+      Send(state, client, "new", [&state, &client](const std::vector<std::string>& tokens)
+      {
+        client.m_id = tokens.size() == 3 ? tokens[2] : "0";
+        client.m_plies = 0;
+        PlayMove(state, client);
+      });
+    }
+
+    /// @brief Repeats a knight shuffle until the game is drawn by repetition
+    /// and checks that "analyse" answers the drawn position with "game-over".
+    bool CheckDrawnAnalysis(CGameHost& host)
+    {
+      std::string id = "0";
+      host.Submit("new", [&id](const std::string& response)
+      {
+        const std::vector<std::string> tokens = Split(response);
+        id = tokens.size() == 3 ? tokens[2] : "0";
+      });
+      // the requests of a game are executed in the order of submission
+      for (int shuffle = 0; shuffle < 3; shuffle++)
+      {
+        for (const char* move : { "g1f3", "g8f6", "f3g1", "f6g8" })
+        {
+          host.Submit("move " + id + " " + move, [](const std::string&) {});
+        }
+      }
+      std::mutex mutex;
+      std::string analysis;
+      host.Submit("analyse " + id + " 2", [&mutex, &analysis](const std::string& response)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        analysis = response;
+      });
+      host.Submit("close " + id, [](const std::string&) {});
+      host.WaitIdle();
+      std::lock_guard<std::mutex> lock(mutex);
+      return analysis == "error analyse " + id + " game-over";
+    }
+
+    double Percentile(const std::vector<uint64_t>& sorted, double fraction)
+    {
+      if (sorted.empty())
+      {
+        return 0.0;
+      }
+      const std::size_t ind = std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * sorted.size()));
+      return static_cast<double>(sorted[ind]) * 1e-3;
+    }
+  }
+
+  bool CHostLoadTest::Run(std::ostream& out)
+  {
+    CGameHost host(m_logger, m_options.m_workers);
+    SLoadState state;
+    state.m_host = &host;
+    state.m_games = m_options.m_games;
+    state.m_maxPlies = m_options.m_maxPlies;
+
+    const std::size_t clientCount = std::min(m_options.m_concurrency, m_options.m_games);
+    std::vector<SClient> clients(clientCount);
+    for (std::size_t ind = 0; ind < clientCount; ind++)
+    {
+      clients[ind].m_random.seed(m_options.m_seed + static_cast<uint32_t>(ind));
+    }
+
+    const auto start = clock_t::now();
+    state.m_activeClients = clientCount;
+    state.m_started = clientCount;
+    for (auto& client : clients)
+    {
+      StartGame(state, client);
+    }
+    {
+      std::unique_lock<std::mutex> lock(state.m_mutex);
+      state.m_done.wait(lock, [&state]() { return state.m_activeClients.load() == 0; });
+    }
+    host.WaitIdle();
+    const double seconds = std::chrono::duration<double>(clock_t::now() - start).count();
+
+    const bool drawnAnalysis = CheckDrawnAnalysis(host);
+    if (!drawnAnalysis)
+    {
+      JC_LOG_ERROR(m_logger, "Analysis of a drawn position with valid moves is not refused");
+    }
+
+    std::vector<uint64_t> latencies;
+    for (const auto& client : clients)
+    {
+      latencies.insert(latencies.end(), client.m_latencies.begin(), client.m_latencies.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    const double moves = static_cast<double>(state.m_moves.load());
+    out << "{\n  \"games\": " << m_options.m_games
+        << ",\n  \"concurrency\": " << clientCount
+        << ",\n  \"workers\": " << host.GetWorkerCount()
+        << ",\n  \"requests\": " << latencies.size()
+        << ",\n  \"moves\": " << state.m_moves.load()
+        << ",\n  \"failures\": " << state.m_failures.load()
+        << ",\n  \"seconds\": " << seconds
+        << ",\n  \"moves_per_second\": " << (seconds > 0.0 ? moves / seconds : 0.0)
+        << ",\n  \"requests_per_second\": " << (seconds > 0.0 ? latencies.size() / seconds : 0.0)
+        << ",\n  \"latency_us\": {\"p50\": " << Percentile(latencies, 0.5)
+        << ", \"p90\": " << Percentile(latencies, 0.9)
+        << ", \"p99\": " << Percentile(latencies, 0.99)
+        << ", \"p999\": " << Percentile(latencies, 0.999)
+        << ", \"max\": " << Percentile(latencies, 1.0) << "}"
+        << ",\n  \"boards_created\": " << host.GetBoardPool().GetCreatedCount()
+        << ",\n  \"boards_reused\": " << host.GetBoardPool().GetReusedCount()
+        << ",\n  \"drawn_analysis_refused\": " << (drawnAnalysis ? "true" : "false")
+        << "\n}\n";
+    out.flush();
+    return state.m_failures.load() == 0 && drawnAnalysis;
+  }
+
+  bool CHostLoadTest::ParseArgs(const std::vector<std::string>& args, SHostLoadOptions& options)
+  {
+    for (std::size_t ind = 1; ind < args.size(); ind += 2)
+    {
+      if (ind + 1 >= args.size())
+      {
+        return false; // every option has a value
+      }
+      std::size_t number;
+      try
+      {
+        number = std::stoul(args[ind + 1]);
+      }
+      catch (const std::exception&)
+      {
+        return false;
+      }
+      const std::string& arg = args[ind];
+      if (arg == "--games" && number > 0)
+      {
+        options.m_games = number;
+      }
+      else if (arg == "--concurrency" && number > 0)
+      {
+        options.m_concurrency = number;
+      }
+      else if (arg == "--plies" && number > 0)
+      {
+        options.m_maxPlies = number;
+      }
+      else if (arg == "--workers")
+      {
+        options.m_workers = number;
+      }
+      else if (arg == "--seed")
+      {
+        options.m_seed = static_cast<uint32_t>(number);
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int RunHostBenchmark(Logger logger, const std::vector<std::string>& args)
+  {
+    SHostLoadOptions options;
+    if (!CHostLoadTest::ParseArgs(args, options))
+    {
+      std::cerr << "Usage: JustChess host-bench [--games N] [--concurrency N] [--plies N] "
+                   "[--workers N] [--seed N]" << std::endl;
+      return 2;
+    }
+    CHostLoadTest loadTest(logger, options);
+    return loadTest.Run(std::cout) ? 0 : 1;
+  }
+}
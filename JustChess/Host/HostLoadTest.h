@@ -0,0 +1,66 @@
+#pragma once
+
+#include "GameHost.h"
+
+namespace JC
+{
+  /// @brief Settings of a load test of @c CGameHost
+  struct SHostLoadOptions
+  {
+    /// @brief Games played in total
+    std::size_t m_games = 10000;
+    /// @brief Games played at the same time (one client each)
+    std::size_t m_concurrency = 1000;
+    /// @brief Games are closed after this number of moves at the latest
+    std::size_t m_maxPlies = 80;
+    /// @brief Worker threads of the host; 0 for one per hardware thread
+    std::size_t m_workers = 0;
+    uint32_t m_seed = 1;
+  };
+
+  /*!******************************************************************
+  * @class CHostLoadTest
+  *
+  * @ingroup host
+  *
+  * @brief Synthetic load generator for @c CGameHost.
+  *
+  * @details Each client plays random games: it opens a game, asks for the
+  * valid moves, submits one of them and repeats until the game is over or
+  * @c m_maxPlies is reached, then closes the game and opens the next one.
+  * A client submits its next request when the previous one is answered.
+  * The time from submission to response is measured for every request.
+  *
+  * After the load, a game is drawn by threefold repetition (with valid
+  * moves left) and "analyse" has to answer it with "game-over".
+  *
+  * Run from the command line:
+  * @code
+  * JustChess host-bench [--games N] [--concurrency N] [--plies N] [--workers N] [--seed N]
+  * @endcode
+  ********************************************************************/
+  class CHostLoadTest
+  {
+  public:
+    CHostLoadTest(Logger logger, const SHostLoadOptions& options)
+      : m_logger(logger)
+      , m_options(options)
+    {}
+
+    /// @brief Plays all games and writes throughput and latency percentiles as JSON.
+    /// @return @c false if a request failed
+    bool Run(std::ostream& out);
+
+    /// @brief Parses the command line arguments following "host-bench".
+    /// @return @c false if an argument is invalid
+    static bool ParseArgs(const std::vector<std::string>& args, SHostLoadOptions& options);
+
+  private:
+    Logger m_logger;
+    SHostLoadOptions m_options;
+  };
+
+  /// @brief Entry point of the command "host-bench".
+  /// @return process exit code
+  int RunHostBenchmark(Logger logger, const std::vector<std::string>& args);
+}
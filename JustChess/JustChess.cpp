@@ -1,39 +1,127 @@
 ﻿#include <stdafx.h>
 
-#include "Logger\StandardOutputLogger.h"
+#include "Logger\AsyncLogger.h"
+#include "Benchmark\Benchmark.h"
+#include "Benchmark\EpdSuite.h"
+#include "Benchmark\MateBenchmark.h"
+#include "Host\GameHost.h"
+#include "Host\HostLoadTest.h"
+#include "Replay\GameReplay.h"
+#include "Search\MateSolver.h"
+#include "Storage\PositionIndex.h"
+#include "Tournament\Tournament.h"
 #include "Functional\ChessBoard\ChessBoard.h"
 #include "Functional\ChessPieces\ChessPiece.h"
-
-#define INIT_TIME \
-    std::chrono::time_point<std::chrono::system_clock> startTime;
-#define START_TIMER \
-    startTime = std::chrono::system_clock::now()
-#define STOP_TIMER \
-    std::chrono::duration_cast<std::chrono::microseconds>( \
-    std::chrono::system_clock::now() - startTime).count()
-    
+#include "Functional\Notation\Notation.h"
+#include "Profiling\Profiler.h"
+#include "Profiling\Tracer.h"
 
 void CheckValidMoves(JC::CChessBoard& board);
-void Play(JC::CChessBoard& board);
-bool CharToChessRank(char rankChar, JC::eRank& rank);
-bool CharToChessFile(char fileChar, JC::eFile& file);
-std::string TimeText(std::string text, long long time_ms);
-void PrintTime(std::string text, long long time_ms);
+void Play(Logger logger, JC::CChessBoard& board);
+int RunCommand(Logger logger, const std::vector<std::string>& args);
+
+
+int main(int argc, char* argv[])
+{
+  Logger logger = std::make_shared<CAsyncLogger>();
+
+  std::vector<std::string> args(argv + 1, argv + argc);
+  // "--trace FILE" in front of the command writes a Chrome trace of the run,
+  // "--trace-events N" sets the events recorded per thread (24 bytes each)
+  std::string tracePath;
+  std::size_t traceEvents = JC::CTracer::DEFAULT_CAPACITY;
+  while (args.size() >= 2 && (args[0] == "--trace" || args[0] == "--trace-events"))
+  {
+    if (args[0] == "--trace")
+    {
+      tracePath = args[1];
+    }
+    else
+    {
+      try
+      {
+        traceEvents = std::stoull(args[1]);
+      }
+      catch (const std::exception&)
+      {
+        std::cerr << "Usage: JustChess [--trace FILE] [--trace-events N] <command> ..." << std::endl;
+        return 2;
+      }
+    }
+    args.erase(args.begin(), args.begin() + 2);
+  }
+  if (!tracePath.empty())
+  {
+    JC::CTracer::Enable(traceEvents);
+  }
 
+  const int result = RunCommand(logger, args);
 
-int main()
+  if (!tracePath.empty())
+  {
+    JC::CTracer::Disable();
+    std::ofstream traceJson(tracePath);
+    JC::CTracer::WriteJson(traceJson);
+  }
+  return result;
+}
+
+int RunCommand(Logger logger, const std::vector<std::string>& args)
 {
-  Logger logger = std::make_shared<CStandardOutputLogger>();
-  logger->Info("Start JustChess");
+  if (!args.empty() && args[0] == "bench")
+  {
+    return JC::RunBenchmark(logger, args);
+  }
+  if (!args.empty() && args[0] == "host")
+  {
+    return JC::RunHost(logger, args);
+  }
+  if (!args.empty() && args[0] == "host-bench")
+  {
+    return JC::RunHostBenchmark(logger, args);
+  }
+  if (!args.empty() && args[0] == "index")
+  {
+    return JC::RunPositionIndex(logger, args);
+  }
+  if (!args.empty() && args[0] == "tournament")
+  {
+    return JC::RunTournament(logger, args);
+  }
+  if (!args.empty() && args[0] == "replay")
+  {
+    return JC::RunReplay(logger, args);
+  }
+  if (!args.empty() && args[0] == "mate")
+  {
+    return JC::RunMateSolver(logger, args);
+  }
+  if (!args.empty() && args[0] == "mate-bench")
+  {
+    return JC::RunMateBenchmark(logger, args);
+  }
+  if (!args.empty() && args[0] == "epd")
+  {
+    return JC::RunEpdSuite(logger, args);
+  }
+
+  JC_LOG_INFO(logger, "Start JustChess");
   JC::CChessBoard board(logger);
 
-  Play(board);
+  Play(logger, board);
   //CheckValidMoves(board);
 
-  logger->Info("End JustChess");
+#ifdef JC_PROFILING
+  JC::CProfiler::Instance().PrintTable(std::cout);
+  std::ofstream profileJson("profile.json");
+  JC::CProfiler::Instance().WriteJson(profileJson);
+#endif
+
+  JC_LOG_INFO(logger, "End JustChess");
+  return 0;
 }
 
-void Play(JC::CChessBoard& board)
+void Play(Logger logger, JC::CChessBoard& board)
 {
   bool whiteToMove = true;
   int turnCount = 0;
@@ -43,46 +131,54 @@ void Play(JC::CChessBoard& board)
   JC::eFile toFile;
   JC::eRank toRank;
 
-  INIT_TIME;
-
   board.Reset();
   while (true)
   {
+    // pending log records are written before the board, not in between
+    logger->Flush();
     std::cout << std::endl;
     board.PrintRecord(-1);
     std::cout << std::endl;
 
-    START_TIMER;
-    if (board.ThreefoldRepetition())
+    JC::eGameStatus status;
     {
-      std::cout << "Threefold repetition." << std::endl;
-      PrintTime("ThreefoldRepetition (true): %t ms", STOP_TIMER);
-      break;
+      JC_PROFILE_ZONE("Play: GetGameStatus");
+      status = board.GetGameStatus();
     }
-    PrintTime("ThreefoldRepetition (false): %t ms", STOP_TIMER);
-
-    START_TIMER;
-    switch (board.CheckmateState(whiteToMove))
+    bool draw = false;
+    switch (status)
     {
-    case JC::eState::eNone:
-      PrintTime("CheckmateState (eNone): %t ms", STOP_TIMER);
+    case JC::eGameStatus::eOngoing:
       std::cout << "" << std::endl;
       break;
-    case JC::eState::eInCheck:
-      PrintTime("CheckmateState (eInCheck): %t ms", STOP_TIMER);
+    case JC::eGameStatus::eInCheck:
       std::cout << "Check!" << std::endl;
       break;
-    case JC::eState::eCheckmate:
-      PrintTime("CheckmateState (eCheckmate): %t ms", STOP_TIMER);
+    case JC::eGameStatus::eCheckmate:
       std::cout << "Checkmate!" << std::endl;
       break;
-    case JC::eState::eStalemate:
-      PrintTime("CheckmateState (eStalemate): %t ms", STOP_TIMER);
+    case JC::eGameStatus::eStalemate:
       std::cout << "Stalemate!" << std::endl;
       break;
+    case JC::eGameStatus::eThreefoldRepetition:
+      std::cout << "Threefold repetition." << std::endl;
+      draw = true;
+      break;
+    case JC::eGameStatus::eFiftyMoves:
+      std::cout << "Fifty-move rule." << std::endl;
+      draw = true;
+      break;
+    case JC::eGameStatus::eInsufficientMaterial:
+      std::cout << "Insufficient material." << std::endl;
+      draw = true;
+      break;
     default:
       break;
     }
+    if (draw)
+    {
+      break;
+    }
     
     std::cout << (turnCount/2 + 1) << ". move of " <<
       (whiteToMove ? "white: " : "black: ") << std::flush;
@@ -112,74 +208,31 @@ void Play(JC::CChessBoard& board)
       continue;
     }
     
-    if (!CharToChessFile(moveStr[0], fromFile) ||
-        !CharToChessRank(moveStr[1], fromRank) ||
-        !CharToChessFile(moveStr[2], toFile) ||
-        !CharToChessRank(moveStr[3], toRank))
+    if (!JC::CharToChessFile(moveStr[0], fromFile) ||
+        !JC::CharToChessRank(moveStr[1], fromRank) ||
+        !JC::CharToChessFile(moveStr[2], toFile) ||
+        !JC::CharToChessRank(moveStr[3], toRank))
     {
       std::cout << "Invalid input." << std::endl;
       continue;
     }
 
-    START_TIMER;
-    if (!board.Move(fromRank, fromFile, toRank, toFile, whiteToMove))
+    bool moved;
+    {
+      JC_PROFILE_ZONE("Play: Move");
+      moved = board.Move(fromRank, fromFile, toRank, toFile, whiteToMove);
+    }
+    if (!moved)
     {
-      PrintTime("Move (false): %t ms", STOP_TIMER);
       std::cout << "Not a valid move." << std::endl;
       continue;
     }
-    PrintTime("Move (true): %t ms", STOP_TIMER);
     turnCount++;
     whiteToMove = !whiteToMove;
   }
 }
 
 
-bool CharToChessRank(char rankChar, JC::eRank& rank)
-{
-  switch (rankChar)
-  {
-  case '1': rank = JC::eRank::_1; break;
-  case '2': rank = JC::eRank::_2; break;
-  case '3': rank = JC::eRank::_3; break;
-  case '4': rank = JC::eRank::_4; break;
-  case '5': rank = JC::eRank::_5; break;
-  case '6': rank = JC::eRank::_6; break;
-  case '7': rank = JC::eRank::_7; break;
-  case '8': rank = JC::eRank::_8; break;
-  default:
-    return false;
-  }
-  return true;
-}
-
-bool CharToChessFile(char fileChar, JC::eFile& file)
-{
-  switch (fileChar)
-  {
-  case 'A': file = JC::eFile::A; break;
-  case 'a': file = JC::eFile::A; break;
-  case 'B': file = JC::eFile::B; break;
-  case 'b': file = JC::eFile::B; break;
-  case 'C': file = JC::eFile::C; break;
-  case 'c': file = JC::eFile::C; break;
-  case 'D': file = JC::eFile::D; break;
-  case 'd': file = JC::eFile::D; break;
-  case 'E': file = JC::eFile::E; break;
-  case 'e': file = JC::eFile::E; break;
-  case 'F': file = JC::eFile::F; break;
-  case 'f': file = JC::eFile::F; break;
-  case 'G': file = JC::eFile::G; break;
-  case 'g': file = JC::eFile::G; break;
-  case 'H': file = JC::eFile::H; break;
-  case 'h': file = JC::eFile::H; break;
-  default:
-    return false;
-  }
-  return true;
-}
-
-
 void CheckValidMoves(JC::CChessBoard& board)
 {
   std::string moveStr;
@@ -263,24 +316,6 @@ void CheckValidMoves(JC::CChessBoard& board)
     }
 
     std::cout << std::endl;
-    board.PrintBoolMat(board.GetValidMoves(rank, file, forWhite));
+    board.PrintBoolMat(JC::CChessBoard::ToBoolMat(board.GetValidMoves(rank, file, forWhite)));
   }
 }
-
-std::string TimeText(std::string text, long long time_micro_s)
-{
-  std::string replace = "%t";
-  std::size_t index;
-  std::string time_micro_s_str = std::to_string((double)time_micro_s / 1000);
-  if ((index = text.find(replace)) != std::string::npos)
-  {
-    text.replace(index, replace.length(), time_micro_s_str);
-  }
-  return text;
-}
-
-void PrintTime(std::string text, long long time_micro_s)
-{
-  std::cout << "\t" << TimeText(text, time_micro_s) << std::endl;
-}
-
@@ -0,0 +1,188 @@
+#include <stdafx.h>
+
+#include "AsyncLogger.h"
+
+namespace
+{
+  constexpr std::size_t MAX_BATCH_SIZE = 256;
+  constexpr auto IDLE_SLEEP = std::chrono::milliseconds(1);
+
+  std::size_t RoundUpToPowerOfTwo(std::size_t value)
+  {
+    std::size_t result = 2;
+    while (result < value)
+    {
+      result <<= 1;
+    }
+    return result;
+  }
+}
+
+CAsyncLogger::CAsyncLogger(std::ostream& out, std::size_t capacity, eOverflowPolicy policy)
+  : m_out(out)
+  , m_policy(policy)
+  , m_mask(RoundUpToPowerOfTwo(capacity) - 1)
+  , m_records(std::make_unique<SRecord[]>(m_mask + 1))
+  , m_enqueuePos(0)
+  , m_dequeuePos(0)
+  , m_written(0)
+  , m_dropped(0)
+  , m_stop(false)
+{
+  for (std::size_t ind = 0; ind <= m_mask; ind++)
+  {
+    m_records[ind].m_sequence.store(ind, std::memory_order_relaxed);
+  }
+  m_batch.reserve(MAX_BATCH_SIZE * 64);
+  m_thread = std::thread(&CAsyncLogger::Run, this);
+}
+
+CAsyncLogger::~CAsyncLogger()
+{
+  m_stop.store(true, std::memory_order_release);
+  m_thread.join();
+}
+
+void CAsyncLogger::Info(std::string_view text, std::string_view file, int line)
+{
+  if (IsEnabled(eLogLevel::info))
+  {
+    Enqueue(eLogLevel::info, text, file, line);
+  }
+}
+
+void CAsyncLogger::Warning(std::string_view text, std::string_view file, int line)
+{
+  if (IsEnabled(eLogLevel::warning))
+  {
+    Enqueue(eLogLevel::warning, text, file, line);
+  }
+}
+
+void CAsyncLogger::Error(std::string_view text, std::string_view file, int line)
+{
+  if (IsEnabled(eLogLevel::error))
+  {
+    Enqueue(eLogLevel::error, text, file, line);
+  }
+}
+
+void CAsyncLogger::Flush()
+{
+  const std::size_t target = m_enqueuePos.load(std::memory_order_acquire);
+  std::unique_lock<std::mutex> lock(m_flushMutex);
+  m_flushed.wait(lock, [this, target]() { return m_written.load(std::memory_order_acquire) >= target; });
+}
+
+void CAsyncLogger::Enqueue(eLogLevel level, std::string_view text, std::string_view file, int line)
+{
+  std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+  SRecord* record = nullptr;
+  while (true)
+  {
+    record = &m_records[pos & m_mask];
+    const std::size_t sequence = record->m_sequence.load(std::memory_order_acquire);
+    const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+    if (diff == 0)
+    {
+      if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      // ring buffer is full
+      if (m_policy == eOverflowPolicy::drop)
+      {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      std::this_thread::yield();
+      pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+    else
+    {
+      pos = m_enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  record->m_level = level;
+  record->m_line = line;
+  record->m_textLength = static_cast<uint8_t>(std::min(text.size(), TEXT_CAPACITY));
+  record->m_fileLength = static_cast<uint8_t>(std::min(file.size(), FILE_CAPACITY));
+  std::memcpy(record->m_text, text.data(), record->m_textLength);
+  std::memcpy(record->m_file, file.data(), record->m_fileLength);
+  if (text.size() > TEXT_CAPACITY)
+  {
+    std::memcpy(record->m_text + TEXT_CAPACITY - 3, "...", 3);
+  }
+  record->m_sequence.store(pos + 1, std::memory_order_release);
+}
+
+std::size_t CAsyncLogger::WriteBatch()
+{
+  std::size_t count = 0;
+  m_batch.clear();
+  while (count < MAX_BATCH_SIZE)
+  {
+    SRecord& record = m_records[m_dequeuePos & m_mask];
+    if (record.m_sequence.load(std::memory_order_acquire) != m_dequeuePos + 1)
+    {
+      break; // no more records
+    }
+
+    switch (record.m_level)
+    {
+    case eLogLevel::info: m_batch += "[INFO] "; break;
+    case eLogLevel::warning: m_batch += "[WARNING] "; break;
+    case eLogLevel::error: m_batch += "[ERROR] "; break;
+    case eLogLevel::off: break; // not enqueued
+    }
+    m_batch.append(record.m_text, record.m_textLength);
+    if (record.m_fileLength)
+    {
+      m_batch += "\n\tFILE: ";
+      m_batch.append(record.m_file, record.m_fileLength);
+    }
+    if (record.m_line)
+    {
+      m_batch += "\n\tLINE: ";
+      m_batch += std::to_string(record.m_line);
+    }
+    m_batch += '\n';
+
+    // hand the slot back to the producers
+    record.m_sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+    m_dequeuePos++;
+    count++;
+  }
+
+  if (count)
+  {
+    m_out.write(m_batch.data(), static_cast<std::streamsize>(m_batch.size()));
+    m_out.flush();
+    {
+      // taking the lock makes sure a flushing thread is either waiting or sees the new count
+      std::lock_guard<std::mutex> lock(m_flushMutex);
+      m_written.fetch_add(count, std::memory_order_release);
+    }
+    m_flushed.notify_all();
+  }
+  return count;
+}
+
+void CAsyncLogger::Run()
+{
+  while (!m_stop.load(std::memory_order_acquire))
+  {
+    if (WriteBatch() == 0)
+    {
+      std::this_thread::sleep_for(IDLE_SLEEP);
+    }
+  }
+  // write what is left after stop was requested
+  while (WriteBatch() > 0)
+  {
+  }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Logger.h"
+
+/*!******************************************************************
+* @class CAsyncLogger
+*
+* @ingroup logging
+*
+* @brief Non-blocking logger with a background writer thread.
+*
+* @details <b>Logging never performs I/O on the caller's thread.</b>
+*
+* Each call to @c Info(), @c Warning() or @c Error() copies the text
+* into a fixed-size record of a bounded lock-free ring buffer
+* (multiple producers, one consumer). A background thread drains the
+* buffer, formats the records and writes them in batches with a single
+* flush per batch.
+*
+* If the ring buffer is full, the @c eOverflowPolicy decides:
+* - @c drop: the record is discarded and counted (see @c GetDroppedCount())
+* - @c block: the caller waits until a slot becomes free (backpressure)
+*
+* Texts longer than the record capacity are truncated.
+*
+* <b>Example:</b>
+* @code
+* Logger logger = std::make_shared<CAsyncLogger>();
+* logger->Info("Start JustChess");
+* @endcode
+*
+* Call @c Flush() before writing to the same stream directly, so the
+* records are not interleaved with that output.
+********************************************************************/
+class CAsyncLogger : public ILogger
+{
+public:
+  /// @brief Behaviour when the ring buffer is full
+  enum class eOverflowPolicy : uint8_t
+  {
+    drop = 0,
+    block
+  };
+
+  /// @brief Creates the logger and starts the writer thread.
+  /// @param out Stream the records are written to
+  /// @param capacity Number of records in the ring buffer (rounded up to a power of two)
+  /// @param policy What to do if the ring buffer is full
+  CAsyncLogger(std::ostream& out = std::cout, std::size_t capacity = 1024,
+    eOverflowPolicy policy = eOverflowPolicy::drop);
+  /// @brief Writes all pending records and stops the writer thread.
+  ~CAsyncLogger() override;
+
+  CAsyncLogger(const CAsyncLogger&) = delete;
+  CAsyncLogger& operator=(const CAsyncLogger&) = delete;
+
+  /// Enqueues an info text.
+  void Info(std::string_view text, std::string_view file, int line) override;
+  /// Enqueues a warning text.
+  void Warning(std::string_view text, std::string_view file, int line) override;
+  /// Enqueues an error text.
+  void Error(std::string_view text, std::string_view file, int line) override;
+
+  /// @brief Blocks until all records enqueued so far are written.
+  void Flush() override;
+  /// @return number of records discarded because the ring buffer was full
+  std::size_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr std::size_t TEXT_CAPACITY = 240;
+  static constexpr std::size_t FILE_CAPACITY = 120;
+
+  /// @brief Slot of the ring buffer. @c m_sequence tells producers and
+  /// the consumer whose turn it is (bounded queue by D. Vyukov).
+  struct SRecord
+  {
+    std::atomic<std::size_t> m_sequence;
+    eLogLevel m_level;
+    uint8_t m_textLength;
+    uint8_t m_fileLength;
+    int m_line;
+    char m_text[TEXT_CAPACITY];
+    char m_file[FILE_CAPACITY];
+  };
+
+  void Enqueue(eLogLevel level, std::string_view text, std::string_view file, int line);
+  /// @brief Pops and formats up to one batch of records.
+  /// @return number of records written
+  std::size_t WriteBatch();
+  void Run();
+
+  std::ostream& m_out;
+  const eOverflowPolicy m_policy;
+  const std::size_t m_mask;
+  std::unique_ptr<SRecord[]> m_records;
+  /// @brief Next slot to claim by producers
+  alignas(64) std::atomic<std::size_t> m_enqueuePos;
+  /// @brief Next slot to read by the writer thread (only touched by writer)
+  alignas(64) std::size_t m_dequeuePos;
+  /// @brief Number of records already written (for @c Flush())
+  std::atomic<std::size_t> m_written;
+  std::atomic<std::size_t> m_dropped;
+  std::atomic<bool> m_stop;
+  /// @brief Signalled by the writer thread after each written batch (for @c Flush())
+  std::mutex m_flushMutex;
+  std::condition_variable m_flushed;
+  /// @brief Reused buffer for formatting a batch
+  std::string m_batch;
+  std::thread m_thread;
+};
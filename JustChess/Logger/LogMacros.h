@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Logger.h"
+
+/*!******************************************************************
+* @file LogMacros.h
+*
+* @ingroup logging
+*
+* @brief Logging macros with compile-time and runtime level filtering.
+*
+* @details The text argument is only evaluated if the record passes
+* both filters, so disabled records neither build strings nor call
+* the (virtual) logger.
+*
+* - Compile-time: define @c JC_LOG_MIN_LEVEL (0 = info, 1 = warning,
+*   2 = error, 3 = off). Records below it are removed by the compiler.
+* - Runtime: @c ILogger::SetLevel()
+*
+* File and line are captured automatically, with @c std::source_location
+* if available (C++20) and with @c __FILE__ / @c __LINE__ otherwise.
+*
+* <b>Example:</b>
+* @code
+* JC_LOG_ERROR(m_logger, "Index " + std::to_string(ind) + " out of range");
+* @endcode
+********************************************************************/
+
+#ifndef JC_LOG_MIN_LEVEL
+#define JC_LOG_MIN_LEVEL 0
+#endif
+
+/// @brief @c JC_LOG_MIN_LEVEL as level, so the macros compare levels and not integers
+constexpr eLogLevel LOG_MIN_LEVEL = static_cast<eLogLevel>(JC_LOG_MIN_LEVEL);
+
+#if __has_include(<source_location>)
+#include <source_location>
+#endif
+
+#ifdef __cpp_lib_source_location
+#define JC_LOG_FILE std::source_location::current().file_name()
+#define JC_LOG_LINE static_cast<int>(std::source_location::current().line())
+#else
+#define JC_LOG_FILE __FILE__
+#define JC_LOG_LINE __LINE__
+#endif
+
+#define JC_LOG_AT_LEVEL(logger, level, method, text) \
+  do { \
+    if constexpr ((level) >= LOG_MIN_LEVEL) \
+    { \
+      if ((logger)->IsEnabled(level)) \
+      { \
+        (logger)->method((text), JC_LOG_FILE, JC_LOG_LINE); \
+      } \
+    } \
+  } while (false)
+
+/// @brief Logs an info text if level @c info is enabled.
+#define JC_LOG_INFO(logger, text) JC_LOG_AT_LEVEL(logger, eLogLevel::info, Info, text)
+/// @brief Logs a warning text if level @c warning is enabled.
+#define JC_LOG_WARNING(logger, text) JC_LOG_AT_LEVEL(logger, eLogLevel::warning, Warning, text)
+/// @brief Logs an error text if level @c error is enabled.
+#define JC_LOG_ERROR(logger, text) JC_LOG_AT_LEVEL(logger, eLogLevel::error, Error, text)
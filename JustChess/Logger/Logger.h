@@ -4,6 +4,15 @@
  *  @defgroup logging Logging
  */
 
+/// @brief Log levels in ascending order of severity
+enum class eLogLevel : uint8_t
+{
+  info = 0,
+  warning,
+  error,
+  off
+};
+
 /*!******************************************************************
 * @interface ILogger
 * 
@@ -18,6 +27,10 @@
 * 
 * <tt>Logger</tt> is defined as <tt>std::shared_ptr<ILogger></tt>.
 * 
+* Records below the runtime level (see @c SetLevel()) are ignored by
+* every logger. Use the macros of @c LogMacros.h to check the level
+* before the text is formatted.
+* 
 * <b>Example:</b> Create a @c shared_ptr of type @c Logger
 * by means of a derived class (e.g. @c CStandardOutputLogger).
 * @code
@@ -39,6 +52,19 @@ public:
   virtual void Info(std::string_view text, std::string_view file = "", int line = 0) = 0;
   virtual void Warning(std::string_view text, std::string_view file = "", int line = 0) = 0;
   virtual void Error(std::string_view text, std::string_view file = "", int line = 0) = 0;
+  /// @brief Blocks until all records logged so far are written (e.g. before direct console output).
+  /// Loggers which write synchronously do nothing.
+  virtual void Flush() {}
+
+  /// @brief Set minimum level of records to be logged.
+  void SetLevel(eLogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+  /// @return minimum level of records to be logged
+  eLogLevel GetLevel() const { return m_level.load(std::memory_order_relaxed); }
+  /// @return @c true if records of this level are logged
+  bool IsEnabled(eLogLevel level) const { return level >= GetLevel(); }
+
+private:
+  std::atomic<eLogLevel> m_level{ eLogLevel::info };
 };
 
 using Logger = std::shared_ptr<ILogger>;
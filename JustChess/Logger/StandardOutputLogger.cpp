@@ -4,6 +4,10 @@
 
 void CStandardOutputLogger::Info(std::string_view text, std::string_view file, int line)
 {
+  if (!IsEnabled(eLogLevel::info))
+  {
+    return;
+  }
   std::cout << "[INFO] " << text <<
     (file.empty() ? "" : "\n\tFILE: ") << (file.empty() ? "" : file) <<
     (line ? "\n\tLINE: " : "") << (line ? std::to_string(line) : "") << std::endl ;
@@ -11,6 +15,10 @@ void CStandardOutputLogger::Info(std::string_view text, std::string_view file, i
 
 void CStandardOutputLogger::Warning(std::string_view text, std::string_view file, int line)
 {
+  if (!IsEnabled(eLogLevel::warning))
+  {
+    return;
+  }
   std::cout << "[WARNING] " << text <<
     (file.empty() ? "" : "\n\tFILE: ") << (file.empty() ? "" : file) <<
     (line ? "\n\tLINE: " : "") << (line ? std::to_string(line) : "") << std::endl;
@@ -18,6 +26,10 @@ void CStandardOutputLogger::Warning(std::string_view text, std::string_view file
 
 void CStandardOutputLogger::Error(std::string_view text, std::string_view file, int line)
 {
+  if (!IsEnabled(eLogLevel::error))
+  {
+    return;
+  }
   std::cout << "[ERROR] " << text <<
     (file.empty() ? "" : "\n\tFILE: ") << (file.empty() ? "" : file) <<
     (line ? "\n\tLINE: " : "") << (line ? std::to_string(line) : "") << std::endl;
@@ -0,0 +1,69 @@
+#include <stdafx.h>
+
+#include "CpuFeatures.h"
+
+#if defined(JC_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace JC
+{
+  namespace
+  {
+    eSimdLevel QuerySimdLevel()
+    {
+#if defined(JC_X86) && defined(_MSC_VER) && !defined(__clang__)
+      int info[4];
+      __cpuid(info, 0);
+      const int maxLeaf = info[0];
+
+      __cpuid(info, 1);
+      const bool sse41 = (info[2] & (1 << 19)) != 0;
+      const bool osxsave = (info[2] & (1 << 27)) != 0;
+      const bool avx = (info[2] & (1 << 28)) != 0;
+
+      bool avx2 = false;
+      if (maxLeaf >= 7 && osxsave && avx)
+      {
+        __cpuidex(info, 7, 0);
+        // the operating system has to save the YMM registers on context switches
+        avx2 = (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+      }
+      if (avx2)
+      {
+        return eSimdLevel::avx2;
+      }
+      return sse41 ? eSimdLevel::sse4 : eSimdLevel::scalar;
+#elif defined(JC_X86)
+      // also checks the operating system support of the YMM registers
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2"))
+      {
+        return eSimdLevel::avx2;
+      }
+      return __builtin_cpu_supports("sse4.1") ? eSimdLevel::sse4 : eSimdLevel::scalar;
+#else
+      return eSimdLevel::scalar;
+#endif
+    }
+  }
+
+  eSimdLevel DetectSimdLevel()
+  {
+    static const eSimdLevel s_level = QuerySimdLevel();
+    return s_level;
+  }
+
+  const char* SimdLevelName(eSimdLevel level)
+  {
+    switch (level)
+    {
+    case eSimdLevel::avx2:
+      return "avx2";
+    case eSimdLevel::sse4:
+      return "sse4";
+    default:
+      return "scalar";
+    }
+  }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ *  @defgroup platform Platform
+ */
+
+/*!******************************************************************
+* @file CpuFeatures.h
+*
+* @ingroup platform
+*
+* @brief Runtime detection of SIMD instruction sets.
+*
+* @details Vectorized kernels are compiled for every supported instruction
+* set and selected at runtime with @c DetectSimdLevel(), so the same binary
+* runs on every x86-64 CPU. Functions using AVX2 or SSE4 intrinsics have to be
+* marked with @c JC_TARGET_AVX2 or @c JC_TARGET_SSE4 (needed by GCC and Clang,
+* MSVC allows the intrinsics without special compiler options).
+* On other architectures only the scalar code is used.
+********************************************************************/
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define JC_X86 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define JC_TARGET_SSE4
+#define JC_TARGET_AVX2
+#else
+#define JC_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define JC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace JC
+{
+  /// @brief Instruction set used by vectorized kernels
+  enum class eSimdLevel : uint8_t
+  {
+    scalar = 0,
+    sse4,
+    avx2
+  };
+
+  /// @return best instruction set supported by the CPU and the operating system
+  /// (detected once, cached afterwards)
+  eSimdLevel DetectSimdLevel();
+
+  /// @return name of the instruction set ("scalar", "sse4" or "avx2")
+  const char* SimdLevelName(eSimdLevel level);
+}
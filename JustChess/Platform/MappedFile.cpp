@@ -0,0 +1,165 @@
+#include <stdafx.h>
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace JC
+{
+  CMappedFile::~CMappedFile()
+  {
+    Close();
+  }
+
+  CMappedFile::CMappedFile(CMappedFile&& other) noexcept
+  {
+    *this = std::move(other);
+  }
+
+  CMappedFile& CMappedFile::operator=(CMappedFile&& other) noexcept
+  {
+    if (this != &other)
+    {
+      Close();
+      std::swap(m_data, other.m_data);
+      std::swap(m_size, other.m_size);
+      std::swap(m_file, other.m_file);
+#ifdef _WIN32
+      std::swap(m_mapping, other.m_mapping);
+#endif
+    }
+    return *this;
+  }
+
+#ifdef _WIN32
+  bool CMappedFile::Open(const std::string& path, eMapMode mode, std::size_t size)
+  {
+    Close();
+    const bool write = mode == eMapMode::readWrite;
+    HANDLE file = CreateFileA(path.c_str(), write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, write ? OPEN_ALWAYS : OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (write && size != 0)
+    {
+      fileSize.QuadPart = static_cast<LONGLONG>(size);
+      // new bytes of a grown file read as zeros
+      if (!SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+      {
+        CloseHandle(file);
+        return false;
+      }
+    }
+    else if (!GetFileSizeEx(file, &fileSize))
+    {
+      CloseHandle(file);
+      return false;
+    }
+    if (fileSize.QuadPart == 0)
+    {
+      CloseHandle(file); // empty files can't be mapped
+      return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, write ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    void* data = mapping ? MapViewOfFile(mapping, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data)
+    {
+      if (mapping)
+      {
+        CloseHandle(mapping);
+      }
+      CloseHandle(file);
+      return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<uint8_t*>(data);
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+  }
+
+  void CMappedFile::Close()
+  {
+    if (m_data)
+    {
+      UnmapViewOfFile(m_data);
+      CloseHandle(m_mapping);
+      CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_file = nullptr;
+    m_mapping = nullptr;
+  }
+
+  bool CMappedFile::Flush(bool wait)
+  {
+    if (!m_data)
+    {
+      return false;
+    }
+    return FlushViewOfFile(m_data, 0) && (!wait || FlushFileBuffers(m_file));
+  }
+#else
+  bool CMappedFile::Open(const std::string& path, eMapMode mode, std::size_t size)
+  {
+    Close();
+    const bool write = mode == eMapMode::readWrite;
+    const int file = open(path.c_str(), write ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (file < 0)
+    {
+      return false;
+    }
+    struct stat status;
+    // new bytes of a grown file read as zeros
+    if ((write && size != 0 && ftruncate(file, static_cast<off_t>(size)) != 0) || fstat(file, &status) != 0 ||
+        status.st_size == 0)
+    {
+      close(file);
+      return false;
+    }
+    const std::size_t fileSize = static_cast<std::size_t>(status.st_size);
+    void* data = mmap(nullptr, fileSize, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+    if (data == MAP_FAILED)
+    {
+      close(file);
+      return false;
+    }
+    m_file = file;
+    m_data = static_cast<uint8_t*>(data);
+    m_size = fileSize;
+    return true;
+  }
+
+  void CMappedFile::Close()
+  {
+    if (m_data)
+    {
+      munmap(m_data, m_size);
+      close(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_file = -1;
+  }
+
+  bool CMappedFile::Flush(bool wait)
+  {
+    return m_data && msync(m_data, m_size, wait ? MS_SYNC : MS_ASYNC) == 0;
+  }
+#endif
+}
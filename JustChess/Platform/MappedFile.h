@@ -0,0 +1,69 @@
+#pragma once
+
+/*!******************************************************************
+* @file MappedFile.h
+*
+* @ingroup platform
+*
+* @brief Files mapped into memory.
+*
+* @details The pages of a mapped file are loaded lazily by the operating
+* system on first access and stay in the page cache after the process ends,
+* so reopening a recently used file is fast. Changes of a writable mapping are
+* written back by the operating system, also if the process crashes.
+********************************************************************/
+
+namespace JC
+{
+  /// @brief Access of a mapped file
+  enum class eMapMode : uint8_t
+  {
+    readOnly = 0,
+    /// @brief Opens or creates the file, which is resized to the requested size
+    readWrite
+  };
+
+  /// @brief Memory mapping of a whole file (move-only, unmapped on destruction)
+  class CMappedFile
+  {
+  public:
+    CMappedFile() = default;
+    ~CMappedFile();
+
+    CMappedFile(const CMappedFile&) = delete;
+    CMappedFile& operator=(const CMappedFile&) = delete;
+    CMappedFile(CMappedFile&& other) noexcept;
+    CMappedFile& operator=(CMappedFile&& other) noexcept;
+
+    /// @brief Maps a file (an open mapping is closed first).
+    /// @param path
+    /// @param mode
+    /// @param size new size of the file for @c eMapMode::readWrite; 0 keeps the size
+    /// (ignored for read only)
+    /// @return @c false if the file can't be opened or mapped
+    bool Open(const std::string& path, eMapMode mode, std::size_t size = 0);
+
+    /// @brief Unmaps the file.
+    void Close();
+
+    /// @brief Asks the operating system to write changed pages to disk.
+    /// @param wait @c true to return after the pages were written
+    /// @return @c false if flushing failed
+    bool Flush(bool wait = false);
+
+    bool IsOpen() const { return m_data != nullptr; }
+    uint8_t* GetData() { return m_data; }
+    const uint8_t* GetData() const { return m_data; }
+    std::size_t GetSize() const { return m_size; }
+
+  private:
+    uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+  };
+}
@@ -0,0 +1,40 @@
+#include <stdafx.h>
+
+#include "AllocationCounter.h"
+
+#ifdef JC_COUNT_ALLOCATIONS
+
+namespace
+{
+  thread_local uint64_t t_allocations = 0;
+}
+
+namespace JC
+{
+  uint64_t GetThreadAllocationCount()
+  {
+    return t_allocations;
+  }
+}
+
+// The other forms (arrays, nothrow) call these by default.
+void* operator new(std::size_t size)
+{
+  t_allocations++;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+/*!******************************************************************
+* @file AllocationCounter.h
+*
+* @ingroup profiling
+*
+* @brief Counts the heap allocations of the calling thread.
+*
+* @details The global @c operator @c new is replaced (see AllocationCounter.cpp),
+* so every allocation with @c new, @c std::vector, @c std::string etc.
+* increments a counter of the allocating thread. The cost is one increment of
+* a thread-local variable per allocation.
+*
+* Counting is only compiled in if @c JC_COUNT_ALLOCATIONS is defined, so
+* only builds for benchmarks or tests replace @c operator @c new. Otherwise
+* the count is always 0 and @c ALLOCATION_COUNTING is @c false.
+*
+* @c CAllocationCheck counts the allocations of a scope. It is used by the
+* benchmark to verify that the hot paths of @c CChessBoard (e.g. @c Move()
+* and @c CheckmateState()) do not allocate once their buffers are warmed up.
+*
+* <b>Example:</b>
+* @code
+* JC::CAllocationCheck check;
+* board.Move(...);
+* if (check.GetAllocations() != 0) { ... }
+* @endcode
+********************************************************************/
+
+namespace JC
+{
+#ifdef JC_COUNT_ALLOCATIONS
+  constexpr bool ALLOCATION_COUNTING = true;
+
+  /// @return number of heap allocations of the calling thread since it started
+  uint64_t GetThreadAllocationCount();
+#else
+  constexpr bool ALLOCATION_COUNTING = false;
+
+  inline uint64_t GetThreadAllocationCount() { return 0; }
+#endif
+
+  /// @brief Counts the heap allocations of the calling thread from construction on
+  class CAllocationCheck
+  {
+  public:
+    CAllocationCheck()
+      : m_start(GetThreadAllocationCount())
+    {}
+
+    /// @return number of allocations of the calling thread since construction
+    uint64_t GetAllocations() const { return GetThreadAllocationCount() - m_start; }
+
+  private:
+    uint64_t m_start;
+  };
+}
@@ -0,0 +1,169 @@
+#include <stdafx.h>
+
+#include "Profiler.h"
+
+namespace JC
+{
+  CProfileZone::CProfileZone(const char* name)
+    : m_name(name)
+    , m_count(0)
+    , m_total(0)
+    , m_min(std::numeric_limits<uint64_t>::max())
+    , m_max(0)
+  {
+    for (auto& bucket : m_histogram)
+    {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    CProfiler::Instance().Register(this);
+  }
+
+  void CProfileZone::Record(uint64_t nanoseconds)
+  {
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t current = m_min.load(std::memory_order_relaxed);
+    while (nanoseconds < current &&
+           !m_min.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+    current = m_max.load(std::memory_order_relaxed);
+    while (nanoseconds > current &&
+           !m_max.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+
+    std::size_t bucket = 0;
+    while (bucket + 1 < HISTOGRAM_BUCKETS && (nanoseconds >> (bucket + 1)) != 0)
+    {
+      bucket++;
+    }
+    m_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t CProfileZone::GetPercentile(double fraction) const
+  {
+    const uint64_t count = GetCount();
+    if (count == 0)
+    {
+      return 0;
+    }
+    const auto target = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+    uint64_t sum = 0;
+    for (std::size_t ind = 0; ind < HISTOGRAM_BUCKETS; ind++)
+    {
+      sum += GetBucket(ind);
+      if (sum >= target)
+      {
+        return std::min(uint64_t(2) << ind, GetMax());
+      }
+    }
+    return GetMax();
+  }
+
+  CProfileCounter::CProfileCounter(const char* name)
+    : m_name(name)
+    , m_value(0)
+  {
+    CProfiler::Instance().Register(this);
+  }
+
+  CProfiler& CProfiler::Instance()
+  {
+    static CProfiler s_profiler;
+    return s_profiler;
+  }
+
+  void CProfiler::Register(CProfileZone* zone)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_zones.push_back(zone);
+  }
+
+  void CProfiler::Register(CProfileCounter* counter)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_counters.push_back(counter);
+  }
+
+  void CProfiler::PrintTable(std::ostream& out) const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto toMicro = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    out << std::left << std::setw(40) << "Zone" << std::right
+        << std::setw(12) << "Calls"
+        << std::setw(14) << "Total [us]"
+        << std::setw(12) << "Mean [us]"
+        << std::setw(12) << "Min [us]"
+        << std::setw(12) << "P99 [us]"
+        << std::setw(12) << "Max [us]" << "\n";
+    out << std::fixed << std::setprecision(3);
+    for (const auto* zone : m_zones)
+    {
+      const uint64_t count = zone->GetCount();
+      if (count == 0)
+      {
+        continue;
+      }
+      out << std::left << std::setw(40) << zone->GetName() << std::right
+          << std::setw(12) << count
+          << std::setw(14) << toMicro(zone->GetTotal())
+          << std::setw(12) << toMicro(zone->GetTotal()) / static_cast<double>(count)
+          << std::setw(12) << toMicro(zone->GetMin())
+          << std::setw(12) << toMicro(zone->GetPercentile(0.99))
+          << std::setw(12) << toMicro(zone->GetMax()) << "\n";
+    }
+    for (const auto* counter : m_counters)
+    {
+      out << std::left << std::setw(40) << counter->GetName() << std::right
+          << std::setw(12) << counter->GetValue() << "\n";
+    }
+    out << std::defaultfloat << std::flush;
+  }
+
+  void CProfiler::WriteJson(std::ostream& out) const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << "{\"zones\":[";
+    bool first = true;
+    for (const auto* zone : m_zones)
+    {
+      const uint64_t count = zone->GetCount();
+      if (count == 0)
+      {
+        continue;
+      }
+      out << (first ? "" : ",") << "\n  {\"name\":\"" << zone->GetName() << "\""
+          << ",\"count\":" << count
+          << ",\"total_ns\":" << zone->GetTotal()
+          << ",\"min_ns\":" << zone->GetMin()
+          << ",\"max_ns\":" << zone->GetMax()
+          << ",\"p50_ns\":" << zone->GetPercentile(0.5)
+          << ",\"p99_ns\":" << zone->GetPercentile(0.99)
+          << ",\"histogram\":[";
+      // buckets as [upper bound in ns, count], empty buckets are skipped
+      bool firstBucket = true;
+      for (std::size_t ind = 0; ind < CProfileZone::HISTOGRAM_BUCKETS; ind++)
+      {
+        if (zone->GetBucket(ind) == 0)
+        {
+          continue;
+        }
+        out << (firstBucket ? "" : ",") << "[" << (uint64_t(2) << ind) << "," << zone->GetBucket(ind) << "]";
+        firstBucket = false;
+      }
+      out << "]}";
+      first = false;
+    }
+    out << "\n],\"counters\":{";
+    first = true;
+    for (const auto* counter : m_counters)
+    {
+      out << (first ? "" : ",") << "\n  \"" << counter->GetName() << "\":" << counter->GetValue();
+      first = false;
+    }
+    out << "\n}}" << std::endl;
+  }
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+/**
+ *  @defgroup profiling Profiling
+ */
+
+/*!******************************************************************
+* @file Profiler.h
+*
+* @ingroup profiling
+*
+* @brief Scoped profiling zones with aggregated statistics.
+*
+* @details Put @c JC_PROFILE_ZONE("name") at the beginning of a scope.
+* Every pass through the scope is measured with @c std::chrono::steady_clock
+* and aggregated in the zone of this call site: call count, total, minimum,
+* maximum and a histogram of the latencies (power of two buckets).
+* All zones can be printed as a table or as JSON, see @c CProfiler.
+*
+* @c JC_PROFILE_COUNT("name", n) adds @c n to the counter of this call site,
+* e.g. to report hit rates of caches next to the zones.
+*
+* Profiling is only compiled in if @c JC_PROFILING is defined; otherwise
+* @c JC_PROFILE_ZONE expands to nothing.
+*
+* <b>Example:</b>
+* @code
+* bool CChessBoard::Move(...)
+* {
+*   JC_PROFILE_ZONE("CChessBoard::Move");
+*   ...
+* }
+* @endcode
+********************************************************************/
+
+#define JC_PROFILE_CONCAT_IMPL(a, b) a##b
+#define JC_PROFILE_CONCAT(a, b) JC_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef JC_PROFILING
+#define JC_PROFILE_ZONE(name) \
+  static JC::CProfileZone JC_PROFILE_CONCAT(s_profileZone, __LINE__)(name); \
+  JC::CProfileScope JC_PROFILE_CONCAT(profileScope, __LINE__)(JC_PROFILE_CONCAT(s_profileZone, __LINE__))
+#define JC_PROFILE_COUNT(name, value) \
+  do { \
+    static JC::CProfileCounter JC_PROFILE_CONCAT(s_profileCounter, __LINE__)(name); \
+    JC_PROFILE_CONCAT(s_profileCounter, __LINE__).Add(value); \
+  } while (false)
+#else
+#define JC_PROFILE_ZONE(name)
+#define JC_PROFILE_COUNT(name, value) do {} while (false)
+#endif
+
+namespace JC
+{
+  /// @brief Aggregated statistics of one profiling zone (thread-safe)
+  class CProfileZone
+  {
+  public:
+    /// @brief Number of histogram buckets; bucket @c i counts durations in [2^i, 2^(i+1)) ns
+    static constexpr std::size_t HISTOGRAM_BUCKETS = 40;
+
+    /// @brief Creates the zone and registers it at @c CProfiler
+    /// @param name Name of the zone (string literal, has to outlive the zone)
+    explicit CProfileZone(const char* name);
+
+    CProfileZone(const CProfileZone&) = delete;
+    CProfileZone& operator=(const CProfileZone&) = delete;
+
+    /// @brief Adds one measurement
+    /// @param nanoseconds duration of one pass through the zone
+    void Record(uint64_t nanoseconds);
+
+    const char* GetName() const { return m_name; }
+    uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t GetTotal() const { return m_total.load(std::memory_order_relaxed); }
+    uint64_t GetMin() const { return m_min.load(std::memory_order_relaxed); }
+    uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+    uint64_t GetBucket(std::size_t ind) const { return m_histogram[ind].load(std::memory_order_relaxed); }
+    /// @brief Estimates a percentile from the histogram
+    /// @param fraction percentile between 0 and 1 (e.g. 0.99)
+    /// @return upper bound of the bucket containing the percentile in ns
+    uint64_t GetPercentile(double fraction) const;
+
+  private:
+    const char* m_name;
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_total;
+    std::atomic<uint64_t> m_min;
+    std::atomic<uint64_t> m_max;
+    std::atomic<uint64_t> m_histogram[HISTOGRAM_BUCKETS];
+  };
+
+  /// @brief Event counter registered at @c CProfiler (thread-safe)
+  class CProfileCounter
+  {
+  public:
+    /// @param name Name of the counter (string literal, has to outlive the counter)
+    explicit CProfileCounter(const char* name);
+
+    CProfileCounter(const CProfileCounter&) = delete;
+    CProfileCounter& operator=(const CProfileCounter&) = delete;
+
+    void Add(uint64_t value) { m_value.fetch_add(value, std::memory_order_relaxed); }
+
+    const char* GetName() const { return m_name; }
+    uint64_t GetValue() const { return m_value.load(std::memory_order_relaxed); }
+
+  private:
+    const char* m_name;
+    std::atomic<uint64_t> m_value;
+  };
+
+  /// @brief Measures the lifetime of a scope and records it in a zone
+  class CProfileScope
+  {
+  public:
+    explicit CProfileScope(CProfileZone& zone)
+      : m_zone(zone)
+      , m_start(std::chrono::steady_clock::now())
+    {}
+    ~CProfileScope()
+    {
+      m_zone.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_start).count()));
+    }
+
+    CProfileScope(const CProfileScope&) = delete;
+    CProfileScope& operator=(const CProfileScope&) = delete;
+
+  private:
+    CProfileZone& m_zone;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  /// @brief Registry of all profiling zones
+  class CProfiler
+  {
+  public:
+    static CProfiler& Instance();
+
+    void Register(CProfileZone* zone);
+    void Register(CProfileCounter* counter);
+
+    /// @brief Writes all zones as a table (times in microseconds), followed by the counters
+    void PrintTable(std::ostream& out) const;
+    /// @brief Writes all zones (times in nanoseconds) and counters as JSON
+    void WriteJson(std::ostream& out) const;
+
+  private:
+    CProfiler() = default;
+
+    mutable std::mutex m_mutex;
+    std::vector<CProfileZone*> m_zones;
+    std::vector<CProfileCounter*> m_counters;
+  };
+}
@@ -0,0 +1,165 @@
+#include <stdafx.h>
+
+#include "Tracer.h"
+
+namespace JC
+{
+  namespace
+  {
+    using clock_t = std::chrono::steady_clock;
+
+    struct SEvent
+    {
+      const char* m_name;
+      /// @brief Nanoseconds since @c CTracer::Enable()
+      uint64_t m_time;
+      char m_phase;
+    };
+
+    /// @brief Events of one thread; written by this thread only
+    struct SThreadBuffer
+    {
+      SThreadBuffer(uint32_t threadId, std::size_t capacity, uint64_t generation)
+        : m_threadId(threadId)
+        , m_generation(generation)
+        , m_events(capacity)
+        , m_count(0)
+        , m_dropped(0)
+        , m_open(0)
+      {}
+
+      const uint32_t m_threadId;
+      /// @brief @c Enable() call the buffer belongs to
+      const uint64_t m_generation;
+      std::vector<SEvent> m_events;
+      /// @brief Number of valid events (stored with release after writing an event)
+      std::atomic<std::size_t> m_count;
+      std::atomic<uint64_t> m_dropped;
+      /// @brief Recorded begin events without end event; their end events have reserved room
+      std::size_t m_open;
+    };
+
+    struct STraceState
+    {
+      std::mutex m_mutex;
+      std::vector<std::shared_ptr<SThreadBuffer>> m_buffers;
+      std::size_t m_capacity = CTracer::DEFAULT_CAPACITY;
+      /// @brief Time of @c CTracer::Enable(); atomic as @c Record() reads it without the lock
+      std::atomic<clock_t::rep> m_start{ clock_t::now().time_since_epoch().count() };
+      std::atomic<uint64_t> m_generation{ 0 };
+      uint32_t m_nextThreadId = 1;
+    };
+
+    STraceState& GetState()
+    {
+      static STraceState s_state;
+      return s_state;
+    }
+
+    /// @return buffer of the calling thread for the current @c Enable() call
+    SThreadBuffer& GetThreadBuffer()
+    {
+      thread_local std::shared_ptr<SThreadBuffer> t_buffer;
+      STraceState& state = GetState();
+      const uint64_t generation = state.m_generation.load(std::memory_order_acquire);
+      if (!t_buffer || t_buffer->m_generation != generation)
+      {
+        // registered once per thread and Enable() call; the registry keeps it after the thread ends
+        std::lock_guard<std::mutex> lock(state.m_mutex);
+        t_buffer = std::make_shared<SThreadBuffer>(state.m_nextThreadId++, state.m_capacity, generation);
+        state.m_buffers.push_back(t_buffer);
+      }
+      return *t_buffer;
+    }
+  }
+
+  std::atomic<bool> CTracer::s_enabled{ false };
+
+  void CTracer::Enable(std::size_t capacity)
+  {
+    STraceState& state = GetState();
+    {
+      std::lock_guard<std::mutex> lock(state.m_mutex);
+      state.m_buffers.clear();
+      state.m_capacity = std::max<std::size_t>(capacity, 2);
+      state.m_nextThreadId = 1;
+      state.m_start.store(clock_t::now().time_since_epoch().count(), std::memory_order_relaxed);
+      state.m_generation.fetch_add(1, std::memory_order_release);
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+  }
+
+  void CTracer::Disable()
+  {
+    s_enabled.store(false, std::memory_order_relaxed);
+  }
+
+  bool CTracer::Record(const char* name, char phase)
+  {
+    SThreadBuffer& buffer = GetThreadBuffer();
+    const std::size_t count = buffer.m_count.load(std::memory_order_relaxed);
+    if (phase == 'B')
+    {
+      // room for this event, its end event and the end events of the open scopes
+      if (count + buffer.m_open + 2 > buffer.m_events.size())
+      {
+        buffer.m_dropped.fetch_add(2, std::memory_order_relaxed);
+        return false;
+      }
+      buffer.m_open++;
+    }
+    else if (buffer.m_open > 0)
+    {
+      buffer.m_open--;
+    }
+    else
+    {
+      // the begin event was recorded before the last Enable()
+      buffer.m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    const clock_t::time_point start(clock_t::duration(GetState().m_start.load(std::memory_order_relaxed)));
+    const auto elapsed = clock_t::now() - start;
+    buffer.m_events[count] = SEvent{ name,
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), phase };
+    buffer.m_count.store(count + 1, std::memory_order_release);
+    return true;
+  }
+
+  uint64_t CTracer::GetDroppedCount()
+  {
+    STraceState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_mutex);
+    uint64_t dropped = 0;
+    for (const auto& buffer : state.m_buffers)
+    {
+      dropped += buffer->m_dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+  }
+
+  void CTracer::WriteJson(std::ostream& out)
+  {
+    STraceState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.m_mutex);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buffer : state.m_buffers)
+    {
+      out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+          << buffer->m_threadId << ",\"args\":{\"name\":\"thread " << buffer->m_threadId << "\"}}";
+      first = false;
+      const std::size_t count = buffer->m_count.load(std::memory_order_acquire);
+      for (std::size_t ind = 0; ind < count; ind++)
+      {
+        const SEvent& event = buffer->m_events[ind];
+        // timestamps in microseconds with nanosecond resolution
+        out << ",\n{\"name\":\"" << event.m_name << "\",\"ph\":\"" << event.m_phase
+            << "\",\"pid\":1,\"tid\":" << buffer->m_threadId
+            << ",\"ts\":" << event.m_time / 1000 << "." << std::setw(3) << std::setfill('0') << event.m_time % 1000
+            << std::setfill(' ') << "}";
+      }
+    }
+    out << "\n]}" << std::endl;
+  }
+}
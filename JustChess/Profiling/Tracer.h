@@ -0,0 +1,98 @@
+#pragma once
+
+/*!******************************************************************
+* @file Tracer.h
+*
+* @ingroup profiling
+*
+* @brief Opt-in recording of single calls as Chrome trace events.
+*
+* @details Put @c JC_TRACE_SCOPE("name") at the beginning of a scope. While
+* tracing is enabled (@c CTracer::Enable()), every pass records a begin and an
+* end event with a timestamp into a buffer of the calling thread. The buffers
+* are written by their thread only and read with acquire semantics, so
+* recording needs no lock. A begin event is only recorded if the buffer also
+* has room for the end events of all open scopes, so a full buffer drops
+* whole scopes and the trace stays balanced. Each event takes 24 bytes; the
+* capacity per thread is set by @c CTracer::Enable(). @c CTracer::WriteJson() writes all events in the
+* Chrome trace-event format, which can be loaded into Perfetto
+* (ui.perfetto.dev) or chrome://tracing.
+*
+* Unlike @c JC_PROFILE_ZONE, tracing is always compiled in. When it is
+* disabled, a scope costs one load of the enabled flag and a branch which is
+* always predicted correctly (the end of the scope tests the same local value).
+*
+* <b>Example:</b>
+* @code
+* JC::CTracer::Enable();
+* board.Move(...); // contains JC_TRACE_SCOPE("CChessBoard::Move")
+* std::ofstream file("trace.json");
+* JC::CTracer::WriteJson(file);
+* @endcode
+********************************************************************/
+
+#define JC_TRACE_CONCAT_IMPL(a, b) a##b
+#define JC_TRACE_CONCAT(a, b) JC_TRACE_CONCAT_IMPL(a, b)
+#define JC_TRACE_SCOPE(name) JC::CTraceScope JC_TRACE_CONCAT(traceScope, __LINE__)(name)
+
+namespace JC
+{
+  /// @brief Registry of the per-thread event buffers
+  class CTracer
+  {
+  public:
+    /// @brief Default number of events per thread (24 MB); further events are dropped
+    static constexpr std::size_t DEFAULT_CAPACITY = std::size_t(1) << 20;
+
+    /// @brief Starts recording. Events recorded before are discarded.
+    /// @param capacity maximum number of events per thread, allocated when a thread records its first event
+    static void Enable(std::size_t capacity = DEFAULT_CAPACITY);
+
+    /// @brief Stops recording; recorded events are kept for @c WriteJson().
+    static void Disable();
+
+    static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /// @brief Writes the events of all threads as Chrome trace-event JSON.
+    /// Threads may still be recording while writing.
+    static void WriteJson(std::ostream& out);
+
+    /// @return number of events dropped because a thread buffer was full
+    static uint64_t GetDroppedCount();
+
+    /// @brief Records a begin ('B') or end ('E') event on the calling thread.
+    /// @return @c false if the event was dropped; the end event of a dropped begin event has to be dropped too
+    static bool Record(const char* name, char phase);
+
+  private:
+    static std::atomic<bool> s_enabled;
+  };
+
+  /// @brief Records the begin and end of a scope if tracing is enabled, see @c JC_TRACE_SCOPE
+  class CTraceScope
+  {
+  public:
+    explicit CTraceScope(const char* name)
+      : m_name(CTracer::IsEnabled() ? name : nullptr)
+    {
+      if (m_name && !CTracer::Record(m_name, 'B'))
+      {
+        m_name = nullptr;
+      }
+    }
+    ~CTraceScope()
+    {
+      if (m_name)
+      {
+        CTracer::Record(m_name, 'E');
+      }
+    }
+
+    CTraceScope(const CTraceScope&) = delete;
+    CTraceScope& operator=(const CTraceScope&) = delete;
+
+  private:
+    /// @brief @c nullptr if tracing was disabled when the scope started or the begin event was dropped
+    const char* m_name;
+  };
+}
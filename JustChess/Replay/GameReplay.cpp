@@ -0,0 +1,187 @@
+#include <stdafx.h>
+
+#include "GameReplay.h"
+#include "..\Functional\Notation\Notation.h"
+#include "..\Profiling\Profiler.h"
+
+namespace JC
+{
+  CGameReplay::CGameReplay(Logger logger, const SReplayOptions& options)
+    : m_logger(logger)
+    , m_options(options)
+    , m_board(logger)
+  {
+    m_buffer.reserve(m_options.m_bufferSize + 256);
+  }
+
+  SReplayGameResult CGameReplay::ReplayGame(std::string_view line)
+  {
+    JC_PROFILE_ZONE("CGameReplay::ReplayGame");
+    SReplayGameResult result;
+    m_board.Reset();
+    std::size_t pos = 0;
+    while (pos < line.size())
+    {
+      if (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')
+      {
+        pos++;
+        continue;
+      }
+      const std::size_t end = std::min(line.find_first_of(" \t\r", pos), line.size());
+      const std::string_view text = line.substr(pos, end - pos);
+      SMove move;
+      if (!ParseMove(text, move))
+      {
+        result.m_invalidMove = text;
+        result.m_parseError = true;
+        break;
+      }
+      if (!m_board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, m_board.IsWhiteToMove()))
+      {
+        result.m_invalidMove = text;
+        break;
+      }
+      result.m_plies++;
+      pos = end;
+    }
+    result.m_status = m_board.GetGameStatus();
+    return result;
+  }
+
+  SReplaySummary CGameReplay::Run(std::istream& in, std::ostream& out)
+  {
+    SReplaySummary summary;
+    const auto start = std::chrono::steady_clock::now();
+    m_buffer.clear();
+    m_buffer += "line,result,plies,status,invalid_move\n";
+
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(in, line))
+    {
+      lineNumber++;
+      const std::size_t first = line.find_first_not_of(" \t\r");
+      if (first == std::string::npos || line[first] == '#')
+      {
+        continue;
+      }
+      const SReplayGameResult result = ReplayGame(line);
+      summary.m_games++;
+      summary.m_plies += result.m_plies;
+      if (!result.IsValid())
+      {
+        summary.m_invalidGames++;
+      }
+      if (!result.IsValid() || !m_options.m_errorsOnly)
+      {
+        AppendResult(lineNumber, result);
+      }
+      if (m_buffer.size() >= m_options.m_bufferSize)
+      {
+        out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_buffer.clear();
+      }
+    }
+    out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+    out.flush();
+
+    summary.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+  }
+
+  void CGameReplay::AppendResult(std::size_t lineNumber, const SReplayGameResult& result)
+  {
+    m_buffer += std::to_string(lineNumber);
+    m_buffer += ',';
+    m_buffer += result.IsValid() ? "ok" : (result.m_parseError ? "parse" : "illegal");
+    m_buffer += ',';
+    m_buffer += std::to_string(result.m_plies);
+    m_buffer += ',';
+    m_buffer += GameStatusToString(result.m_status);
+    m_buffer += ',';
+    // commas and quotes of an unparsable word would break the CSV line
+    for (const char character : result.m_invalidMove)
+    {
+      m_buffer += (character == ',' || character == '"') ? '?' : character;
+    }
+    m_buffer += '\n';
+  }
+
+  bool CGameReplay::ParseArgs(const std::vector<std::string>& args, SReplayOptions& options)
+  {
+    bool hasInput = false;
+    for (std::size_t ind = 1; ind < args.size(); ind++)
+    {
+      const std::string& arg = args[ind];
+      if (arg == "--errors-only")
+      {
+        options.m_errorsOnly = true;
+      }
+      else if (arg == "--output")
+      {
+        if (ind + 1 >= args.size())
+        {
+          return false;
+        }
+        options.m_outputPath = args[++ind];
+      }
+      else if (!hasInput && (arg == "-" || arg.rfind("--", 0) != 0))
+      {
+        options.m_inputPath = arg;
+        hasInput = true;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int RunReplay(Logger logger, const std::vector<std::string>& args)
+  {
+    SReplayOptions options;
+    if (!CGameReplay::ParseArgs(args, options))
+    {
+      std::cerr << "Usage: JustChess replay [FILE|-] [--output FILE] [--errors-only]" << std::endl;
+      return 2;
+    }
+
+    std::ifstream inputFile;
+    if (options.m_inputPath != "-")
+    {
+      inputFile.open(options.m_inputPath);
+      if (!inputFile)
+      {
+        JC_LOG_ERROR(logger, "Games can not be read: " + options.m_inputPath);
+        return 2;
+      }
+    }
+    std::ofstream outputFile;
+    if (!options.m_outputPath.empty())
+    {
+      outputFile.open(options.m_outputPath, std::ios::binary);
+      if (!outputFile)
+      {
+        JC_LOG_ERROR(logger, "Results can not be written: " + options.m_outputPath);
+        return 2;
+      }
+    }
+    // the standard streams are not mixed with C stdio here
+    std::ios_base::sync_with_stdio(false);
+    std::istream& in = inputFile.is_open() ? static_cast<std::istream&>(inputFile) : std::cin;
+    std::ostream& out = outputFile.is_open() ? static_cast<std::ostream&>(outputFile) : std::cout;
+
+    CGameReplay replay(logger, options);
+    const SReplaySummary summary = replay.Run(in, out);
+    std::cerr << "{\"games\": " << summary.m_games
+              << ", \"invalid_games\": " << summary.m_invalidGames
+              << ", \"plies\": " << summary.m_plies
+              << ", \"seconds\": " << summary.m_seconds
+              << ", \"games_per_second\": " << (summary.m_seconds > 0.0 ? summary.m_games / summary.m_seconds : 0.0)
+              << ", \"plies_per_second\": " << (summary.m_seconds > 0.0 ? summary.m_plies / summary.m_seconds : 0.0)
+              << "}" << std::endl;
+    return summary.m_invalidGames == 0 ? 0 : 1;
+  }
+}
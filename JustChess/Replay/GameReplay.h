@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Logger/LogMacros.h"
+#include "Functional/ChessBoard/ChessBoard.h"
+
+/**
+ *  @defgroup replay Replay
+ */
+
+namespace JC
+{
+  /// @brief Settings of a @c CGameReplay run
+  struct SReplayOptions
+  {
+    /// @brief File with one game per line, or "-" for the standard input
+    std::string m_inputPath = "-";
+    /// @brief Result file; the standard output if empty
+    std::string m_outputPath;
+    /// @brief Write only the games with an invalid move
+    bool m_errorsOnly = false;
+    /// @brief Output is collected and written in chunks of this size
+    std::size_t m_bufferSize = std::size_t(1) << 16;
+  };
+
+  /// @brief Result of one replayed game
+  struct SReplayGameResult
+  {
+    /// @brief Number of moves applied (up to the first invalid one)
+    std::size_t m_plies = 0;
+    /// @brief Status after the last applied move
+    eGameStatus m_status = eGameStatus::eOngoing;
+    /// @brief Text of the first move that could not be parsed or applied, empty if all moves are valid
+    std::string_view m_invalidMove;
+    /// @brief @c true if the invalid move is not in coordinate notation
+    bool m_parseError = false;
+
+    bool IsValid() const { return m_invalidMove.empty(); }
+  };
+
+  /// @brief Totals of a @c CGameReplay run
+  struct SReplaySummary
+  {
+    uint64_t m_games = 0;
+    uint64_t m_invalidGames = 0;
+    uint64_t m_plies = 0;
+    double m_seconds = 0.0;
+  };
+
+  /*!******************************************************************
+  * @class CGameReplay
+  *
+  * @ingroup replay
+  *
+  * @brief Non-interactive replay of recorded games.
+  *
+  * @details Reads move scripts with one game per line (moves in coordinate
+  * notation separated by spaces, e.g. "e2e4 e7e5 g1f3"), applies the moves to
+  * one reused board and writes one CSV line per game:
+  * @code
+  * line,result,plies,status,invalid_move
+  * 1,ok,57,checkmate,
+  * 2,illegal,12,ongoing,e1e3
+  * @endcode
+  * "line" is the line number of the game in the input, "result" is @c ok,
+  * @c illegal (move not valid in the position) or @c parse (not a move),
+  * "plies" the number of applied moves and "status" the game status after
+  * them (see @c GameStatusToString()). Empty lines and lines starting with
+  * '#' are skipped.
+  *
+  * Nothing is rendered; the output is collected in a buffer and written in
+  * large chunks. Since @c CChessBoard::Move() does not allocate once the board
+  * is warmed up, replaying is dominated by the move validation itself.
+  *
+  * Run from the command line:
+  * @code
+  * JustChess replay [FILE|-] [--output FILE] [--errors-only]
+  * @endcode
+  ********************************************************************/
+  class CGameReplay
+  {
+  public:
+    CGameReplay(Logger logger, const SReplayOptions& options);
+
+    /// @brief Replays all games of the input and writes their results.
+    /// @return totals of the run; the summary is not written to @p out
+    SReplaySummary Run(std::istream& in, std::ostream& out);
+
+    /// @brief Resets the board and applies the moves of one game.
+    /// @param line moves of the game; @c SReplayGameResult::m_invalidMove points into it
+    SReplayGameResult ReplayGame(std::string_view line);
+
+    /// @brief Parses the command line arguments following "replay".
+    /// @return @c false if an argument is invalid
+    static bool ParseArgs(const std::vector<std::string>& args, SReplayOptions& options);
+
+  private:
+    /// @brief Appends the CSV line of a game to the output buffer
+    void AppendResult(std::size_t lineNumber, const SReplayGameResult& result);
+
+    Logger m_logger;
+    SReplayOptions m_options;
+    CChessBoard m_board;
+    std::string m_buffer;
+  };
+
+  /// @brief Entry point of the command "replay". Writes the summary as JSON to the standard error.
+  /// @return process exit code: 0 if all games are valid, 1 if a game has an invalid move
+  int RunReplay(Logger logger, const std::vector<std::string>& args);
+}
@@ -0,0 +1,66 @@
+#include <stdafx.h>
+
+#include "Engine.h"
+#include "..\Evaluation\PawnStructure.h"
+
+namespace JC
+{
+  CEngine::CEngine(const SEngineOptions& options)
+    : m_options(options)
+  {
+    if (options.m_evaluator == "pawns")
+    {
+      m_evaluator = std::make_unique<CPawnStructureEvaluator>();
+    }
+    else
+    {
+      m_evaluator = std::make_unique<CMaterialEvaluator>();
+    }
+  }
+
+  SSearchResult CEngine::ChooseMove(const CChessBoard& board)
+  {
+    CSearch search(*m_evaluator);
+    return search.Search(board, m_options.m_depth);
+  }
+
+  bool CEngine::ParseOptions(std::string_view text, SEngineOptions& options)
+  {
+    std::size_t pos = 0;
+    while (pos < text.size())
+    {
+      const std::size_t end = std::min(text.find(',', pos), text.size());
+      const std::string_view setting = text.substr(pos, end - pos);
+      const std::size_t equal = setting.find('=');
+      if (equal == std::string_view::npos)
+      {
+        return false;
+      }
+      const std::string_view name = setting.substr(0, equal);
+      const std::string value(setting.substr(equal + 1));
+      if (name == "depth")
+      {
+        options.m_depth = static_cast<std::size_t>(std::atoi(value.c_str()));
+        if (options.m_depth == 0)
+        {
+          return false;
+        }
+      }
+      else if (name == "eval" && (value == "material" || value == "pawns"))
+      {
+        options.m_evaluator = value;
+      }
+      else
+      {
+        return false;
+      }
+      pos = end + 1;
+    }
+    return true;
+  }
+
+  std::string CEngine::OptionsToString(const SEngineOptions& options)
+  {
+    return "depth=" + std::to_string(options.m_depth) + ",eval=" + options.m_evaluator;
+  }
+}
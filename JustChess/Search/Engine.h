@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Search.h"
+
+namespace JC
+{
+  /// @brief Configuration of a @c CEngine
+  struct SEngineOptions
+  {
+    /// @brief Static evaluation: "material" (@c CMaterialEvaluator) or "pawns" (@c CPawnStructureEvaluator)
+    std::string m_evaluator = "material";
+    /// @brief Search depth in plies
+    std::size_t m_depth = 2;
+  };
+
+  /*!******************************************************************
+  * @class CEngine
+  *
+  * @ingroup search
+  *
+  * @brief Plays moves with a @c CSearch and a configurable evaluation.
+  *
+  * @details Engines are configured with a short text, e.g. "depth=3,eval=pawns"
+  * (see @c ParseOptions()). An engine is used by one thread at a time.
+  ********************************************************************/
+  class CEngine
+  {
+  public:
+    explicit CEngine(const SEngineOptions& options);
+
+    /// @brief Searches the move for the side to move of a board.
+    /// @return search result, without best move if the game is over
+    SSearchResult ChooseMove(const CChessBoard& board);
+
+    const SEngineOptions& GetOptions() const { return m_options; }
+    /// @return static evaluation of the engine, e.g. for an own @c CSearch
+    const IEvaluator& GetEvaluator() const { return *m_evaluator; }
+
+    /// @brief Parses comma separated settings "depth=N" and "eval=material|pawns".
+    /// @return @c false if a setting is unknown or invalid
+    static bool ParseOptions(std::string_view text, SEngineOptions& options);
+
+    /// @return settings as accepted by @c ParseOptions()
+    static std::string OptionsToString(const SEngineOptions& options);
+
+  private:
+    SEngineOptions m_options;
+    std::unique_ptr<IEvaluator> m_evaluator;
+  };
+}
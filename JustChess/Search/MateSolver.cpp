@@ -0,0 +1,470 @@
+#include <stdafx.h>
+
+#include "MateSolver.h"
+#include "..\Functional\Notation\Notation.h"
+#include "..\Profiling\Profiler.h"
+#include "..\Profiling\Tracer.h"
+
+namespace JC
+{
+  namespace
+  {
+    constexpr uint64_t NODE_COUNT_INTERVAL = 1024;
+
+    uint32_t Saturate(uint64_t value, uint32_t limit)
+    {
+      return static_cast<uint32_t>(std::min<uint64_t>(value, limit));
+    }
+  }
+
+  CMateSolver::CMateSolver(Logger logger, const SMateSolverOptions& options)
+    : m_logger(logger)
+    , m_options(options)
+    , m_pool(options.m_threads)
+    , m_stop(false)
+    , m_nodes(0)
+    , m_limitReached(false)
+    , m_attackerWhite(true)
+  {
+    // number of buckets is a power of two
+    const std::size_t bytes = std::max<std::size_t>(m_options.m_tableMb, 1) << 20;
+    std::size_t buckets = 1;
+    while (buckets * 2 * BUCKET_SIZE * sizeof(SEntry) <= bytes)
+    {
+      buckets *= 2;
+    }
+    m_table.resize(buckets * BUCKET_SIZE);
+    m_bucketMask = buckets - 1;
+
+    m_threads.resize(m_pool.GetThreadCount());
+    for (std::size_t ind = 0; ind < m_threads.size(); ind++)
+    {
+      m_threads[ind].m_index = ind;
+    }
+  }
+
+  void CMateSolver::Clear()
+  {
+    std::fill(m_table.begin(), m_table.end(), SEntry{});
+  }
+
+  SMateResult CMateSolver::Solve(const CChessBoard& board, std::size_t maxMoves)
+  {
+    JC_PROFILE_ZONE("CMateSolver::Solve");
+    JC_TRACE_SCOPE("CMateSolver::Solve");
+    const auto start = std::chrono::steady_clock::now();
+    m_nodes = 0;
+    m_limitReached = false;
+    m_attackerWhite = board.IsWhiteToMove();
+    const std::size_t limit = std::min<std::size_t>(std::max<std::size_t>(maxMoves, 1),
+      std::numeric_limits<uint16_t>::max() / 2);
+
+    SMateResult result;
+    for (std::size_t moves = 1; moves <= limit; moves++)
+    {
+      const uint16_t plies = static_cast<uint16_t>(2 * moves - 1);
+      // 0: not finished, 1: proven, 2: disproven
+      std::atomic<int> rootState = 0;
+      m_stop = false;
+      for (auto& thread : m_threads)
+      {
+        PrepareThread(thread, board, plies);
+        m_pool.Submit([this, &thread, &rootState, plies]()
+        {
+          const SNumbers numbers = Prove(thread, 0, plies);
+          if (numbers.m_pn == 0 || numbers.m_dn == 0)
+          {
+            rootState = numbers.m_pn == 0 ? 1 : 2;
+            m_stop = true;
+          }
+          CountNodes(thread);
+        });
+      }
+      m_pool.WaitIdle();
+      m_stop = false;
+
+      result.m_moves = moves;
+      if (rootState == 1)
+      {
+        result.m_result = eMateResult::eMate;
+        ExtractLine(m_threads.front(), plies, result.m_line);
+        break;
+      }
+      if (rootState == 0)
+      {
+        result.m_result = eMateResult::eUnknown;
+        break;
+      }
+      result.m_result = eMateResult::eNoMate;
+      if (m_limitReached)
+      {
+        break;
+      }
+    }
+
+    CountNodes(m_threads.front());
+    result.m_nodes = m_nodes;
+    result.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+  }
+
+  CMateSolver::SNumbers CMateSolver::Prove(SThread& thread, std::size_t ply, uint16_t plies)
+  {
+    if (const auto terminal = TerminalNumbers(thread.m_boards[ply], ply % 2 == 0, plies))
+    {
+      return *terminal;
+    }
+    return SearchNode(thread, ply, plies, INFINITE, INFINITE);
+  }
+
+  CMateSolver::SNumbers CMateSolver::SearchNode(SThread& thread, std::size_t ply, uint16_t plies,
+    uint32_t thresholdPn, uint32_t thresholdDn)
+  {
+    if (++thread.m_nodes % NODE_COUNT_INTERVAL == 0)
+    {
+      CountNodes(thread);
+    }
+    const bool attacker = ply % 2 == 0;
+    const uint64_t key = thread.m_boards[ply].GetPositionKey();
+    Expand(thread, ply, plies);
+    std::vector<SChild>& children = thread.m_children[ply];
+
+    SNumbers numbers{ 0, 0 };
+    while (true)
+    {
+      // OR node (attacker): pn is the minimum, dn the sum of the children; AND node vice versa
+      uint64_t sum = 0;
+      uint32_t best = INFINITE + 1;
+      uint32_t second = INFINITE + 1;
+      std::size_t bestInd = 0;
+      for (std::size_t count = 0; count < children.size(); count++)
+      {
+        // threads start at different children, so they break ties differently
+        const std::size_t ind = (count + thread.m_index) % children.size();
+        SChild& child = children[ind];
+        SNumbers stored;
+        if (!child.m_terminal && Lookup(child.m_key, plies - 1, stored))
+        {
+          if (stored.m_pn == 0 || stored.m_dn == 0)
+          {
+            child.m_numbers = stored;
+          }
+          else if (child.m_numbers.m_pn != 0 && child.m_numbers.m_dn != 0)
+          {
+            // another thread may have stored older numbers of the child
+            child.m_numbers.m_pn = std::max(child.m_numbers.m_pn, stored.m_pn);
+            child.m_numbers.m_dn = std::max(child.m_numbers.m_dn, stored.m_dn);
+          }
+        }
+        const uint32_t minimized = attacker ? child.m_numbers.m_pn : child.m_numbers.m_dn;
+        sum += attacker ? child.m_numbers.m_dn : child.m_numbers.m_pn;
+        if (minimized < best)
+        {
+          second = best;
+          best = minimized;
+          bestInd = ind;
+        }
+        else if (minimized < second)
+        {
+          second = minimized;
+        }
+      }
+      numbers.m_pn = attacker ? best : Saturate(sum, INFINITE);
+      numbers.m_dn = attacker ? Saturate(sum, INFINITE) : best;
+      if (numbers.m_pn >= thresholdPn || numbers.m_dn >= thresholdDn || m_stop.load(std::memory_order_relaxed))
+      {
+        break;
+      }
+
+      SChild& child = children[bestInd];
+      uint32_t childPn;
+      uint32_t childDn;
+      if (attacker)
+      {
+        childPn = Saturate(std::min<uint64_t>(thresholdPn, uint64_t(second) + 1), INFINITE);
+        childDn = Saturate(uint64_t(thresholdDn) - numbers.m_dn + child.m_numbers.m_dn, INFINITE);
+      }
+      else
+      {
+        childPn = Saturate(uint64_t(thresholdPn) - numbers.m_pn + child.m_numbers.m_pn, INFINITE);
+        childDn = Saturate(std::min<uint64_t>(thresholdDn, uint64_t(second) + 1), INFINITE);
+      }
+      SetChild(thread, ply, child.m_move);
+      child.m_numbers = SearchNode(thread, ply + 1, plies - 1, childPn, childDn);
+    }
+    Store(key, plies, numbers);
+    return numbers;
+  }
+
+  void CMateSolver::Expand(SThread& thread, std::size_t ply, uint16_t plies)
+  {
+    const CChessBoard& board = thread.m_boards[ply];
+    const bool attacker = ply % 2 == 0;
+    std::vector<SChild>& children = thread.m_children[ply];
+    children.clear();
+    thread.m_moves.clear();
+    board.GetAllValidMoves(board.IsWhiteToMove(), thread.m_moves);
+    for (const auto& move : thread.m_moves)
+    {
+      SetChild(thread, ply, move);
+      const CChessBoard& childBoard = thread.m_boards[ply + 1];
+      SChild child;
+      child.m_move = move;
+      child.m_key = childBoard.GetPositionKey();
+      const std::size_t validMoves = childBoard.CountValidMoves(childBoard.IsWhiteToMove());
+      const auto terminal = TerminalNumbers(childBoard, !attacker, static_cast<uint16_t>(plies - 1), validMoves);
+      child.m_terminal = terminal.has_value();
+      if (terminal)
+      {
+        child.m_numbers = *terminal;
+      }
+      else
+      {
+        // all moves of the defender have to be proven, all moves of the attacker disproven
+        const uint32_t moves = static_cast<uint32_t>(validMoves);
+        child.m_numbers = attacker ? SNumbers{ moves, 1 } : SNumbers{ 1, moves };
+      }
+      children.push_back(child);
+    }
+  }
+
+  std::optional<CMateSolver::SNumbers> CMateSolver::TerminalNumbers(const CChessBoard& board, bool attacker,
+    uint16_t plies, std::size_t validMoves)
+  {
+    const SNumbers proven{ 0, INFINITE };
+    const SNumbers disproven{ INFINITE, 0 };
+    if (validMoves == 0)
+    {
+      // checkmate of the defender proves, any other end of the game disproves
+      return (!attacker && board.IsChecked(board.IsWhiteToMove())) ? proven : disproven;
+    }
+    if (plies == 0 || board.MaterialInsufficient())
+    {
+      return disproven;
+    }
+    return std::nullopt;
+  }
+
+  std::optional<uint16_t> CMateSolver::FindMatePlies(SThread& thread, std::size_t ply, uint16_t maxPlies)
+  {
+    for (uint16_t plies = maxPlies % 2; plies <= maxPlies; plies += 2)
+    {
+      if (Prove(thread, ply, plies).m_pn == 0)
+      {
+        return plies;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void CMateSolver::ExtractLine(SThread& thread, uint16_t plies, std::vector<SMove>& line)
+  {
+    line.clear();
+    std::vector<SMove> moves;
+    for (std::size_t ply = 0; plies > 0 && !m_limitReached; ply++)
+    {
+      const bool attacker = ply % 2 == 0;
+      const CChessBoard& board = thread.m_boards[ply];
+      moves.clear();
+      board.GetAllValidMoves(board.IsWhiteToMove(), moves);
+      std::optional<SMove> bestMove;
+      uint16_t bestPlies = 0;
+      for (const auto& move : moves)
+      {
+        SetChild(thread, ply, move);
+        const auto childPlies = FindMatePlies(thread, ply + 1, static_cast<uint16_t>(plies - 1));
+        if (!childPlies && !attacker)
+        {
+          return; // defence against the mate, only possible if the node limit was reached
+        }
+        if (childPlies && (!bestMove || (attacker ? *childPlies < bestPlies : *childPlies > bestPlies)))
+        {
+          bestMove = move;
+          bestPlies = *childPlies;
+        }
+      }
+      if (!bestMove)
+      {
+        return;
+      }
+      SetChild(thread, ply, *bestMove);
+      line.push_back(*bestMove);
+      plies = bestPlies;
+    }
+  }
+
+  void CMateSolver::SetChild(SThread& thread, std::size_t ply, const SMove& move) const
+  {
+    CChessBoard& child = thread.m_boards[ply + 1];
+    child = thread.m_boards[ply];
+    child.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, child.IsWhiteToMove());
+  }
+
+  void CMateSolver::PrepareThread(SThread& thread, const CChessBoard& board, uint16_t plies) const
+  {
+    while (thread.m_boards.size() < std::size_t(plies) + 2)
+    {
+      thread.m_boards.emplace_back(m_logger);
+    }
+    if (thread.m_children.size() < std::size_t(plies) + 1)
+    {
+      thread.m_children.resize(std::size_t(plies) + 1);
+    }
+    thread.m_boards.front().Restore(board.Snapshot());
+  }
+
+  std::size_t CMateSolver::BucketIndex(uint64_t key, uint16_t plies) const
+  {
+    return static_cast<std::size_t>(HashMix(key ^ plies) & m_bucketMask);
+  }
+
+  bool CMateSolver::Lookup(uint64_t key, uint16_t plies, SNumbers& numbers) const
+  {
+    // the same position is an OR node for one attacker and an AND node for the other
+    key ^= m_attackerWhite ? 0 : HashMix(0x3000);
+    const std::size_t bucket = BucketIndex(key, plies);
+    std::lock_guard<std::mutex> lock(m_locks[bucket % LOCK_STRIPES]);
+    for (std::size_t ind = 0; ind < BUCKET_SIZE; ind++)
+    {
+      const SEntry& entry = m_table[bucket * BUCKET_SIZE + ind];
+      if (entry.m_used && entry.m_key == key && entry.m_plies == plies)
+      {
+        numbers = entry.m_numbers;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void CMateSolver::Store(uint64_t key, uint16_t plies, SNumbers numbers)
+  {
+    key ^= m_attackerWhite ? 0 : HashMix(0x3000);
+    const std::size_t bucket = BucketIndex(key, plies);
+    std::lock_guard<std::mutex> lock(m_locks[bucket % LOCK_STRIPES]);
+    // same position, else a free entry, else the unsolved entry with the least work (smallest numbers).
+    // A proven or disproven entry is never replaced by unsolved numbers, e.g. of a search stopped by m_stop.
+    const bool solved = numbers.m_pn == 0 || numbers.m_dn == 0;
+    SEntry* target = nullptr;
+    uint64_t targetWork = std::numeric_limits<uint64_t>::max();
+    for (std::size_t ind = 0; ind < BUCKET_SIZE; ind++)
+    {
+      SEntry& entry = m_table[bucket * BUCKET_SIZE + ind];
+      const bool entrySolved = entry.m_numbers.m_pn == 0 || entry.m_numbers.m_dn == 0;
+      if (!entry.m_used || (entry.m_key == key && entry.m_plies == plies))
+      {
+        target = &entry;
+        targetWork = entry.m_used && entrySolved ? uint64_t(INFINITE) * 2 : 0;
+        break;
+      }
+      const uint64_t work = (entrySolved ? uint64_t(INFINITE) * 2 : 0) +
+        entry.m_numbers.m_pn + entry.m_numbers.m_dn;
+      if (work < targetWork)
+      {
+        target = &entry;
+        targetWork = work;
+      }
+    }
+    if (!solved && targetWork >= uint64_t(INFINITE) * 2)
+    {
+      return;
+    }
+    target->m_key = key;
+    target->m_plies = plies;
+    target->m_numbers = numbers;
+    target->m_used = true;
+  }
+
+  void CMateSolver::CountNodes(SThread& thread)
+  {
+    if (m_nodes.fetch_add(thread.m_nodes) + thread.m_nodes > m_options.m_maxNodes)
+    {
+      m_limitReached = true;
+      m_stop = true;
+    }
+    thread.m_nodes = 0;
+  }
+
+  bool CMateSolver::ParseArgs(const std::vector<std::string>& args, SMateSolverOptions& options,
+    std::size_t& maxMoves, std::vector<std::string>& positional)
+  {
+    for (std::size_t ind = 1; ind < args.size(); ind++)
+    {
+      const std::string& arg = args[ind];
+      if (arg.rfind("--", 0) != 0)
+      {
+        positional.push_back(arg);
+        continue;
+      }
+      if (ind + 1 >= args.size())
+      {
+        return false; // every option has a value
+      }
+      uint64_t value;
+      try
+      {
+        value = std::stoull(args[++ind]);
+      }
+      catch (const std::exception&)
+      {
+        return false;
+      }
+      if (arg == "--moves" && value >= 1)
+      {
+        maxMoves = static_cast<std::size_t>(value);
+      }
+      else if (arg == "--threads")
+      {
+        options.m_threads = static_cast<std::size_t>(value);
+      }
+      else if (arg == "--hash" && value >= 1)
+      {
+        options.m_tableMb = static_cast<std::size_t>(value);
+      }
+      else if (arg == "--nodes" && value >= 1)
+      {
+        options.m_maxNodes = value;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int RunMateSolver(Logger logger, const std::vector<std::string>& args)
+  {
+    SMateSolverOptions options;
+    std::size_t maxMoves = 3;
+    std::vector<std::string> positional;
+    // the FEN consists of several words
+    std::string fen;
+    SPosition position;
+    if (CMateSolver::ParseArgs(args, options, maxMoves, positional))
+    {
+      for (const auto& word : positional)
+      {
+        fen += (fen.empty() ? "" : " ") + word;
+      }
+    }
+    if (fen.empty() || !ParseFen(fen, position))
+    {
+      std::cerr << "Usage: JustChess mate FEN [--moves N] [--threads N] [--hash MB] [--nodes N]" << std::endl;
+      return 2;
+    }
+
+    CChessBoard board(logger, position);
+    CMateSolver solver(logger, options);
+    const SMateResult result = solver.Solve(board, maxMoves);
+    std::cout << "{\n  \"result\": \"" <<
+      (result.m_result == eMateResult::eMate ? "mate" : (result.m_result == eMateResult::eNoMate ? "no-mate" : "unknown"))
+      << "\",\n  \"moves\": " << result.m_moves << ",\n  \"line\": \"";
+    for (std::size_t ind = 0; ind < result.m_line.size(); ind++)
+    {
+      std::cout << (ind > 0 ? " " : "") << MoveToString(result.m_line[ind]);
+    }
+    std::cout << "\",\n  \"nodes\": " << result.m_nodes
+              << ",\n  \"seconds\": " << result.m_seconds << "\n}" << std::endl;
+    return result.m_result == eMateResult::eUnknown ? 1 : 0;
+  }
+}
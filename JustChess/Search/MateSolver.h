@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Functional/ChessBoard/ChessBoard.h"
+#include "Concurrency/WorkerPool.h"
+
+namespace JC
+{
+  /// @brief Settings of a @c CMateSolver
+  struct SMateSolverOptions
+  {
+    /// @brief Threads searching the same position; 0 for one per hardware thread
+    std::size_t m_threads = 0;
+    /// @brief Size of the shared transposition table in MiB
+    std::size_t m_tableMb = 64;
+    /// @brief The search gives up after this number of nodes (all threads together)
+    uint64_t m_maxNodes = 20000000;
+  };
+
+  /// @brief Outcome of a mate search
+  enum class eMateResult : uint8_t
+  {
+    /// @brief The side to move mates in @c SMateResult::m_moves moves
+    eMate = 0,
+    /// @brief Proven that there is no mate within @c SMateResult::m_moves moves
+    eNoMate,
+    /// @brief Node limit reached before the search was finished
+    eUnknown
+  };
+
+  /// @brief Result of @c CMateSolver::Solve()
+  struct SMateResult
+  {
+    eMateResult m_result = eMateResult::eUnknown;
+    /// @brief Moves of the side to move until the mate, or the searched moves if there is no mate
+    std::size_t m_moves = 0;
+    /// @brief Mating line: fastest mate of the attacker against the longest defence
+    std::vector<SMove> m_line;
+    uint64_t m_nodes = 0;
+    double m_seconds = 0.0;
+  };
+
+  /*!******************************************************************
+  * @class CMateSolver
+  *
+  * @ingroup search
+  *
+  * @brief Finds forced mates with depth-first proof-number search (df-pn).
+  *
+  * @details The side to move is the attacker (OR nodes), the other side the
+  * defender (AND nodes). A node is proven if the attacker mates within the
+  * remaining plies and disproven otherwise. Proof and disproof numbers of all
+  * visited nodes are stored in a transposition table keyed by
+  * @c CChessBoard::GetPositionKey() and the remaining plies, so the search only
+  * keeps the current line on its stack. Mates in 1, 2, ... N moves are
+  * searched one after another, so the first proof is the fastest mate.
+  *
+  * All threads search the same root and share the table (locked per stripe
+  * of buckets). They break ties between equal children differently, so they
+  * explore different parts of the tree and profit from each other's results.
+  * The first thread finishing the root stops the others.
+  *
+  * After a proof, the line is extracted by proving every move along it again
+  * with fewer plies: the attacker plays the fastest mate, the defender the
+  * longest resistance.
+  *
+  * <b>Example:</b>
+  * @code
+  * CMateSolver solver(logger, SMateSolverOptions{});
+  * SMateResult result = solver.Solve(board, 3);
+  * if (result.m_result == eMateResult::eMate) { ... result.m_line ... }
+  * @endcode
+  ********************************************************************/
+  class CMateSolver
+  {
+  public:
+    CMateSolver(Logger logger, const SMateSolverOptions& options);
+
+    /// @brief Searches a mate of the side to move.
+    /// @param board position (side to move is taken from the board)
+    /// @param maxMoves maximum moves of the side to move until the mate
+    SMateResult Solve(const CChessBoard& board, std::size_t maxMoves);
+
+    /// @brief Removes all entries of the transposition table.
+    void Clear();
+
+    /// @return number of threads searching together (@c m_threads resolved by the worker pool)
+    std::size_t GetThreadCount() const { return m_pool.GetThreadCount(); }
+
+    /// @brief Parses the options of the commands "mate" and "mate-bench".
+    /// @param args arguments, those which are not options are appended to @p positional
+    /// @param maxMoves value of "--moves"
+    /// @return @c false if an option is invalid
+    static bool ParseArgs(const std::vector<std::string>& args, SMateSolverOptions& options,
+      std::size_t& maxMoves, std::vector<std::string>& positional);
+
+  private:
+    /// @brief Proof and disproof number of a node
+    struct SNumbers
+    {
+      uint32_t m_pn;
+      uint32_t m_dn;
+    };
+
+    /// @brief Entry of the transposition table
+    struct SEntry
+    {
+      uint64_t m_key = 0;
+      SNumbers m_numbers{ 0, 0 };
+      uint16_t m_plies = 0;
+      bool m_used = false;
+    };
+
+    /// @brief Child of the expanded node of one ply
+    struct SChild
+    {
+      SMove m_move;
+      uint64_t m_key;
+      SNumbers m_numbers;
+      /// @brief Numbers are final (mate, stalemate, no plies left) without a table entry
+      bool m_terminal;
+    };
+
+    /// @brief Boards and children of the line searched by one thread
+    struct SThread
+    {
+      std::size_t m_index = 0;
+      std::vector<CChessBoard> m_boards;
+      std::vector<std::vector<SChild>> m_children;
+      std::vector<SMove> m_moves;
+      uint64_t m_nodes = 0;
+    };
+
+    static constexpr uint32_t INFINITE = uint32_t(1) << 30;
+    static constexpr std::size_t BUCKET_SIZE = 4;
+    static constexpr std::size_t LOCK_STRIPES = 256;
+
+    /// @brief Searches the node at @p ply of the thread until its numbers reach a threshold.
+    /// @param plies remaining plies at this node
+    SNumbers SearchNode(SThread& thread, std::size_t ply, uint16_t plies, uint32_t thresholdPn, uint32_t thresholdDn);
+
+    /// @brief Proves or disproves the position at @p ply completely.
+    /// @return numbers of the position; neither is 0 if the search was stopped
+    SNumbers Prove(SThread& thread, std::size_t ply, uint16_t plies);
+
+    /// @brief Fewest plies (of the parity of @p maxPlies) within which the position at @p ply is proven.
+    /// @return plies, or @c std::nullopt if not proven within @p maxPlies
+    std::optional<uint16_t> FindMatePlies(SThread& thread, std::size_t ply, uint16_t maxPlies);
+
+    /// @brief Extracts the mating line of a proven root.
+    void ExtractLine(SThread& thread, uint16_t plies, std::vector<SMove>& line);
+
+    /// @brief Sets the board at ply + 1 to the position after a move at ply
+    /// (a copy of the board at ply, so its buffers are reused).
+    void SetChild(SThread& thread, std::size_t ply, const SMove& move) const;
+
+    /// @brief Generates the children of the node at @p ply with their initial numbers.
+    void Expand(SThread& thread, std::size_t ply, uint16_t plies);
+
+    /// @brief Numbers of a position which is final without search, if any.
+    /// @param attacker @c true if the attacker is to move at the position
+    /// @param validMoves @c CChessBoard::CountValidMoves() of the side to move
+    static std::optional<SNumbers> TerminalNumbers(const CChessBoard& board, bool attacker, uint16_t plies,
+      std::size_t validMoves);
+    static std::optional<SNumbers> TerminalNumbers(const CChessBoard& board, bool attacker, uint16_t plies)
+    {
+      return TerminalNumbers(board, attacker, plies, board.CountValidMoves(board.IsWhiteToMove()));
+    }
+
+    /// @brief Resizes the boards and children of a thread for a search of @p plies.
+    void PrepareThread(SThread& thread, const CChessBoard& board, uint16_t plies) const;
+
+    bool Lookup(uint64_t key, uint16_t plies, SNumbers& numbers) const;
+    void Store(uint64_t key, uint16_t plies, SNumbers numbers);
+    std::size_t BucketIndex(uint64_t key, uint16_t plies) const;
+
+    /// @brief Adds the nodes of a thread to the shared count and checks the limit.
+    void CountNodes(SThread& thread);
+
+    Logger m_logger;
+    SMateSolverOptions m_options;
+    std::vector<SEntry> m_table;
+    std::size_t m_bucketMask;
+    mutable std::array<std::mutex, LOCK_STRIPES> m_locks;
+    std::vector<SThread> m_threads;
+    CWorkerPool m_pool;
+    std::atomic<bool> m_stop;
+    std::atomic<uint64_t> m_nodes;
+    std::atomic<bool> m_limitReached;
+    /// @brief Color of the attacker of the current search (part of the table keys)
+    bool m_attackerWhite;
+  };
+
+  /// @brief Entry point of the command "mate": searches a mate in a FEN position.
+  /// @return process exit code
+  int RunMateSolver(Logger logger, const std::vector<std::string>& args);
+}
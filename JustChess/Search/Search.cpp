@@ -0,0 +1,103 @@
+#include <stdafx.h>
+
+#include "Search.h"
+#include "..\Profiling\Profiler.h"
+#include "..\Profiling\Tracer.h"
+
+namespace JC
+{
+  SSearchResult CSearch::Search(const CChessBoard& board, std::size_t depth)
+  {
+    JC_PROFILE_ZONE("CSearch::Search");
+    JC_TRACE_SCOPE("CSearch::Search");
+    m_nodes = 0;
+    m_stopped = false;
+    SSearchResult result;
+    result.m_depth = std::max<std::size_t>(depth, 1);
+    // boards are only created by the first search of a depth; later searches reuse them
+    while (m_boards.size() < result.m_depth + 1)
+    {
+      m_boards.push_back(board);
+    }
+    if (m_moves.size() < result.m_depth + 1)
+    {
+      m_moves.resize(result.m_depth + 1);
+    }
+    m_boards.front().Restore(board.Snapshot(), board.GetHistory());
+    result.m_score = Negamax(result.m_depth, -MATE_SCORE - 1, MATE_SCORE + 1, 0, &result.m_bestMove);
+    result.m_nodes = m_nodes;
+    result.m_complete = !m_stopped;
+    return result;
+  }
+
+  int CSearch::Negamax(std::size_t depth, int alpha, int beta, int ply, std::optional<SMove>* bestMove)
+  {
+    m_nodes++;
+    // the clock is read only every 1024 nodes
+    if (m_deadline && m_nodes % 1024 == 0 && std::chrono::steady_clock::now() >= *m_deadline)
+    {
+      m_stopped = true;
+    }
+    if (m_stopped)
+    {
+      return 0;
+    }
+    const CChessBoard& board = m_boards[ply];
+    const bool whiteToMove = board.IsWhiteToMove();
+    switch (board.GetGameStatus())
+    {
+    case eGameStatus::eCheckmate:
+      return -MATE_SCORE + ply;
+    case eGameStatus::eStalemate:
+    case eGameStatus::eThreefoldRepetition:
+    case eGameStatus::eFiftyMoves:
+    case eGameStatus::eInsufficientMaterial:
+      return 0;
+    default:
+      break;
+    }
+    if (depth == 0)
+    {
+      const int score = m_evaluator.Evaluate(board.Snapshot());
+      return whiteToMove ? score : -score;
+    }
+
+    std::vector<SMove>& moves = m_moves[ply];
+    moves.clear();
+    board.GetAllValidMoves(whiteToMove, moves);
+    // captures first, they cause most cutoffs
+    const auto& squares = board.GetBoard();
+    std::stable_partition(moves.begin(), moves.end(), [&squares](const SMove& move)
+    {
+      return squares[SquareIndex(move.m_toRank, move.m_toFile)] != NO_PIECE;
+    });
+
+    int best = -MATE_SCORE - 1;
+    for (const auto& move : moves)
+    {
+      // the record of the child is only as long as the line from the root, so copying reuses its buffer
+      CChessBoard& child = m_boards[ply + 1];
+      child = board;
+      child.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, whiteToMove);
+      const int score = -Negamax(depth - 1, -beta, -alpha, ply + 1, nullptr);
+      if (m_stopped)
+      {
+        return 0;
+      }
+      if (score > best)
+      {
+        best = score;
+        if (bestMove)
+        {
+          *bestMove = move;
+        }
+      }
+      alpha = std::max(alpha, score);
+      if (alpha >= beta)
+      {
+        break;
+      }
+    }
+    return best;
+  }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Evaluation/Evaluator.h"
+
+/**
+ *  @defgroup search Search
+ */
+
+namespace JC
+{
+  /// @brief Score of a checkmate at the root; mates in more plies score less
+  constexpr int MATE_SCORE = 30000;
+
+  /// @brief Result of a search
+  struct SSearchResult
+  {
+    /// @brief Best move, @c std::nullopt if the side to move has no valid move
+    std::optional<SMove> m_bestMove;
+    /// @brief Score in centipawns from the point of view of the side to move
+    int m_score = 0;
+    std::size_t m_depth = 0;
+    /// @brief Number of positions visited
+    uint64_t m_nodes = 0;
+    /// @brief @c false if the search was stopped at the deadline; best move and score are not valid then
+    bool m_complete = true;
+  };
+
+  /*!******************************************************************
+  * @class CSearch
+  *
+  * @ingroup search
+  *
+  * @brief Fixed-depth alpha-beta search.
+  *
+  * @details Negamax with alpha-beta pruning; captures are searched first.
+  * Leaves are scored by an @c IEvaluator, finished games by
+  * @c CChessBoard::GetGameStatus() (checkmate @c MATE_SCORE minus the plies to
+  * the mate, draws 0). The search has one board per ply, which is set to the
+  * board of the parent node and the move; the root board is restored from
+  * the searched board with its shared history (@c CChessBoard::GetHistory()),
+  * so repetitions are detected and the searched board is not changed. The
+  * boards and move lists are kept between searches, so nodes don't allocate. With a deadline (@c SetDeadline()) a search
+  * can be stopped early, e.g. for iterative deepening within a time limit.
+  *
+  * <b>Example:</b>
+  * @code
+  * CMaterialEvaluator evaluator;
+  * CSearch search(evaluator);
+  * SSearchResult result = search.Search(board, 3);
+  * @endcode
+  ********************************************************************/
+  class CSearch
+  {
+  public:
+    explicit CSearch(const IEvaluator& evaluator)
+      : m_evaluator(evaluator)
+      , m_nodes(0)
+      , m_stopped(false)
+    {}
+
+    /// @brief Searches the position of a board to a fixed depth.
+    /// @param board position to search (side to move is taken from the board)
+    /// @param depth plies to search, at least 1
+    SSearchResult Search(const CChessBoard& board, std::size_t depth);
+
+    /// @brief Searches which are not finished at the deadline are stopped
+    /// (see @c SSearchResult::m_complete). @c std::nullopt for no deadline.
+    void SetDeadline(std::optional<std::chrono::steady_clock::time_point> deadline) { m_deadline = deadline; }
+
+  private:
+    /// @brief Searches the board at @p ply.
+    /// @return score from the point of view of the side to move
+    int Negamax(std::size_t depth, int alpha, int beta, int ply, std::optional<SMove>* bestMove);
+
+    const IEvaluator& m_evaluator;
+    /// @brief Board of each ply of the current line
+    std::vector<CChessBoard> m_boards;
+    /// @brief Valid moves of each ply of the current line
+    std::vector<std::vector<SMove>> m_moves;
+    uint64_t m_nodes;
+    std::optional<std::chrono::steady_clock::time_point> m_deadline;
+    bool m_stopped;
+  };
+}
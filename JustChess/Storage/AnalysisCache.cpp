@@ -0,0 +1,208 @@
+#include <stdafx.h>
+
+#include "AnalysisCache.h"
+#include "..\Profiling\Profiler.h"
+
+namespace JC
+{
+  namespace
+  {
+    constexpr char MAGIC[4] = { 'J', 'C', 'A', 'C' };
+    constexpr std::size_t HEADER_SIZE = 64;
+    constexpr std::size_t BUCKET_SIZE = 64;
+    /// @brief Timestamps are stored in minutes since 2024-01-01 (28 bits last until 2534)
+    constexpr std::time_t TIME_ORIGIN = 1704067200;
+    constexpr uint64_t TIME_MASK = (uint64_t(1) << 28) - 1;
+
+    struct SHeader
+    {
+      char m_magic[4];
+      uint32_t m_version;
+      uint64_t m_buckets;
+    };
+    static_assert(sizeof(SHeader) <= HEADER_SIZE);
+
+    /// @brief Priority of an entry to stay in the cache: depth minus age in days
+    int64_t KeepPriority(const SAnalysis& analysis, std::time_t now)
+    {
+      return static_cast<int64_t>(analysis.m_depth) - (now - analysis.m_timestamp) / (24 * 60 * 60);
+    }
+  }
+
+  CAnalysisCache::~CAnalysisCache()
+  {
+    Close();
+  }
+
+  bool CAnalysisCache::Open(const std::string& path, std::size_t sizeBytes)
+  {
+    Close();
+    std::size_t buckets = 1;
+    while (HEADER_SIZE + 2 * buckets * BUCKET_SIZE <= sizeBytes)
+    {
+      buckets *= 2;
+    }
+    const std::size_t fileSize = HEADER_SIZE + buckets * BUCKET_SIZE;
+
+    // use an existing cache if it has the expected layout
+    if (m_file.Open(path, eMapMode::readWrite) && m_file.GetSize() == fileSize)
+    {
+      const auto* header = reinterpret_cast<const SHeader*>(m_file.GetData());
+      if (std::memcmp(header->m_magic, MAGIC, sizeof(MAGIC)) == 0 &&
+          header->m_version == VERSION && header->m_buckets == buckets)
+      {
+        m_buckets = buckets;
+        return true;
+      }
+    }
+    if (m_file.IsOpen())
+    {
+      JC_LOG_WARNING(m_logger, "Analysis cache is recreated: " + path);
+      m_file.Close();
+    }
+
+    if (!m_file.Open(path, eMapMode::readWrite, fileSize))
+    {
+      JC_LOG_ERROR(m_logger, "Analysis cache can not be opened: " + path);
+      return false;
+    }
+    // the magic is written last, so a crash while creating leaves an invalid file
+    std::memset(m_file.GetData(), 0, fileSize);
+    auto* header = reinterpret_cast<SHeader*>(m_file.GetData());
+    header->m_version = VERSION;
+    header->m_buckets = buckets;
+    m_file.Flush(true);
+    std::memcpy(header->m_magic, MAGIC, sizeof(MAGIC));
+    m_file.Flush(true);
+    m_buckets = buckets;
+    return true;
+  }
+
+  void CAnalysisCache::Close()
+  {
+    if (m_file.IsOpen())
+    {
+      m_file.Flush();
+      m_file.Close();
+    }
+    m_buckets = 0;
+  }
+
+  std::optional<SAnalysis> CAnalysisCache::Probe(uint64_t key) const
+  {
+    JC_PROFILE_ZONE("CAnalysisCache::Probe");
+    if (!IsOpen())
+    {
+      return std::nullopt;
+    }
+    m_probes.fetch_add(1, std::memory_order_relaxed);
+    const SEntry* bucket = GetBucket(key);
+    for (std::size_t ind = 0; ind < BUCKET_ENTRIES; ind++)
+    {
+      const uint64_t data = bucket[ind].m_data.load(std::memory_order_relaxed);
+      if (data != 0 && (bucket[ind].m_check.load(std::memory_order_relaxed) ^ data) == key)
+      {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return Unpack(data);
+      }
+    }
+    return std::nullopt;
+  }
+
+  void CAnalysisCache::Store(uint64_t key, const SAnalysis& analysis)
+  {
+    JC_PROFILE_ZONE("CAnalysisCache::Store");
+    if (!IsOpen())
+    {
+      return;
+    }
+    SEntry* bucket = GetBucket(key);
+    SEntry* target = nullptr;
+    for (std::size_t ind = 0; ind < BUCKET_ENTRIES && !target; ind++)
+    {
+      const uint64_t data = bucket[ind].m_data.load(std::memory_order_relaxed);
+      if (data != 0 && (bucket[ind].m_check.load(std::memory_order_relaxed) ^ data) == key)
+      {
+        if (Unpack(data).m_depth > analysis.m_depth)
+        {
+          return; // keep the deeper analysis
+        }
+        target = &bucket[ind];
+      }
+    }
+    // otherwise an empty entry or the one with the lowest priority to stay
+    bool evicted = false;
+    if (!target)
+    {
+      int64_t lowestPriority = std::numeric_limits<int64_t>::max();
+      for (std::size_t ind = 0; ind < BUCKET_ENTRIES; ind++)
+      {
+        const uint64_t data = bucket[ind].m_data.load(std::memory_order_relaxed);
+        const int64_t priority = data == 0 ? std::numeric_limits<int64_t>::min() :
+          KeepPriority(Unpack(data), analysis.m_timestamp);
+        if (priority < lowestPriority)
+        {
+          target = &bucket[ind];
+          evicted = data != 0;
+          lowestPriority = priority;
+        }
+      }
+    }
+
+    const uint64_t data = Pack(analysis);
+    target->m_data.store(data, std::memory_order_relaxed);
+    target->m_check.store(key ^ data, std::memory_order_relaxed);
+    m_stores.fetch_add(1, std::memory_order_relaxed);
+    if (evicted)
+    {
+      m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void CAnalysisCache::Flush()
+  {
+    m_file.Flush();
+  }
+
+  SAnalysisCacheStatistics CAnalysisCache::GetStatistics() const
+  {
+    SAnalysisCacheStatistics statistics;
+    statistics.m_probes = m_probes.load(std::memory_order_relaxed);
+    statistics.m_hits = m_hits.load(std::memory_order_relaxed);
+    statistics.m_stores = m_stores.load(std::memory_order_relaxed);
+    statistics.m_evictions = m_evictions.load(std::memory_order_relaxed);
+    return statistics;
+  }
+
+  uint64_t CAnalysisCache::Pack(const SAnalysis& analysis)
+  {
+    // bits 0-11 move (never 0, the squares differ), 12-27 score, 28-35 depth, 36-63 minutes
+    const uint64_t move = SquareIndex(analysis.m_bestMove.m_fromRank, analysis.m_bestMove.m_fromFile) |
+                          uint64_t(SquareIndex(analysis.m_bestMove.m_toRank, analysis.m_bestMove.m_toFile)) << 6;
+    const uint64_t minutes = static_cast<uint64_t>(std::max<std::time_t>(analysis.m_timestamp - TIME_ORIGIN, 0) / 60);
+    return move |
+           uint64_t(static_cast<uint16_t>(analysis.m_score)) << 12 |
+           uint64_t(analysis.m_depth) << 28 |
+           std::min(minutes, TIME_MASK) << 36;
+  }
+
+  SAnalysis CAnalysisCache::Unpack(uint64_t data)
+  {
+    SAnalysis analysis;
+    analysis.m_bestMove.m_fromRank = static_cast<eRank>((data >> 3) & 7);
+    analysis.m_bestMove.m_fromFile = static_cast<eFile>(data & 7);
+    analysis.m_bestMove.m_toRank = static_cast<eRank>((data >> 9) & 7);
+    analysis.m_bestMove.m_toFile = static_cast<eFile>((data >> 6) & 7);
+    analysis.m_score = static_cast<int16_t>((data >> 12) & 0xFFFF);
+    analysis.m_depth = static_cast<uint8_t>((data >> 28) & 0xFF);
+    analysis.m_timestamp = TIME_ORIGIN + static_cast<std::time_t>((data >> 36) & TIME_MASK) * 60;
+    return analysis;
+  }
+
+  CAnalysisCache::SEntry* CAnalysisCache::GetBucket(uint64_t key) const
+  {
+    // the high bits select the bucket, so they are independent of the entry words
+    uint8_t* data = const_cast<uint8_t*>(m_file.GetData());
+    return reinterpret_cast<SEntry*>(data + HEADER_SIZE + (key >> 32 & (m_buckets - 1)) * BUCKET_SIZE);
+  }
+}
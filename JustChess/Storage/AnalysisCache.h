@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Logger/LogMacros.h"
+#include "Functional/ChessBoard/ChessBoard.h"
+#include "Platform/MappedFile.h"
+
+/**
+ *  @defgroup storage Storage
+ */
+
+namespace JC
+{
+  /// @brief Analysis result of a position stored in a @c CAnalysisCache
+  struct SAnalysis
+  {
+    SMove m_bestMove;
+    /// @brief Score in centipawns from the point of view of the side to move
+    int16_t m_score;
+    uint8_t m_depth;
+    /// @brief Time of the analysis (seconds since 1970, stored with a resolution of one minute)
+    std::time_t m_timestamp;
+  };
+
+  /// @brief Counters of a @c CAnalysisCache since it was opened
+  struct SAnalysisCacheStatistics
+  {
+    uint64_t m_probes = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_stores = 0;
+    /// @brief Stores which replaced the entry of another position
+    uint64_t m_evictions = 0;
+  };
+
+  /*!******************************************************************
+  * @class CAnalysisCache
+  *
+  * @ingroup storage
+  *
+  * @brief Persistent cache of analysis results, keyed by the position hash.
+  *
+  * @details The cache is a memory-mapped file of fixed size, so it survives
+  * restarts: opening only maps the file and the operating system loads the
+  * pages on first access (from the page cache if the file was used recently).
+  *
+  * The file is a 64 byte header followed by buckets of 4 entries (one cache
+  * line). A position is stored in the bucket of its key. If the bucket is full,
+  * the entry with the lowest depth minus age in days is evicted, so the size
+  * stays bounded and old shallow results go first.
+  *
+  * Each entry consists of two 64 bit words, the packed analysis and the key
+  * xor-ed with the packed analysis. Words are written atomically, so a crash
+  * (or a concurrent store) in the middle of a store leaves at most one entry
+  * whose words don't match; such entries read as missing. No journal or
+  * locking is needed, and any number of threads may probe and store.
+  *
+  * <b>Example:</b>
+  * @code
+  * CAnalysisCache cache(logger);
+  * cache.Open("analysis.jcac", 64 << 20);
+  * if (auto analysis = cache.Probe(board.GetPositionKey()); analysis && analysis->m_depth >= depth) { ... }
+  * cache.Store(board.GetPositionKey(), analysis);
+  * @endcode
+  ********************************************************************/
+  class CAnalysisCache
+  {
+  public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr std::size_t BUCKET_ENTRIES = 4;
+
+    CAnalysisCache(Logger logger)
+      : m_logger(logger)
+      , m_buckets(0)
+    {}
+    ~CAnalysisCache();
+
+    CAnalysisCache(const CAnalysisCache&) = delete;
+    CAnalysisCache& operator=(const CAnalysisCache&) = delete;
+
+    /// @brief Opens the cache file. An existing file of the same size is used as it is;
+    /// a missing, damaged or differently sized file is created empty.
+    /// @param path
+    /// @param sizeBytes size of the file, rounded down to a power of two number of buckets
+    /// @return @c false if the file can't be created or mapped
+    bool Open(const std::string& path, std::size_t sizeBytes);
+
+    /// @brief Writes pending changes and closes the file.
+    void Close();
+
+    bool IsOpen() const { return m_buckets != 0; }
+
+    /// @return the analysis of a position, @c std::nullopt if it isn't cached
+    std::optional<SAnalysis> Probe(uint64_t key) const;
+
+    /// @brief Stores the analysis of a position. An existing analysis of the
+    /// position is only replaced by one of at least the same depth.
+    void Store(uint64_t key, const SAnalysis& analysis);
+
+    /// @brief Starts writing changed pages to disk (they are also written if the process ends).
+    void Flush();
+
+    /// @return number of entries of the file
+    std::size_t GetCapacity() const { return m_buckets * BUCKET_ENTRIES; }
+
+    SAnalysisCacheStatistics GetStatistics() const;
+
+  private:
+    struct SEntry
+    {
+      std::atomic<uint64_t> m_check;
+      std::atomic<uint64_t> m_data;
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "entries are shared through the file");
+
+    static uint64_t Pack(const SAnalysis& analysis);
+    static SAnalysis Unpack(uint64_t data);
+    SEntry* GetBucket(uint64_t key) const;
+
+    Logger m_logger;
+    CMappedFile m_file;
+    std::size_t m_buckets;
+    mutable std::atomic<uint64_t> m_probes{ 0 };
+    mutable std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_stores{ 0 };
+    std::atomic<uint64_t> m_evictions{ 0 };
+  };
+}
@@ -0,0 +1,319 @@
+#include <stdafx.h>
+
+#include "PositionIndex.h"
+#include "..\Concurrency\WorkerPool.h"
+#include "..\Functional\Notation\Notation.h"
+#include "..\Profiling\Profiler.h"
+
+namespace JC
+{
+  namespace
+  {
+    constexpr char MAGIC[4] = { 'J', 'C', 'P', 'I' };
+    constexpr std::size_t FANOUT_SIZE = (std::size_t(1) << CPositionIndex::FANOUT_BITS) + 1;
+    /// @brief Games per chunk at least, so small archives don't create many tiny chunks
+    constexpr std::size_t MIN_CHUNK_GAMES = 64;
+    /// @brief Entries written at once while merging
+    constexpr std::size_t WRITE_BUFFER_ENTRIES = std::size_t(1) << 16;
+
+    struct SHeader
+    {
+      char m_magic[4];
+      uint32_t m_version;
+      uint32_t m_fanoutBits;
+      uint32_t m_padding;
+      uint64_t m_count;
+      uint64_t m_reserved;
+    };
+    static_assert(sizeof(SHeader) == 32);
+
+    constexpr uint64_t KeyPrefix(uint64_t key)
+    {
+      return key >> (64 - CPositionIndex::FANOUT_BITS);
+    }
+
+    /// @brief Splits a text into lines (without line breaks)
+    std::vector<std::string_view> SplitLines(std::string_view text)
+    {
+      std::vector<std::string_view> lines;
+      std::size_t start = 0;
+      while (start < text.size())
+      {
+        const std::size_t end = std::min(text.find('\n', start), text.size());
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+      }
+      return lines;
+    }
+  }
+
+  bool CPositionIndexBuilder::Build(const std::string& archivePath, const std::string& indexPath)
+  {
+    JC_PROFILE_ZONE("CPositionIndexBuilder::Build");
+    using entry_t = CPositionIndex::SEntry;
+    const auto start = std::chrono::steady_clock::now();
+    m_statistics = SPositionIndexStatistics();
+
+    CMappedFile archive;
+    if (!archive.Open(archivePath, eMapMode::readOnly))
+    {
+      JC_LOG_ERROR(m_logger, "Game archive can not be read: " + archivePath);
+      return false;
+    }
+    const std::vector<std::string_view> lines = SplitLines(std::string_view(
+      reinterpret_cast<const char*>(archive.GetData()), archive.GetSize()));
+
+    // replay and sort chunks of games in parallel
+    CWorkerPool pool(m_threads);
+    const std::size_t chunkGames = std::max(MIN_CHUNK_GAMES,
+      (lines.size() + pool.GetThreadCount() * 8 - 1) / (pool.GetThreadCount() * 8));
+    std::vector<std::vector<entry_t>> chunks((lines.size() + chunkGames - 1) / chunkGames);
+    std::atomic<uint64_t> games{ 0 };
+    std::atomic<uint64_t> invalidGames{ 0 };
+    for (std::size_t chunk = 0; chunk < chunks.size(); chunk++)
+    {
+      pool.Submit([&, chunk]()
+      {
+        CChessBoard board(m_logger);
+        std::vector<SMove> moves;
+        std::vector<entry_t>& entries = chunks[chunk];
+        const std::size_t end = std::min(lines.size(), (chunk + 1) * chunkGames);
+        for (std::size_t game = chunk * chunkGames; game < end; game++)
+        {
+          if (lines[game].find_first_not_of(" \t\r") == std::string_view::npos)
+          {
+            continue; // empty line
+          }
+          games.fetch_add(1, std::memory_order_relaxed);
+          if (!ParseMoveList(lines[game], moves))
+          {
+            invalidGames.fetch_add(1, std::memory_order_relaxed);
+            continue;
+          }
+          board.Reset();
+          entries.push_back({ board.GetPositionKey(), static_cast<uint32_t>(game), 0, 0 });
+          for (std::size_t ply = 0; ply < moves.size(); ply++)
+          {
+            const SMove& move = moves[ply];
+            if (!board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove()))
+            {
+              invalidGames.fetch_add(1, std::memory_order_relaxed);
+              break;
+            }
+            entries.push_back({ board.GetPositionKey(), static_cast<uint32_t>(game),
+                                static_cast<uint16_t>(std::min<std::size_t>(ply + 1, UINT16_MAX)), 0 });
+          }
+        }
+        std::sort(entries.begin(), entries.end(), [](const entry_t& lhs, const entry_t& rhs)
+        {
+          return std::tie(lhs.m_key, lhs.m_gameId, lhs.m_ply) < std::tie(rhs.m_key, rhs.m_gameId, rhs.m_ply);
+        });
+      });
+    }
+    pool.WaitIdle();
+    archive.Close();
+
+    std::vector<uint64_t> fanout(FANOUT_SIZE, 0);
+    uint64_t count = 0;
+    for (const auto& entries : chunks)
+    {
+      count += entries.size();
+      for (const auto& entry : entries)
+      {
+        fanout[KeyPrefix(entry.m_key) + 1]++;
+      }
+    }
+    for (std::size_t ind = 1; ind < FANOUT_SIZE; ind++)
+    {
+      fanout[ind] += fanout[ind - 1];
+    }
+
+    // merge the sorted chunks into a temporary file, which replaces the index when complete
+    const std::string tempPath = indexPath + ".tmp";
+    {
+      std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+      SHeader header{};
+      std::memcpy(header.m_magic, MAGIC, sizeof(MAGIC));
+      header.m_version = CPositionIndex::VERSION;
+      header.m_fanoutBits = CPositionIndex::FANOUT_BITS;
+      header.m_count = count;
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char*>(fanout.data()), fanout.size() * sizeof(uint64_t));
+
+      // heap of (entry, chunk) with the smallest entry on top
+      using head_t = std::pair<const entry_t*, std::size_t>;
+      const auto greater = [](const head_t& lhs, const head_t& rhs)
+      {
+        return std::tie(lhs.first->m_key, lhs.first->m_gameId, lhs.first->m_ply) >
+               std::tie(rhs.first->m_key, rhs.first->m_gameId, rhs.first->m_ply);
+      };
+      std::priority_queue<head_t, std::vector<head_t>, decltype(greater)> heads(greater);
+      std::vector<std::size_t> positions(chunks.size(), 0);
+      for (std::size_t chunk = 0; chunk < chunks.size(); chunk++)
+      {
+        if (!chunks[chunk].empty())
+        {
+          heads.emplace(&chunks[chunk][0], chunk);
+        }
+      }
+      std::vector<entry_t> buffer;
+      buffer.reserve(WRITE_BUFFER_ENTRIES);
+      while (!heads.empty())
+      {
+        const std::size_t chunk = heads.top().second;
+        buffer.push_back(*heads.top().first);
+        heads.pop();
+        if (++positions[chunk] < chunks[chunk].size())
+        {
+          heads.emplace(&chunks[chunk][positions[chunk]], chunk);
+        }
+        else
+        {
+          std::vector<entry_t>().swap(chunks[chunk]); // free merged chunks early
+        }
+        if (buffer.size() == WRITE_BUFFER_ENTRIES || heads.empty())
+        {
+          out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(entry_t));
+          buffer.clear();
+        }
+      }
+      out.flush();
+      if (!out)
+      {
+        JC_LOG_ERROR(m_logger, "Position index can not be written: " + tempPath);
+        return false;
+      }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, indexPath, error);
+    if (error)
+    {
+      JC_LOG_ERROR(m_logger, "Position index can not be renamed: " + indexPath + " (" + error.message() + ")");
+      return false;
+    }
+
+    m_statistics.m_games = games.load();
+    m_statistics.m_positions = count;
+    m_statistics.m_invalidGames = invalidGames.load();
+    m_statistics.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+  }
+
+  bool CPositionIndex::Open(const std::string& path)
+  {
+    m_count = 0;
+    m_fanout = nullptr;
+    m_entries = nullptr;
+    if (!m_file.Open(path, eMapMode::readOnly))
+    {
+      JC_LOG_ERROR(m_logger, "Position index can not be opened: " + path);
+      return false;
+    }
+    const auto* header = reinterpret_cast<const SHeader*>(m_file.GetData());
+    const std::size_t entriesOffset = sizeof(SHeader) + FANOUT_SIZE * sizeof(uint64_t);
+    if (m_file.GetSize() < entriesOffset ||
+        std::memcmp(header->m_magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->m_version != VERSION || header->m_fanoutBits != FANOUT_BITS ||
+        m_file.GetSize() != entriesOffset + header->m_count * sizeof(SEntry))
+    {
+      JC_LOG_ERROR(m_logger, "File is no position index: " + path);
+      m_file.Close();
+      return false;
+    }
+    m_count = header->m_count;
+    m_fanout = reinterpret_cast<const uint64_t*>(m_file.GetData() + sizeof(SHeader));
+    m_entries = reinterpret_cast<const SEntry*>(m_file.GetData() + entriesOffset);
+    return true;
+  }
+
+  std::size_t CPositionIndex::Find(uint64_t key, std::vector<SPositionMatch>& matches) const
+  {
+    JC_PROFILE_ZONE("CPositionIndex::Find");
+    if (!IsOpen())
+    {
+      return 0;
+    }
+    const uint64_t prefix = KeyPrefix(key);
+    const SEntry* last = m_entries + m_fanout[prefix + 1];
+    const SEntry* it = std::lower_bound(m_entries + m_fanout[prefix], last, key,
+      [](const SEntry& entry, uint64_t value) { return entry.m_key < value; });
+    std::size_t found = 0;
+    for (; it != last && it->m_key == key; ++it, found++)
+    {
+      matches.push_back({ it->m_gameId, it->m_ply });
+    }
+    return found;
+  }
+
+  int RunPositionIndex(Logger logger, const std::vector<std::string>& args)
+  {
+    if (args.size() >= 4 && args[1] == "build")
+    {
+      std::size_t threads = 0;
+      if (args.size() == 6 && args[4] == "--threads")
+      {
+        threads = static_cast<std::size_t>(std::atoi(args[5].c_str()));
+      }
+      else if (args.size() != 4)
+      {
+        std::cerr << "Usage: JustChess index build ARCHIVE INDEX [--threads N]" << std::endl;
+        return 2;
+      }
+      CPositionIndexBuilder builder(logger, threads);
+      if (!builder.Build(args[2], args[3]))
+      {
+        return 1;
+      }
+      const SPositionIndexStatistics& statistics = builder.GetStatistics();
+      std::cout << "{\"games\": " << statistics.m_games
+                << ", \"positions\": " << statistics.m_positions
+                << ", \"invalid_games\": " << statistics.m_invalidGames
+                << ", \"seconds\": " << statistics.m_seconds
+                << ", \"positions_per_second\": "
+                << (statistics.m_seconds > 0.0 ? statistics.m_positions / statistics.m_seconds : 0.0)
+                << "}" << std::endl;
+      return 0;
+    }
+    if (args.size() >= 3 && args[1] == "query")
+    {
+      std::string text;
+      for (std::size_t ind = 3; ind < args.size(); ind++)
+      {
+        text += args[ind] + " ";
+      }
+      std::vector<SMove> moves;
+      CChessBoard board(logger);
+      board.Reset();
+      bool valid = ParseMoveList(text, moves);
+      for (std::size_t ind = 0; valid && ind < moves.size(); ind++)
+      {
+        valid = board.Move(moves[ind].m_fromRank, moves[ind].m_fromFile, moves[ind].m_toRank,
+                           moves[ind].m_toFile, board.IsWhiteToMove());
+      }
+      if (!valid)
+      {
+        std::cerr << "Invalid moves: " << text << std::endl;
+        return 2;
+      }
+      CPositionIndex index(logger);
+      if (!index.Open(args[2]))
+      {
+        return 1;
+      }
+      std::vector<SPositionMatch> matches;
+      const auto start = std::chrono::steady_clock::now();
+      index.Find(board.GetPositionKey(), matches);
+      const double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "{\"matches\": " << matches.size() << ", \"microseconds\": " << micros << ", \"games\": [";
+      for (std::size_t ind = 0; ind < matches.size(); ind++)
+      {
+        std::cout << (ind ? ", " : "") << "[" << matches[ind].m_gameId << ", " << matches[ind].m_ply << "]";
+      }
+      std::cout << "]}" << std::endl;
+      return 0;
+    }
+    std::cerr << "Usage: JustChess index build ARCHIVE INDEX [--threads N]\n"
+                 "       JustChess index query INDEX [MOVES...]" << std::endl;
+    return 2;
+  }
+}
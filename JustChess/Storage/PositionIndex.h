@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Logger/LogMacros.h"
+#include "Functional/ChessBoard/ChessBoard.h"
+#include "Platform/MappedFile.h"
+
+namespace JC
+{
+  /// @brief Occurrence of a position in a game archive
+  struct SPositionMatch
+  {
+    /// @brief Zero-based line of the game in the archive
+    uint32_t m_gameId;
+    /// @brief Number of moves played before the position
+    uint16_t m_ply;
+  };
+
+  /// @brief Counters of a @c CPositionIndexBuilder run
+  struct SPositionIndexStatistics
+  {
+    uint64_t m_games = 0;
+    uint64_t m_positions = 0;
+    /// @brief Games with a word which is no move or with an illegal move
+    uint64_t m_invalidGames = 0;
+    double m_seconds = 0.0;
+  };
+
+  /*!******************************************************************
+  * @class CPositionIndexBuilder
+  *
+  * @ingroup storage
+  *
+  * @brief Builds the index file of a game archive for @c CPositionIndex.
+  *
+  * @details The archive is a text file with one game per line, given as
+  * moves in coordinate notation from the start position ("e2e4 e7e5 ...").
+  * The games are split into chunks which are replayed in parallel on a
+  * @c CWorkerPool; every chunk collects and sorts the position keys
+  * (@c CChessBoard::GetPositionKey()) of all positions reached. The sorted
+  * chunks are merged while writing the index to a temporary file, which is
+  * renamed at the end, so an index file is always complete.
+  *
+  * Games with a word which is no move are skipped; games with an illegal
+  * move are indexed up to this move.
+  *
+  * Index file (little endian): "JCPI", version, fan-out bits, padding (each
+  * uint32), entry count, reserved (each uint64), fan-out table (uint64 per key
+  * prefix plus one: index of the first entry with this prefix), entries sorted
+  * by key, game and ply (uint64 key, uint32 game, uint16 ply, uint16 padding).
+  *
+  * Run from the command line:
+  * @code
+  * JustChess index build ARCHIVE INDEX [--threads N]
+  * JustChess index query INDEX [MOVES...]
+  * @endcode
+  ********************************************************************/
+  class CPositionIndexBuilder
+  {
+  public:
+    /// @param threads number of threads replaying games; 0 for one per hardware thread
+    CPositionIndexBuilder(Logger logger, std::size_t threads = 0)
+      : m_logger(logger)
+      , m_threads(threads)
+    {}
+
+    /// @brief Indexes all positions of an archive.
+    /// @return @c false if the archive can't be read or the index can't be written
+    bool Build(const std::string& archivePath, const std::string& indexPath);
+
+    const SPositionIndexStatistics& GetStatistics() const { return m_statistics; }
+
+  private:
+    Logger m_logger;
+    std::size_t m_threads;
+    SPositionIndexStatistics m_statistics;
+  };
+
+  /*!******************************************************************
+  * @class CPositionIndex
+  *
+  * @ingroup storage
+  *
+  * @brief Finds the games of an archive which reached a position.
+  *
+  * @details The index file written by @c CPositionIndexBuilder is memory
+  * mapped, nothing is loaded into heap memory. The top bits of the key select
+  * a range of the sorted entries in the fan-out table, which is searched
+  * binary, so a query touches only a few pages.
+  *
+  * <b>Example:</b>
+  * @code
+  * CPositionIndex index(logger);
+  * index.Open("games.jcpi");
+  * std::vector<SPositionMatch> matches;
+  * index.Find(board.GetPositionKey(), matches);
+  * @endcode
+  ********************************************************************/
+  class CPositionIndex
+  {
+  public:
+    static constexpr uint32_t VERSION = 1;
+    /// @brief Number of key bits of the fan-out table
+    static constexpr uint32_t FANOUT_BITS = 16;
+
+    CPositionIndex(Logger logger)
+      : m_logger(logger)
+      , m_count(0)
+    {}
+
+    /// @return @c false if the file can't be mapped or is no index
+    bool Open(const std::string& path);
+
+    bool IsOpen() const { return m_file.IsOpen(); }
+
+    /// @return number of indexed positions
+    uint64_t GetEntryCount() const { return m_count; }
+
+    /// @brief Collects the occurrences of a position.
+    /// @param key @c CChessBoard::GetPositionKey() of the position
+    /// @param matches occurrences are appended, ordered by game and ply
+    /// @return number of occurrences
+    std::size_t Find(uint64_t key, std::vector<SPositionMatch>& matches) const;
+
+  private:
+    struct SEntry
+    {
+      uint64_t m_key;
+      uint32_t m_gameId;
+      uint16_t m_ply;
+      uint16_t m_padding;
+    };
+    static_assert(sizeof(SEntry) == 16);
+
+    friend class CPositionIndexBuilder;
+
+    Logger m_logger;
+    CMappedFile m_file;
+    uint64_t m_count;
+    const uint64_t* m_fanout = nullptr;
+    const SEntry* m_entries = nullptr;
+  };
+
+  /// @brief Entry point of the command "index" (subcommands "build" and "query").
+  /// @return process exit code
+  int RunPositionIndex(Logger logger, const std::vector<std::string>& args);
+}
@@ -0,0 +1,461 @@
+#include <stdafx.h>
+
+#include "Tournament.h"
+#include "..\Concurrency\WorkerPool.h"
+#include "..\Functional\Notation\Notation.h"
+#include "..\Profiling\Profiler.h"
+#include "..\Profiling\Tracer.h"
+
+namespace JC
+{
+  namespace
+  {
+    /// @brief Openings used without openings file (common first moves of both sides)
+    const std::vector<const char*> s_openings{
+      "e2e4 e7e5 g1f3 b8c6",
+      "e2e4 c7c5 g1f3 d7d6",
+      "e2e4 e7e6 d2d4 d7d5",
+      "e2e4 c7c6 d2d4 d7d5",
+      "d2d4 d7d5 c2c4 e7e6",
+      "d2d4 g8f6 c2c4 g7g6",
+      "d2d4 g8f6 c2c4 e7e6",
+      "c2c4 e7e5 b1c3 g8f6",
+      "g1f3 d7d5 g2g3 g8f6",
+      "e2e4 d7d5 e4d5 d8d5",
+      "d2d4 f7f5 g2g3 g8f6",
+      "b2b3 e7e5 c1b2 b8c6" };
+
+    /// @brief Attempts to find a new start position per requested game pair
+    constexpr std::size_t PAIR_OPENING_ATTEMPTS = 16;
+
+    /// @brief Mean and variance of the score per game of the game pairs (0, 0.25, ... 1)
+    double PairScoreVariance(const std::array<uint64_t, 5>& pairs, double& score)
+    {
+      double count = 0.0;
+      double sum = 0.0;
+      for (std::size_t points = 0; points < pairs.size(); points++)
+      {
+        count += static_cast<double>(pairs[points]);
+        sum += static_cast<double>(pairs[points]) * (points / 4.0);
+      }
+      score = sum / count;
+      double variance = 0.0;
+      for (std::size_t points = 0; points < pairs.size(); points++)
+      {
+        variance += static_cast<double>(pairs[points]) * (points / 4.0 - score) * (points / 4.0 - score);
+      }
+      return variance / count;
+    }
+
+    double ScoreFromElo(double elo)
+    {
+      return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+    }
+
+    const char* SprtStateToString(eSprtState state)
+    {
+      switch (state)
+      {
+      case eSprtState::eH0Accepted: return "H0";
+      case eSprtState::eH1Accepted: return "H1";
+      default:                      return "continue";
+      }
+    }
+  }
+
+  bool CTournament::Run(std::ostream& out)
+  {
+    JC_PROFILE_ZONE("CTournament::Run");
+    std::vector<std::vector<SMove>> openings;
+    if (!LoadOpenings(openings))
+    {
+      return false;
+    }
+    std::vector<std::vector<SMove>> pairOpenings;
+    CreatePairOpenings(openings, (m_options.m_games + 1) / 2, pairOpenings);
+    const std::size_t games = 2 * pairOpenings.size();
+    // score of the first finished game of each pair, negative while none is finished
+    std::vector<double> pairScores(pairOpenings.size(), -1.0);
+    m_result = STournamentResult();
+    std::mutex resultMutex;
+    std::atomic<bool> stop{ false };
+    const std::size_t progressStep = std::max<std::size_t>(games / 10, 1);
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+      CWorkerPool pool(m_options.m_concurrency);
+      for (std::size_t game = 0; game < games; game++)
+      {
+        pool.Submit([&, game]()
+        {
+          if (stop.load(std::memory_order_relaxed))
+          {
+            return;
+          }
+          // games 2n and 2n+1 play the same opening with swapped colors
+          const std::size_t pair = game / 2;
+          const std::vector<SMove>& opening = pairOpenings[pair];
+          std::size_t plies = 0;
+          eGameStatus status = eGameStatus::eOngoing;
+          const double score = PlayGame(opening, game % 2 == 0, plies, status);
+
+          std::lock_guard<std::mutex> lock(resultMutex);
+          (score == 1.0 ? m_result.m_wins : score == 0.0 ? m_result.m_losses : m_result.m_draws)++;
+          if (status == eGameStatus::eOngoing)
+          {
+            m_result.m_maxPlies++;
+          }
+          else
+          {
+            m_result.m_terminations[_UINT8(status)]++;
+          }
+          m_result.m_plies += plies;
+          if (pairScores[pair] < 0.0)
+          {
+            pairScores[pair] = score;
+          }
+          else
+          {
+            m_result.m_pairs[static_cast<std::size_t>(2.0 * (pairScores[pair] + score))]++;
+          }
+          const eSprtState sprt = GetSprtState(m_result, m_options);
+          if (m_options.m_stopOnSprt && sprt != eSprtState::eContinue)
+          {
+            stop.store(true, std::memory_order_relaxed);
+          }
+          if (m_result.GetGames() % progressStep == 0)
+          {
+            std::cerr << "games " << m_result.GetGames() << "/" << games
+                      << "  +" << m_result.m_wins << " =" << m_result.m_draws << " -" << m_result.m_losses
+                      << "  elo " << EloFromScore((m_result.m_wins + 0.5 * m_result.m_draws) / m_result.GetGames())
+                      << "  sprt " << SprtStateToString(sprt) << std::endl;
+          }
+        });
+      }
+      pool.WaitIdle();
+    }
+    m_result.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const STournamentResult& result = m_result;
+    const double played = static_cast<double>(result.GetGames());
+    const double score = played > 0.0 ? (result.m_wins + 0.5 * result.m_draws) / played : 0.5;
+    out << "{\n  \"engine1\": \"" << CEngine::OptionsToString(m_options.m_engines[0])
+        << "\",\n  \"engine2\": \"" << CEngine::OptionsToString(m_options.m_engines[1])
+        << "\",\n  \"games\": " << result.GetGames()
+        << ",\n  \"wins\": " << result.m_wins
+        << ",\n  \"draws\": " << result.m_draws
+        << ",\n  \"losses\": " << result.m_losses
+        << ",\n  \"pairs\": " << result.GetPairs()
+        << ",\n  \"pentanomial\": [" << result.m_pairs[0] << ", " << result.m_pairs[1] << ", " << result.m_pairs[2]
+        << ", " << result.m_pairs[3] << ", " << result.m_pairs[4] << "]"
+        << ",\n  \"random_plies\": " << m_options.m_randomPlies
+        << ",\n  \"seed\": " << m_options.m_seed
+        << ",\n  \"terminations\": {";
+    for (uint8_t status = _UINT8(eGameStatus::eCheckmate); status < result.m_terminations.size(); status++)
+    {
+      out << "\"" << GameStatusToString(static_cast<eGameStatus>(status)) << "\": " << result.m_terminations[status] << ", ";
+    }
+    out << "\"max-plies\": " << result.m_maxPlies << "}"
+        << ",\n  \"seconds\": " << result.m_seconds
+        << ",\n  \"games_per_second\": " << (result.m_seconds > 0.0 ? played / result.m_seconds : 0.0)
+        << ",\n  \"plies_per_second\": " << (result.m_seconds > 0.0 ? result.m_plies / result.m_seconds : 0.0)
+        << ",\n  \"score\": " << score
+        << ",\n  \"elo\": " << EloFromScore(score)
+        << ",\n  \"elo_error_95\": " << EloError(result)
+        << ",\n  \"sprt\": {\"elo0\": " << m_options.m_elo0 << ", \"elo1\": " << m_options.m_elo1
+        << ", \"alpha\": " << m_options.m_alpha << ", \"beta\": " << m_options.m_beta
+        << ", \"llr\": " << LogLikelihoodRatio(result, m_options.m_elo0, m_options.m_elo1)
+        << ", \"lower_bound\": " << std::log(m_options.m_beta / (1.0 - m_options.m_alpha))
+        << ", \"upper_bound\": " << std::log((1.0 - m_options.m_beta) / m_options.m_alpha)
+        << ", \"state\": \"" << SprtStateToString(GetSprtState(result, m_options)) << "\"}\n}\n";
+    out.flush();
+    return true;
+  }
+
+  double CTournament::PlayGame(const std::vector<SMove>& opening, bool engine0White, std::size_t& plies,
+    eGameStatus& status) const
+  {
+    JC_TRACE_SCOPE("CTournament::PlayGame");
+    CEngine engines[2] = { CEngine(m_options.m_engines[0]), CEngine(m_options.m_engines[1]) };
+    CChessBoard board(m_logger);
+    board.Reset();
+    for (const auto& move : opening)
+    {
+      board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove());
+    }
+
+    plies = 0;
+    while (true)
+    {
+      status = board.GetGameStatus();
+      if (status != eGameStatus::eOngoing && status != eGameStatus::eInCheck)
+      {
+        break;
+      }
+      if (plies >= m_options.m_maxPlies)
+      {
+        status = eGameStatus::eOngoing;
+        return 0.5;
+      }
+      CEngine& engine = engines[board.IsWhiteToMove() == engine0White ? 0 : 1];
+      const SSearchResult result = engine.ChooseMove(board);
+      const SMove& move = *result.m_bestMove;
+      board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove());
+      plies++;
+    }
+    if (status != eGameStatus::eCheckmate)
+    {
+      return 0.5;
+    }
+    // the side to move is checkmated
+    return board.IsWhiteToMove() == engine0White ? 0.0 : 1.0;
+  }
+
+  bool CTournament::LoadOpenings(std::vector<std::vector<SMove>>& openings) const
+  {
+    std::vector<std::string> lines;
+    if (m_options.m_openingsPath.empty())
+    {
+      lines.assign(s_openings.begin(), s_openings.end());
+    }
+    else
+    {
+      std::ifstream file(m_options.m_openingsPath);
+      if (!file)
+      {
+        JC_LOG_ERROR(m_logger, "Openings can not be read: " + m_options.m_openingsPath);
+        return false;
+      }
+      for (std::string line; std::getline(file, line);)
+      {
+        lines.push_back(line);
+      }
+    }
+
+    // only openings which can be played and don't end the game
+    CChessBoard board(m_logger);
+    std::vector<SMove> moves;
+    for (const auto& line : lines)
+    {
+      if (!ParseMoveList(line, moves))
+      {
+        continue;
+      }
+      board.Reset();
+      bool valid = true;
+      for (std::size_t ind = 0; valid && ind < moves.size(); ind++)
+      {
+        valid = board.Move(moves[ind].m_fromRank, moves[ind].m_fromFile, moves[ind].m_toRank,
+                           moves[ind].m_toFile, board.IsWhiteToMove());
+      }
+      const eGameStatus status = valid ? board.GetGameStatus() : eGameStatus::eCheckmate;
+      if (status == eGameStatus::eOngoing || status == eGameStatus::eInCheck)
+      {
+        openings.push_back(moves);
+      }
+      else
+      {
+        JC_LOG_WARNING(m_logger, "Opening is skipped: " + line);
+      }
+    }
+    if (openings.empty())
+    {
+      JC_LOG_ERROR(m_logger, "No valid opening: " + m_options.m_openingsPath);
+      return false;
+    }
+    return true;
+  }
+
+  void CTournament::CreatePairOpenings(const std::vector<std::vector<SMove>>& openings, std::size_t pairs,
+    std::vector<std::vector<SMove>>& pairOpenings) const
+  {
+    // without random plies, every opening of the suite gives exactly one start position
+    const std::size_t candidates = m_options.m_randomPlies == 0 ?
+      std::min(pairs, openings.size()) : pairs * PAIR_OPENING_ATTEMPTS;
+    std::unordered_map<uint64_t, std::size_t> startPositions;
+    CChessBoard board(m_logger);
+    std::vector<SMove> moves;
+    for (std::size_t candidate = 0; candidate < candidates && pairOpenings.size() < pairs; candidate++)
+    {
+      std::vector<SMove> opening = openings[candidate % openings.size()];
+      board.Reset();
+      for (const auto& move : opening)
+      {
+        board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove());
+      }
+      std::seed_seq seed{ static_cast<uint32_t>(m_options.m_seed), static_cast<uint32_t>(m_options.m_seed >> 32),
+                          static_cast<uint32_t>(candidate) };
+      std::mt19937 random(seed);
+      bool playable = true;
+      for (std::size_t ply = 0; playable && ply < m_options.m_randomPlies; ply++)
+      {
+        moves.clear();
+        board.GetAllValidMoves(board.IsWhiteToMove(), moves);
+        const SMove move = moves[std::uniform_int_distribution<std::size_t>(0, moves.size() - 1)(random)];
+        board.Move(move.m_fromRank, move.m_fromFile, move.m_toRank, move.m_toFile, board.IsWhiteToMove());
+        opening.push_back(move);
+        const eGameStatus status = board.GetGameStatus();
+        playable = status == eGameStatus::eOngoing || status == eGameStatus::eInCheck;
+      }
+      if (playable && startPositions.emplace(board.GetPositionKey(), candidate).second)
+      {
+        pairOpenings.push_back(std::move(opening));
+      }
+    }
+    if (pairOpenings.size() < pairs)
+    {
+      JC_LOG_WARNING(m_logger, "Only " + std::to_string(2 * pairOpenings.size()) + " of " +
+        std::to_string(2 * pairs) + " games are played: more would repeat games " +
+        "(more openings or --random-plies give more start positions)");
+    }
+  }
+
+  double CTournament::EloFromScore(double score)
+  {
+    score = std::clamp(score, 0.001, 0.999);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+  }
+
+  double CTournament::EloError(const STournamentResult& result)
+  {
+    if (result.GetPairs() == 0)
+    {
+      return 0.0;
+    }
+    double score;
+    const double variance = PairScoreVariance(result.m_pairs, score);
+    const double margin = 1.96 * std::sqrt(variance / static_cast<double>(result.GetPairs()));
+    return (EloFromScore(score + margin) - EloFromScore(score - margin)) / 2.0;
+  }
+
+  double CTournament::LogLikelihoodRatio(const STournamentResult& result, double elo0, double elo1)
+  {
+    if (result.GetPairs() == 0)
+    {
+      return 0.0;
+    }
+    double score;
+    double variance = PairScoreVariance(result.m_pairs, score);
+    if (variance <= 0.0)
+    {
+      // all pairs had the same result: a virtual pair above and one below keep the ratio finite
+      std::array<uint64_t, 5> regularized = result.m_pairs;
+      regularized[1]++;
+      regularized[3]++;
+      variance = PairScoreVariance(regularized, score);
+    }
+    const double score0 = ScoreFromElo(elo0);
+    const double score1 = ScoreFromElo(elo1);
+    return static_cast<double>(result.GetPairs()) * (score1 - score0) * (2.0 * score - score0 - score1) /
+           (2.0 * variance);
+  }
+
+  eSprtState CTournament::GetSprtState(const STournamentResult& result, const STournamentOptions& options)
+  {
+    const double llr = LogLikelihoodRatio(result, options.m_elo0, options.m_elo1);
+    if (llr >= std::log((1.0 - options.m_beta) / options.m_alpha))
+    {
+      return eSprtState::eH1Accepted;
+    }
+    if (llr <= std::log(options.m_beta / (1.0 - options.m_alpha)))
+    {
+      return eSprtState::eH0Accepted;
+    }
+    return eSprtState::eContinue;
+  }
+
+  bool CTournament::ParseArgs(const std::vector<std::string>& args, STournamentOptions& options)
+  {
+    for (std::size_t ind = 1; ind < args.size(); ind++)
+    {
+      const std::string& arg = args[ind];
+      if (arg == "--sprt-stop")
+      {
+        options.m_stopOnSprt = true;
+        continue;
+      }
+      if (ind + 1 >= args.size())
+      {
+        return false; // all other options have a value
+      }
+      const std::string& value = args[++ind];
+      if (arg == "--engine1" || arg == "--engine2")
+      {
+        if (!CEngine::ParseOptions(value, options.m_engines[arg == "--engine1" ? 0 : 1]))
+        {
+          return false;
+        }
+        continue;
+      }
+      if (arg == "--openings")
+      {
+        options.m_openingsPath = value;
+        continue;
+      }
+      double number;
+      try
+      {
+        number = std::stod(value);
+      }
+      catch (const std::exception&)
+      {
+        return false;
+      }
+      if (arg == "--games" && number >= 1)
+      {
+        options.m_games = static_cast<std::size_t>(number);
+      }
+      else if (arg == "--random-plies" && number >= 0)
+      {
+        options.m_randomPlies = static_cast<std::size_t>(number);
+      }
+      else if (arg == "--seed" && number >= 0)
+      {
+        options.m_seed = static_cast<uint64_t>(number);
+      }
+      else if (arg == "--concurrency" && number >= 0)
+      {
+        options.m_concurrency = static_cast<std::size_t>(number);
+      }
+      else if (arg == "--max-plies" && number >= 1)
+      {
+        options.m_maxPlies = static_cast<std::size_t>(number);
+      }
+      else if (arg == "--elo0")
+      {
+        options.m_elo0 = number;
+      }
+      else if (arg == "--elo1")
+      {
+        options.m_elo1 = number;
+      }
+      else if (arg == "--alpha" && number > 0.0 && number < 1.0)
+      {
+        options.m_alpha = number;
+      }
+      else if (arg == "--beta" && number > 0.0 && number < 1.0)
+      {
+        options.m_beta = number;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return options.m_elo0 < options.m_elo1;
+  }
+
+  int RunTournament(Logger logger, const std::vector<std::string>& args)
+  {
+    STournamentOptions options;
+    if (!CTournament::ParseArgs(args, options))
+    {
+      std::cerr << "Usage: JustChess tournament [--engine1 depth=N,eval=material|pawns] [--engine2 ...]\n"
+                   "  [--games N] [--random-plies N] [--seed N] [--concurrency N] [--max-plies N] [--openings FILE]\n"
+                   "  [--elo0 X] [--elo1 X] [--alpha X] [--beta X] [--sprt-stop]" << std::endl;
+      return 2;
+    }
+    CTournament tournament(logger, options);
+    return tournament.Run(std::cout) ? 0 : 1;
+  }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Logger/LogMacros.h"
+#include "Search/Engine.h"
+
+/**
+ *  @defgroup tournament Tournament
+ */
+
+namespace JC
+{
+  /// @brief Settings of a @c CTournament
+  struct STournamentOptions
+  {
+    /// @brief Engine under test (index 0) and reference engine (index 1)
+    std::array<SEngineOptions, 2> m_engines;
+    /// @brief Number of games, rounded up to an even number (every opening is played with both colors)
+    std::size_t m_games = 100;
+    /// @brief Random plies played after the opening of each game pair. The engines are
+    /// deterministic, so without them the games can't be more than twice the openings.
+    std::size_t m_randomPlies = 4;
+    /// @brief Seed of the random plies
+    uint64_t m_seed = 1;
+    /// @brief Games played at the same time; 0 for one per hardware thread
+    std::size_t m_concurrency = 0;
+    /// @brief Games are adjudicated as draw after this number of plies
+    std::size_t m_maxPlies = 300;
+    /// @brief File with one opening per line (moves in coordinate notation); built-in openings if empty
+    std::string m_openingsPath;
+    /// @brief Elo difference of the null hypothesis of the SPRT
+    double m_elo0 = 0.0;
+    /// @brief Elo difference of the alternative hypothesis of the SPRT
+    double m_elo1 = 5.0;
+    /// @brief Error probabilities of the SPRT (false positive and false negative)
+    double m_alpha = 0.05;
+    double m_beta = 0.05;
+    /// @brief Stop starting games once the SPRT accepted a hypothesis
+    bool m_stopOnSprt = false;
+  };
+
+  /// @brief Results of engine 0 against engine 1
+  struct STournamentResult
+  {
+    uint64_t m_wins = 0;
+    uint64_t m_draws = 0;
+    uint64_t m_losses = 0;
+    /// @brief Finished game pairs (same opening, swapped colors) per points of engine 0
+    /// in half points: 0 (two losses) to 4 (two wins), the pentanomial distribution
+    std::array<uint64_t, 5> m_pairs{};
+    /// @brief Finished games per final @c eGameStatus
+    std::array<uint64_t, 7> m_terminations{};
+    /// @brief Games adjudicated as draw after @c STournamentOptions::m_maxPlies
+    uint64_t m_maxPlies = 0;
+    uint64_t m_plies = 0;
+    double m_seconds = 0.0;
+
+    uint64_t GetGames() const { return m_wins + m_draws + m_losses; }
+    uint64_t GetPairs() const { return m_pairs[0] + m_pairs[1] + m_pairs[2] + m_pairs[3] + m_pairs[4]; }
+  };
+
+  /// @brief State of a sequential probability ratio test
+  enum class eSprtState : uint8_t
+  {
+    eContinue = 0,
+    /// @brief Engine 0 is not better by @c m_elo1
+    eH0Accepted,
+    /// @brief Engine 0 is better by more than @c m_elo0
+    eH1Accepted
+  };
+
+  /*!******************************************************************
+  * @class CTournament
+  *
+  * @ingroup tournament
+  *
+  * @brief Self-play match between two engine configurations.
+  *
+  * @details Every game is a task of a @c CWorkerPool with one thread per
+  * concurrent game, so all cores are used. Each game pair starts from an
+  * opening of the suite followed by @c m_randomPlies seeded random plies and
+  * is played twice with swapped colors. The engines are deterministic, so
+  * equal start positions would give copies of games: pairs only get
+  * distinct start positions, and the number of games is limited (with a
+  * warning) if there are not enough of them. Games end by
+  * @c CChessBoard::GetGameStatus() (checkmate, stalemate, threefold
+  * repetition, fifty-move rule, insufficient material) or are adjudicated as
+  * draw after @c m_maxPlies.
+  *
+  * The report contains games per second, the Elo difference of engine 0
+  * with a 95% confidence interval and the log-likelihood ratio of an SPRT
+  * with its state. Elo error and SPRT use the scores of the finished game
+  * pairs (pentanomial model), since the two games of a pair are correlated.
+  *
+  * Run from the command line:
+  * @code
+  * JustChess tournament [--engine1 depth=3,eval=pawns] [--engine2 depth=2,eval=material]
+  *   [--games N] [--random-plies N] [--seed N] [--concurrency N] [--max-plies N] [--openings FILE]
+  *   [--elo0 X] [--elo1 X] [--alpha X] [--beta X] [--sprt-stop]
+  * @endcode
+  ********************************************************************/
+  class CTournament
+  {
+  public:
+    CTournament(Logger logger, const STournamentOptions& options)
+      : m_logger(logger)
+      , m_options(options)
+    {}
+
+    /// @brief Plays all games and writes the report as JSON.
+    /// Progress is written to stderr.
+    /// @return @c false if the openings can't be loaded
+    bool Run(std::ostream& out);
+
+    const STournamentResult& GetResult() const { return m_result; }
+
+    /// @brief Parses the command line arguments following "tournament".
+    /// @return @c false if an argument is invalid
+    static bool ParseArgs(const std::vector<std::string>& args, STournamentOptions& options);
+
+    /// @return Elo difference corresponding to a score (0 to 1, clamped to avoid infinity)
+    static double EloFromScore(double score);
+
+    /// @return half width of the 95% confidence interval of the Elo difference (from the game pairs)
+    static double EloError(const STournamentResult& result);
+
+    /// @return log-likelihood ratio of the game pairs for @p elo1 against @p elo0
+    static double LogLikelihoodRatio(const STournamentResult& result, double elo0, double elo1);
+
+    /// @return state of the SPRT of the results
+    static eSprtState GetSprtState(const STournamentResult& result, const STournamentOptions& options);
+
+  private:
+    /// @brief Plays one game.
+    /// @param engine0White @c true if engine 0 plays white
+    /// @param plies number of plies played
+    /// @param status final status, @c eGameStatus::eOngoing if adjudicated after @c m_maxPlies
+    /// @return score of engine 0 (1 win, 0.5 draw, 0 loss)
+    double PlayGame(const std::vector<SMove>& opening, bool engine0White, std::size_t& plies,
+      eGameStatus& status) const;
+
+    /// @brief Reads the openings file or returns the built-in openings.
+    bool LoadOpenings(std::vector<std::vector<SMove>>& openings) const;
+
+    /// @brief Creates the openings of up to @p pairs game pairs: openings of the suite
+    /// followed by random plies, each with a different start position.
+    void CreatePairOpenings(const std::vector<std::vector<SMove>>& openings, std::size_t pairs,
+      std::vector<std::vector<SMove>>& pairOpenings) const;
+
+    Logger m_logger;
+    STournamentOptions m_options;
+    STournamentResult m_result;
+  };
+
+  /// @brief Entry point of the command "tournament".
+  /// @return process exit code
+  int RunTournament(Logger logger, const std::vector<std::string>& args);
+}
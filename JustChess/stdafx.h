@@ -2,7 +2,9 @@
 
 #include <iostream>
 #include <sstream> 
+#include <fstream>
 #include <vector>
+#include <array>
 #include <memory>
 #include <string>
 #include <utility>
@@ -12,5 +14,24 @@
 #include <cmath>
 #include <optional>
 #include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <mutex>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <functional>
+#include <deque>
+#include <condition_variable>
+#include <shared_mutex>
+#include <unordered_map>
+#include <ctime>
+#include <filesystem>
+#include <queue>
+#include <cstdlib>
+#include <new>
+#include <cctype>
 
 #include <Functional/EnumsAndStaticMaps.h>
\ No newline at end of file